@@ -1,12 +1,15 @@
 #include "SerialInterface.h"
 
 #include <QtGlobal>
+#include <QLoggingCategory>
 #include <QMetaObject>
 
-namespace {
-// guard to avoid huge buffers
-constexpr int kMaxReasonableLen = 1'000'000;
-}
+#include <algorithm>
+#include <cstring>
+
+// Link report every 10 s; off unless enabled, e.g.
+//   QT_LOGGING_RULES="bendemo.stats.serial.debug=true"
+Q_LOGGING_CATEGORY(lcSerialStats, "bendemo.stats.serial", QtInfoMsg)
 
 SerialInterface::SerialInterface(int tx_payload_len,
                                  int rx_payload_len,
@@ -15,34 +18,70 @@ SerialInterface::SerialInterface(int tx_payload_len,
     tx_len_(tx_payload_len),
     rx_len_(rx_payload_len),
     tx_message_(tx_payload_len, '\x00'),
-    latest_rx_payload_(rx_payload_len, '\x00')
+    seqEnabled_(tx_payload_len >= kTxSeqPos + 2 && rx_payload_len >= kRxEchoPos + 2),
+    latest_rx_payload_(rx_payload_len, '\x00'),
+    // V1 frames are exactly rx_len_ bytes; V2 frames anywhere from an empty message to kMaxFrame
+    rx_framer_(std::min(size_t(rx_payload_len), LinkProtocol::kOverhead),
+               std::max(size_t(rx_payload_len), LinkProtocol::kMaxFrame), 4096)
 {
     Q_ASSERT(tx_len_ > 0 && rx_len_ > 0);
-    connect(&serial_, &QSerialPort::readyRead, this, &SerialInterface::onReadyRead);
-    connect(&serial_, &QSerialPort::errorOccurred, this, [this](QSerialPort::SerialPortError e){
-        if (e != QSerialPort::NoError) {
-            emit errorOccurred(QString("[Serial] Error: %1").arg(serial_.errorString()));
+    Q_ASSERT(int(CobsFramer::maxEncodedLength(size_t(tx_len_))) + 1 <= kMaxFrameBytes);
+    Q_ASSERT(rx_len_ <= kMaxFrameBytes);
+
+    // Port and timers are created here and moved (with their children) to the I/O thread.
+    serial_ = new QSerialPort();
+    heartbeatTimer_ = new QTimer(serial_);
+    frameTimer_     = new QTimer(serial_);
+    statsTimer_     = new QTimer(serial_);
+
+    connect(serial_, &QSerialPort::readyRead, serial_, [this](){ onReadyRead_(); });
+    connect(serial_, &QSerialPort::bytesWritten, serial_, [this](qint64 n){ onBytesWritten_(n); });
+    connect(serial_, &QSerialPort::errorOccurred, serial_, [this](QSerialPort::SerialPortError e){
+        if (e == QSerialPort::NoError) return;
+        emit errorOccurred(QString("[Serial] Error: %1").arg(serial_->errorString()));
+
+        // Raised when the device is removed while open
+        if (e == QSerialPort::ResourceError && isOpened_.load(std::memory_order_acquire)) {
+            closePort_();
+            emit disconnected();
         }
     });
 
-    flushTimer_.setInterval(1000);
-    connect(&flushTimer_, &QTimer::timeout, this, [this](){
-        if (logStream_.device()) logStream_.flush();
+    connect(heartbeatTimer_, &QTimer::timeout, serial_, [this](){ heartbeat_(); });
+
+    frameTimer_->setSingleShot(true);
+    frameTimer_->setTimerType(Qt::PreciseTimer);
+    connect(frameTimer_, &QTimer::timeout, serial_, [this](){
+        if (txRequested_.load(std::memory_order_acquire)) sendFrame_(TxKind::Scheduled);
     });
+
+    statsTimer_->setInterval(10000);
+    connect(statsTimer_, &QTimer::timeout, serial_, [this](){ logStats_(); });
+
+    serial_->moveToThread(&ioThread_);
+    connect(&ioThread_, &QThread::finished, serial_, &QObject::deleteLater);
+    ioThread_.setObjectName("SerialIO");
+    ioThread_.start(QThread::TimeCriticalPriority);
+
+    QMetaObject::invokeMethod(serial_, [this](){ statsTimer_->start(); }, Qt::QueuedConnection);
 }
 
 SerialInterface::~SerialInterface()
 {
-    if(isRecording_)
-    {
-        flushTimer_.stop();
-        if (logStream_.device()) logStream_.flush();
-        logFile_.close();
-    }
+    aborting_.store(true, std::memory_order_relaxed);
+    QMetaObject::invokeMethod(serial_, [this](){
+        if (isRecording_) stopRecording_();
+        heartbeatTimer_->stop();
+        frameTimer_->stop();
+        statsTimer_->stop();
+    }, Qt::BlockingQueuedConnection);
 
     saveLatestTxCsv_();
 
-    close();    
+    close();
+
+    ioThread_.quit();
+    ioThread_.wait();
 }
 
 QString SerialInterface::port()
@@ -51,15 +90,7 @@ QString SerialInterface::port()
 
     for (const QSerialPortInfo &info : ports)
     {
-        QString desc = info.description().toLower();
-        QString manu = info.manufacturer().toLower();
-
-        if (desc.contains("arduino") ||
-            manu.contains("arduino") ||
-            desc.contains("ch340") ||
-            desc.contains("usb serial") ||
-            manu.contains("wch") ||
-            manu.contains("silicon labs"))
+        if (isCandidatePort(info))
         {
             return info.portName();
         }
@@ -73,6 +104,19 @@ QString SerialInterface::port()
 }
 
 
+bool SerialInterface::isCandidatePort(const QSerialPortInfo& info)
+{
+    const QString desc = info.description().toLower();
+    const QString manu = info.manufacturer().toLower();
+
+    return desc.contains("arduino") ||
+           manu.contains("arduino") ||
+           desc.contains("ch340") ||
+           desc.contains("usb serial") ||
+           manu.contains("wch") ||
+           manu.contains("silicon labs");
+}
+
 bool SerialInterface::open(const QString& port_name, int baud_rate)
 {
     if (port_name == "")
@@ -83,39 +127,54 @@ bool SerialInterface::open(const QString& port_name, int baud_rate)
     }
 
     if (isOpen()) return true;
-    configurePort(port_name, baud_rate);
-    if (!serial_.open(QIODevice::ReadWrite)) {
-        emit errorOccurred(QString("[Serial] Open failed: %1").arg(serial_.errorString()));
-        isOpened_ = false;
-        return false;
-    }
 
-    isOpened_ = true;
-    return true;
+    bool ok = false;
+    QMetaObject::invokeMethod(serial_, [&](){ ok = openPort_(port_name, baud_rate); },
+                              Qt::BlockingQueuedConnection);
+    return ok;
 }
 
 void SerialInterface::close()
 {
-    if (serial_.isOpen()) {
-        serial_.close();
-    }
-    rx_accumulator_.clear();
-    isOpened_ = false;
+    QMetaObject::invokeMethod(serial_, [this](){ closePort_(); }, Qt::BlockingQueuedConnection);
 }
 
 bool SerialInterface::isOpen() const
 {
-    return isOpened_;
+    return isOpened_.load(std::memory_order_acquire);
+}
+
+QString SerialInterface::portName() const
+{
+    QMutexLocker lock(&infoMutex_);
+    return portName_;
+}
+
+void SerialInterface::probe(const QString& port_name, int baud_rate, int timeoutMs,
+                            const QList<int>& baudCandidates)
+{
+    QMetaObject::invokeMethod(serial_, [=](){
+        bool ok = !serial_->isOpen() && openPort_(port_name, baud_rate) && identify_(timeoutMs);
+        if (ok && !baudCandidates.isEmpty()) negotiate_(baudCandidates, nullptr);
+        if (!ok) closePort_();
+        emit probeFinished(ok);
+    }, Qt::QueuedConnection);
+}
+
+SerialInterface::DeviceInfo SerialInterface::deviceInfo() const
+{
+    QMutexLocker lock(&infoMutex_);
+    return info_;
 }
 
 void SerialInterface::configurePort(const QString& port_name, int baud_rate)
 {
-    serial_.setPortName(port_name);
-    serial_.setBaudRate(baud_rate);
-    serial_.setDataBits(QSerialPort::Data8);
-    serial_.setParity(QSerialPort::NoParity);
-    serial_.setStopBits(QSerialPort::OneStop);
-    serial_.setFlowControl(QSerialPort::NoFlowControl);
+    serial_->setPortName(port_name);
+    serial_->setBaudRate(baud_rate);
+    serial_->setDataBits(QSerialPort::Data8);
+    serial_->setParity(QSerialPort::NoParity);
+    serial_->setStopBits(QSerialPort::OneStop);
+    serial_->setFlowControl(QSerialPort::NoFlowControl);
 }
 
 bool SerialInterface::SetMessage(int position, const QByteArray& chunk)
@@ -132,34 +191,80 @@ bool SerialInterface::SetMessage(int position, const QByteArray& chunk)
     }
 
     if (chunk.isEmpty()) return true; // nothing to do
+    QMutexLocker lock(&txMutex_);
+    if (std::equal(chunk.begin(), chunk.end(), tx_message_.begin() + position)) return true; // unchanged
+
     std::copy(chunk.begin(), chunk.end(), tx_message_.begin() + position);
+    updates_.fetch_add(1, std::memory_order_relaxed);
+
+    // V2 sends only the motors whose bytes changed
+    for (int i = position; i < position + int(chunk.size()) && i < 2 * LinkProtocol::kMotorCount; ++i) {
+        dirtyMotors_ |= quint8(1u << (i / 2));
+    }
+
+    // Remember the first change of this field since the last frame (update-to-wire latency)
+    if (position < kMaxFields && !(dirtyMask_ & (1u << position))) {
+        dirtyMask_ |= 1u << position;
+        dirtyNs_[position] = nowNs();
+    }
     return true;
 }
 
 bool SerialInterface::Send()
 {
+    if (frameIntervalUs_.load(std::memory_order_relaxed) <= 0) return SendUrgent();
+
     if (!isOpen()) {
         emit errorOccurred("[Serial] Send: port not open.");
         return false;
     }
 
-    // COBS encode + trailing 0x00 delimiter
-    const QByteArray encoded = cobsEncode(tx_message_);
-    if (encoded.isEmpty()) {
-        emit errorOccurred("[Serial] Send: COBS encoding failed.");
-        return false;
+    // Coalesced: the I/O thread sends the latest message in the next frame slot
+    txRequested_.store(true, std::memory_order_release);
+    if (!schedWakePending_.exchange(true, std::memory_order_acq_rel)) {
+        QMetaObject::invokeMethod(serial_, [this](){ scheduleTx_(); }, Qt::QueuedConnection);
     }
+    return true;
+}
 
-    QByteArray frame = encoded;
-    frame.push_back('\x00'); // delimiter
+bool SerialInterface::SendUrgent()
+{
+    if (!isOpen()) {
+        emit errorOccurred("[Serial] Send: port not open.");
+        return false;
+    }
 
-    const qint64 written = serial_.write(frame);
-    if (written != frame.size()) {
-        emit errorOccurred(QString("[Serial] Send: write returned %1 / %2")
-                               .arg(written).arg(frame.size()));
+    if (!enqueueTx_(TxKind::Urgent)) {
+        emit errorOccurred("[Serial] Send: TX queue full.");
         return false;
     }
-    return true;
+    return wakeTx_();
+}
+
+void SerialInterface::setFrameRate(int hz)
+{
+    frameIntervalUs_.store(hz > 0 ? 1000000 / hz : 0, std::memory_order_relaxed);
+}
+
+void SerialInterface::setProtocol(Protocol protocol)
+{
+    if (protocol == Protocol::V2 && tx_len_ < 2 * LinkProtocol::kMotorCount) {
+        emit errorOccurred(QString("[Serial] Protocol V2 needs a TX image of at least %1 bytes (have %2).")
+                               .arg(2 * LinkProtocol::kMotorCount).arg(tx_len_));
+        return;
+    }
+    protocol_.store(int(protocol), std::memory_order_relaxed);
+}
+
+void SerialInterface::setHeartbeatInterval(int ms)
+{
+    heartbeatMs_.store(ms, std::memory_order_relaxed);
+
+    // Poll at a quarter of the interval so an idle gap never grows much past `ms`
+    QMetaObject::invokeMethod(serial_, [this, ms](){
+        if (ms > 0) heartbeatTimer_->start(std::max(10, ms / 4));
+        else        heartbeatTimer_->stop();
+    }, Qt::QueuedConnection);
 }
 
 QByteArray SerialInterface::read() const
@@ -167,228 +272,829 @@ QByteArray SerialInterface::read() const
     return latest_rx_payload_;
 }
 
+SerialInterface::LinkStats SerialInterface::stats() const
+{
+    auto mean = [](const LatencyAcc& a) {
+        const quint64 n = a.count.load(std::memory_order_relaxed);
+        return n ? double(a.sumUs.load(std::memory_order_relaxed)) / double(n) : 0.0;
+    };
+
+    LinkStats s;
+    s.txFrames  = txFrames_.load(std::memory_order_relaxed);
+    s.txDropped = txDropped_.load(std::memory_order_relaxed);
+    s.txBytes   = txBytes_.load(std::memory_order_relaxed);
+    s.txScheduled  = txScheduled_.load(std::memory_order_relaxed);
+    s.txUrgent     = txUrgent_.load(std::memory_order_relaxed);
+    s.txHeartbeats = txHeartbeats_.load(std::memory_order_relaxed);
+    s.updates      = updates_.load(std::memory_order_relaxed);
+    s.rxFrames  = rxFrames_.load(std::memory_order_relaxed);
+    s.rxDropped = rxDropped_.load(std::memory_order_relaxed);
+    s.txMeanUs  = mean(txLatency_);
+    s.txMaxUs   = double(txLatency_.maxUs.load(std::memory_order_relaxed));
+    s.rxMeanUs  = mean(rxLatency_);
+    s.rxMaxUs   = double(rxLatency_.maxUs.load(std::memory_order_relaxed));
+    s.rxBytes     = rxBytes_.load(std::memory_order_relaxed);
+    s.rxV1Frames  = rxV1Frames_.load(std::memory_order_relaxed);
+    s.rxV2Frames  = rxV2Frames_.load(std::memory_order_relaxed);
+    s.rxCrcErrors = rxCrcErrors_.load(std::memory_order_relaxed);
+    s.rxBadFrames = rxBadFrames_.load(std::memory_order_relaxed);
+    s.rxLost      = rxLost_.load(std::memory_order_relaxed);
+    s.fwRxFrames  = fwRxFrames_.load(std::memory_order_relaxed);
+    s.fwRxErrors  = fwRxErrors_.load(std::memory_order_relaxed);
+
+    const quint64 rejected = s.rxCrcErrors + s.rxBadFrames;
+    const quint64 seen     = s.rxV1Frames + s.rxV2Frames + rejected;
+    s.rxErrorRate = seen ? double(rejected) / double(seen) : 0.0;
+
+    // 8N1: 10 bits per byte on the wire
+    const int    baud    = baudRate_.load(std::memory_order_relaxed);
+    const qint64 opened  = openedNs_.load(std::memory_order_relaxed);
+    const double elapsed = double(nowNs() - opened) / 1e9;
+    if (baud > 0 && opened > 0 && elapsed > 0.0) {
+        s.txUtilization = double(s.txBytes) * 10.0 / (double(baud) * elapsed);
+        s.rxUtilization = double(s.rxBytes) * 10.0 / (double(baud) * elapsed);
+    }
+    return s;
+}
+
+QVector<SerialInterface::FieldLatency> SerialInterface::fieldLatency() const
+{
+    QVector<FieldLatency> out;
+    for (int i = 0; i < kMaxFields; ++i) {
+        const LatencyAcc& a = fieldLatency_[size_t(i)];
+        const quint64 n = a.count.load(std::memory_order_relaxed);
+        if (n == 0) continue;
+
+        FieldLatency f;
+        f.position = i;
+        f.count    = n;
+        f.meanUs   = double(a.sumUs.load(std::memory_order_relaxed)) / double(n);
+        f.maxUs    = double(a.maxUs.load(std::memory_order_relaxed));
+        out.push_back(f);
+    }
+    return out;
+}
+
 // ======================= Slots =======================
 
 void SerialInterface::changeRecordState()
 {
-    isRecording_ = !isRecording_;
+    QMetaObject::invokeMethod(serial_, [this](){
+        if (isRecording_) stopRecording_();
+        else              startRecording_();
+    }, Qt::QueuedConnection);
+}
 
-    if (isRecording_)
+// ======================= I/O thread =======================
+
+bool SerialInterface::openPort_(const QString& port_name, int baud_rate)
+{
+    configurePort(port_name, baud_rate);
+    if (!serial_->open(QIODevice::ReadWrite)) {
+        emit errorOccurred(QString("[Serial] Open failed: %1").arg(serial_->errorString()));
+        return false;
+    }
     {
-        // 保存先 = 実行ファイルのあるディレクトリ（/release or /debug の時は1つ上に寄せる）
-        QDir base(QCoreApplication::applicationDirPath());
-        const QString dn = base.dirName().toLower();
-        if (dn == "release" || dn == "debug") base.cdUp();   // ← そのまま直下に置きたいならこの行を消す
-
-        base.mkpath("SerialLogs");
-        const QString dir = base.filePath("SerialLogs");
-
-        currentDate_  = QDate::currentDate();
-        currentStamp_ = QDateTime::currentDateTime().toString("yyyy-MM-dd_HH-mm-ss");
-        const QString path = QDir(dir).filePath(currentStamp_ + ".csv");
-
-        const bool existed = QFile::exists(path);
-        logFile_.setFileName(path);
-        if (!logFile_.open(QIODevice::WriteOnly | QIODevice::Append | QIODevice::Text)) {
-            emit errorOccurred(QString("[Serial] CSV open failed: %1").arg(path));
-            isRecording_ = false;
-            return;
+        QMutexLocker lock(&infoMutex_);
+        portName_ = port_name;
+    }
+    lastTxNs_ = 0;
+    baudRate_.store(baud_rate, std::memory_order_relaxed);
+    openedNs_.store(nowNs(), std::memory_order_relaxed);
+    isOpened_.store(true, std::memory_order_release);
+    return true;
+}
+
+void SerialInterface::closePort_()
+{
+    if (serial_->isOpen()) {
+        serial_->close();
+    }
+    frameTimer_->stop();
+    rx_framer_.clear();
+    lastRxSeq_ = 0;
+    inFlightHead_ = inFlightTail_ = 0;
+    writtenOffset_ = flushedOffset_ = 0;
+    isOpened_.store(false, std::memory_order_release);
+}
+
+void SerialInterface::startRecording_()
+{
+    // 保存先 = 実行ファイルのあるディレクトリ（/release or /debug の時は1つ上に寄せる）
+    QDir base(QCoreApplication::applicationDirPath());
+    const QString dn = base.dirName().toLower();
+    if (dn == "release" || dn == "debug") base.cdUp();   // ← そのまま直下に置きたいならこの行を消す
+
+    base.mkpath("SerialLogs");
+    const QString dir = base.filePath("SerialLogs");
+
+    const QString stamp = QDateTime::currentDateTime().toString("yyyy-MM-dd_HH-mm-ss");
+    const QString path = QDir(dir).filePath(stamp + ".bdsl");
+
+    QString error;
+    if (!logWriter_.start(path, rx_len_, tx_len_, &error)) {
+        emit errorOccurred(QString("[Serial] Log open failed: %1 (%2)").arg(path, error));
+        return;
+    }
+
+    isRecording_ = true;
+    qDebug() << "[Serial] Recording ON ->" << path;
+}
+
+void SerialInterface::stopRecording_()
+{
+    isRecording_ = false;
+    logWriter_.stop();
+    qDebug() << "[Serial] Recording OFF (" << logWriter_.written() << "records,"
+             << logWriter_.dropped() << "dropped )";
+}
+
+void SerialInterface::drainTx_()
+{
+    txWakePending_.store(false, std::memory_order_release);
+    if (!serial_->isOpen()) return;
+
+    TxFrame f;
+    while (txQueue_.pop(f)) {
+        const qint64 written = serial_->write(reinterpret_cast<const char*>(f.bytes.data()), f.len);
+        if (written != f.len) {
+            emit errorOccurred(QString("[Serial] Send: write returned %1 / %2")
+                                   .arg(written).arg(f.len));
+            continue;
         }
 
-        logStream_.setDevice(&logFile_);
-#if QT_VERSION >= QT_VERSION_CHECK(6,0,0)
-        logStream_.setEncoding(QStringConverter::Utf8);
-#endif
-        if (!existed) {
-            logStream_ << "timestamp";
-            for (int i = 0; i < rx_len_; ++i) logStream_ << ",b" << i;
-            logStream_ << '\n';
+        if (isRecording_) {
+            logWriter_.append(SerialLog::Direction::Tx, f.raw.data(), tx_len_, f.enqueuedNs);
         }
-        flushTimer_.start();
-        qDebug() << "[Serial] Recording ON ->" << path;
-    } else {
-        flushTimer_.stop();
-        if (logStream_.device()) logStream_.flush();
-        logFile_.close();
-        qDebug() << "[Serial] Recording OFF";
+
+        if (seqEnabled_) roundTrip_.sent(f.seq, f.enqueuedNs);
+
+        const qint64 now = nowNs();
+        lastTxNs_ = now;
+        txBytes_.fetch_add(quint64(written), std::memory_order_relaxed);
+        switch (f.kind) {
+        case TxKind::Scheduled: txScheduled_.fetch_add(1, std::memory_order_relaxed);  break;
+        case TxKind::Urgent:    txUrgent_.fetch_add(1, std::memory_order_relaxed);     break;
+        case TxKind::Heartbeat: txHeartbeats_.fetch_add(1, std::memory_order_relaxed); break;
+        }
+        for (int i = 0; i < kMaxFields && (f.dirtyMask >> i); ++i) {
+            if (f.dirtyMask & (1u << i)) fieldLatency_[size_t(i)].add((now - f.dirtyNs[size_t(i)]) / 1000);
+        }
+
+        writtenOffset_ += written;
+        if (inFlightTail_ - inFlightHead_ < inFlight_.size()) {
+            inFlight_[inFlightTail_++ % inFlight_.size()] = {writtenOffset_, f.enqueuedNs};
+        }
+        txFrames_.fetch_add(1, std::memory_order_relaxed);
     }
 }
 
-void SerialInterface::onReadyRead()
+void SerialInterface::scheduleTx_()
 {
-    const QByteArray chunk = serial_.readAll();
-    if (chunk.isEmpty()) return;
+    schedWakePending_.store(false, std::memory_order_release);
+    if (!txRequested_.load(std::memory_order_acquire)) return;   // already sent by an earlier slot
+    if (frameTimer_->isActive()) return;                          // next slot already armed
 
-    // guard against pathological growth
-    if (rx_accumulator_.size() + chunk.size() > kMaxReasonableLen) {
-        rx_accumulator_.clear();
-        emit errorOccurred("[Serial] RX accumulator overflow — cleared.");
+    const qint64 intervalNs = qint64(frameIntervalUs_.load(std::memory_order_relaxed)) * 1000;
+    const qint64 sinceNs    = nowNs() - lastTxNs_;
+    if (lastTxNs_ == 0 || sinceNs >= intervalNs) {
+        sendFrame_(TxKind::Scheduled);   // idle link: no added latency
         return;
     }
 
-    rx_accumulator_.append(chunk);
+    // Round up so the frame never leaves earlier than one period after the previous one
+    frameTimer_->start(int((intervalNs - sinceNs + 999999) / 1000000));
+}
+
+void SerialInterface::sendFrame_(TxKind kind)
+{
+    if (!serial_->isOpen()) return;
+    if (!enqueueTx_(kind)) {
+        emit errorOccurred("[Serial] Send: TX queue full.");
+        return;
+    }
+    drainTx_();
+}
+
+void SerialInterface::heartbeat_()
+{
+    const int ms = heartbeatMs_.load(std::memory_order_relaxed);
+    if (ms <= 0 || !serial_->isOpen()) return;
+    if (lastTxNs_ != 0 && nowNs() - lastTxNs_ < qint64(ms) * 1000000) return;   // link not idle
+    sendFrame_(TxKind::Heartbeat);
+}
+
+void SerialInterface::onBytesWritten_(qint64 bytes)
+{
+    flushedOffset_ += bytes;
+    const qint64 now = nowNs();
+    while (inFlightHead_ != inFlightTail_) {
+        const InFlight& f = inFlight_[inFlightHead_ % inFlight_.size()];
+        if (f.endOffset > flushedOffset_) break;
+        txLatency_.add((now - f.enqueuedNs) / 1000);
+        ++inFlightHead_;
+    }
+}
+
+void SerialInterface::onReadyRead_()
+{
+    // Read straight into the ring's free space; drain frames whenever it fills up
+    for (;;) {
+        size_t room = 0;
+        uint8_t* dst = rx_framer_.writePtr(room);
+        if (room == 0) {
+            processIncoming();
+            dst = rx_framer_.writePtr(room);
+            if (room == 0) break;
+        }
+
+        const qint64 got = serial_->read(reinterpret_cast<char*>(dst), qint64(room));
+        if (got <= 0) break;
+        rx_framer_.commit(size_t(got));
+        rxBytes_.fetch_add(quint64(got), std::memory_order_relaxed);
+    }
+
     processIncoming();
 }
 
 void SerialInterface::processIncoming()
 {
+    const qint64 receivedNs = nowNs();
+    bool queued = false;
+
     // Frames are 0x00-terminated. There may be multiple complete frames.
-    int delim_index;
-    while ((delim_index = rx_accumulator_.indexOf('\x00')) >= 0) {
-        const QByteArray one_frame_no_terminator = rx_accumulator_.left(delim_index);
-        rx_accumulator_.remove(0, delim_index + 1); // consume frame + delimiter
-
-        // Basic sanity on encoded length (without 0x00)
-        const int min_enc = minCobsEncodedLength(rx_len_);
-        const int max_enc = maxCobsEncodedLength(rx_len_);
-        if (one_frame_no_terminator.size() < min_enc ||
-            one_frame_no_terminator.size() > max_enc) {
+    for (CobsFramer::Result r; (r = rx_framer_.next()) != CobsFramer::Result::None;) {
+        switch (r) {
+        case CobsFramer::Result::BadLength:
+            rxBadFrames_.fetch_add(1, std::memory_order_relaxed);
             emit errorOccurred(QString("[Serial] Bad frame size: %1 (expected %2..%3)")
-                                   .arg(one_frame_no_terminator.size()).arg(min_enc).arg(max_enc));
+                                   .arg(rx_framer_.lastEncodedLen())
+                                   .arg(CobsFramer::minEncodedLength(std::min(size_t(rx_len_), LinkProtocol::kOverhead)))
+                                   .arg(CobsFramer::maxEncodedLength(std::max(size_t(rx_len_), LinkProtocol::kMaxFrame))));
             continue;
+        case CobsFramer::Result::BadEncoding:
+            rxBadFrames_.fetch_add(1, std::memory_order_relaxed);
+            emit errorOccurred(QString("[Serial] COBS decode failed (encoded length %1)")
+                                   .arg(rx_framer_.lastEncodedLen()));
+            continue;
+        case CobsFramer::Result::Overflow:
+            rxBadFrames_.fetch_add(1, std::memory_order_relaxed);
+            emit errorOccurred("[Serial] RX buffer overflow without delimiter — cleared.");
+            continue;
+        default:
+            break;
         }
 
-        const QByteArray decoded = cobsDecode(one_frame_no_terminator);
-        if (decoded.size() != rx_len_) {
-            emit errorOccurred(QString("[Serial] COBS decode failed or wrong length: %1 (expected %2)")
-                                   .arg(decoded.size()).arg(rx_len_));
+        // V2 if header, length and CRC agree; otherwise a V1 frame must have the fixed length
+        const uint8_t* payload = rx_framer_.payload();
+        const size_t   len     = rx_framer_.payloadLen();
+
+        LinkProtocol::Message msg;
+        const LinkProtocol::ParseResult parsed = LinkProtocol::parse(payload, len, msg);
+        if (parsed == LinkProtocol::ParseResult::Ok) {
+            rxV2Frames_.fetch_add(1, std::memory_order_relaxed);
+            const quint16 step = quint16(msg.seq - lastRxSeq_);
+            if (lastRxSeq_ != 0 && step > 1 && step < 0x8000) {
+                // 0 is never sent, so a wrap-around skips one number
+                rxLost_.fetch_add(step - 1 - (msg.seq < lastRxSeq_ ? 1 : 0), std::memory_order_relaxed);
+            }
+            lastRxSeq_ = msg.seq;
+
+            if (msg.type != LinkProtocol::MsgType::Telemetry) {
+                handleControl_(msg, receivedNs);
+                continue;   // nothing for the fixed RX image
+            }
+            payload = translateTelemetry_(msg);
+            if (!payload) continue;
+        } else if (len == size_t(rx_len_)) {
+            rxV1Frames_.fetch_add(1, std::memory_order_relaxed);
+        } else {
+            if (parsed == LinkProtocol::ParseResult::BadCrc) {
+                rxCrcErrors_.fetch_add(1, std::memory_order_relaxed);
+                emit errorOccurred(QString("[Serial] V2 CRC mismatch (%1 bytes)").arg(len));
+            } else {
+                rxBadFrames_.fetch_add(1, std::memory_order_relaxed);
+                emit errorOccurred(QString("[Serial] Bad frame: %1 bytes, not V1 (%2) or V2").arg(len).arg(rx_len_));
+            }
             continue;
         }
 
-        latest_rx_payload_ = decoded;
+        if (isRecording_) {
+            logWriter_.append(SerialLog::Direction::Rx, payload, rx_len_, receivedNs);
+        }
 
-        if (isRecording_ && logStream_.device())
-        {
-            const QString ts =
-                QDateTime::currentDateTime().toString("yyyy-MM-dd HH:mm:ss.zzz");
-            logStream_ << ts;
-            for (int i = 0; i < latest_rx_payload_.size(); ++i) {
-                const auto v = static_cast<unsigned char>(latest_rx_payload_.at(i));
-                logStream_ << ',' << v;
-            }
-            logStream_ << '\n';
+        if (seqEnabled_) {
+            roundTrip_.echoed(quint16((payload[kRxEchoPos] << 8) | payload[kRxEchoPos + 1]), receivedNs);
         }
 
-        emit dataReceived(latest_rx_payload_);
+        RxFrame f;
+        std::memcpy(f.payload.data(), payload, size_t(rx_len_));
+        f.receivedNs = receivedNs;
+        if (rxQueue_.push(f)) queued = true;
+        else rxDropped_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    if (queued && !rxWakePending_.exchange(true, std::memory_order_acq_rel)) {
+        QMetaObject::invokeMethod(this, [this](){ drainRx_(); }, Qt::QueuedConnection);
     }
 }
 
-void SerialInterface::saveLatestTxCsv_()
+const uint8_t* SerialInterface::translateTelemetry_(const LinkProtocol::Message& msg)
 {
-    QDir base(QCoreApplication::applicationDirPath());
-    const QString dn = base.dirName().toLower();
+    namespace T = LinkProtocol::TelemetryLayout;
+    if (msg.type != LinkProtocol::MsgType::Telemetry || msg.len < T::Length) return nullptr;
 
-    if (dn == "release" || dn == "debug") base.cdUp();
-    base.mkpath("SerialLogs");
-    const QString path = base.filePath("SerialLogs/LatestSentSerial.csv");
+    const uint8_t* p = msg.payload;
+    fwRxFrames_.store(quint64((p[T::RxFrames] << 8) | p[T::RxFrames + 1]), std::memory_order_relaxed);
+    fwRxErrors_.store(quint64((p[T::RxErrors] << 8) | p[T::RxErrors + 1]), std::memory_order_relaxed);
 
-    QFile f(path);
-    if (!f.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text))
-    {
-        emit errorOccurred(QString("[Serial] Save latest TX failed: %1").arg(f.errorString()));
+    // Same offsets as the V1 uplink frame (TelemetrySchema.h)
+    uint8_t image[TelemetryImage::LENGTH] = {};
+    image[TelemetryImage::counter] = p[T::Counter];
+    std::memcpy(image + TelemetryImage::roll,       p + T::Rpy, 6);
+    std::memcpy(image + TelemetryImage::echoSeq,    p + T::EchoSeq, 2);
+    std::memcpy(image + TelemetryImage::fwRxFrames, p + T::RxFrames, 2);
+    std::memcpy(image + TelemetryImage::fwRxErrors, p + T::RxErrors, 2);
+
+    std::fill(rxImage_.begin(), rxImage_.begin() + rx_len_, 0);
+    std::memcpy(rxImage_.data(), image, std::min(sizeof(image), size_t(rx_len_)));
+    return rxImage_.data();
+}
+
+// ---- Benchmark / negotiation ----
+
+void SerialInterface::handleControl_(const LinkProtocol::Message& msg, qint64 receivedNs)
+{
+    using LinkProtocol::MsgType;
+
+    if (msg.type == MsgType::Info && msg.len >= LinkProtocol::InfoLayout::Name) {
+        namespace I = LinkProtocol::InfoLayout;
+        QMutexLocker lock(&infoMutex_);
+        info_.id       = msg.payload[I::DeviceId];
+        info_.firmware = msg.payload[I::Firmware];
+        info_.name     = QString::fromLatin1(reinterpret_cast<const char*>(msg.payload + I::Name),
+                                             qsizetype(msg.len - I::Name));
+        infoReceived_  = true;
         return;
     }
 
-    QTextStream s(&f);
-#if QT_VERSION >= QT_VERSION_CHECK(6,0,0)
-    s.setEncoding(QStringConverter::Utf8);
-#endif
+    if (msg.type == MsgType::BaudAck && msg.len >= 5) {
+        baudAck_.received = true;
+        baudAck_.baud     = LinkProtocol::getU32(msg.payload);
+        baudAck_.status   = msg.payload[4];
+        return;
+    }
 
-    s << "timestamp";
-    for (int i = 0; i < tx_len_; ++i) s << ",b" << i;
-    s << '\n';
+    if (msg.type != MsgType::Pong || !probe_.active || msg.len < 2) return;
 
-    const QString ts = QDateTime::currentDateTime().toString("yyyy-MM-dd HH:mm:ss.zzz");
-    s << ts;
-    for (int i = 0; i < tx_message_.size(); ++i) {
-        const auto v = static_cast<unsigned char>(tx_message_.at(i));
-        s << ',' << v;
+    // Payload: nonce (2) + pattern derived from the nonce
+    const quint16 nonce = quint16((msg.payload[0] << 8) | msg.payload[1]);
+    const size_t  slot  = nonce & 0xFF;
+    if (probe_.sentNs[slot] == 0 || probe_.nonce[slot] != nonce) return;   // already timed out
+
+    bool intact = msg.len == size_t(probe_.payloadLen);
+    for (size_t i = 2; intact && i < msg.len; ++i) {
+        intact = msg.payload[i] == uint8_t(nonce * 31 + i * 7);
     }
-    s << '\n';
+
+    if (intact) {
+        ++probe_.echoed;
+        probe_.rttSumUs += quint64(std::max<qint64>(0, receivedNs - probe_.sentNs[slot]) / 1000);
+    } else {
+        ++probe_.corrupted;
+    }
+    probe_.sentNs[slot] = 0;
+    --probe_.outstanding;
 }
 
-// ======================= COBS (Consistent Overhead Byte Stuffing) =======================
+bool SerialInterface::writeV2_(LinkProtocol::MsgType type, const uint8_t* payload, size_t len)
+{
+    std::array<uint8_t, LinkProtocol::kMaxFrame> msg;
+    quint16 seq;
+    {
+        QMutexLocker lock(&txMutex_);
+        if (++txSeq_ == 0) ++txSeq_;
+        seq = txSeq_;
+    }
+    const size_t n = LinkProtocol::build(type, seq, payload, len, msg.data());
+
+    std::array<uint8_t, kMaxFrameBytes> bytes;
+    const size_t enc = CobsFramer::encode(msg.data(), n, bytes.data());
+    bytes[enc] = 0x00;
 
-// Encode algorithm: emit "code" byte followed by up to 254 non-zero bytes, repeat; no zero in payload.
-// We return encoded sequence WITHOUT the trailing 0x00 delimiter.
-QByteArray SerialInterface::cobsEncode(const QByteArray& input)
+    const qint64 written = serial_->write(reinterpret_cast<const char*>(bytes.data()), qint64(enc + 1));
+    if (written != qint64(enc + 1)) return false;
+
+    // Keeps onBytesWritten_ bookkeeping consistent; not counted as a TX frame
+    writtenOffset_ += written;
+    lastTxNs_ = nowNs();
+    txBytes_.fetch_add(quint64(written), std::memory_order_relaxed);
+    return true;
+}
+
+bool SerialInterface::waitFor_(int ms, const std::function<bool()>& done)
 {
-    if (input.isEmpty()) return QByteArray(); // we assume fixed length > 0
-    QByteArray out;
-    out.reserve(input.size() + input.size() / 254 + 1);
+    // No event loop runs here: readyRead is delivered from inside waitForReadyRead()
+    const qint64 deadline = nowNs() + qint64(ms) * 1000000;
+    while (!done()) {
+        if (aborting_.load(std::memory_order_relaxed)) return false;
+        const qint64 left = deadline - nowNs();
+        if (left <= 0) return false;
+        serial_->waitForReadyRead(int(std::clamp<qint64>(left / 1000000, 1, 5)));
+    }
+    return true;
+}
 
-    int code_index = 0;
-    quint8 code = 1;
-    out.append('\x00'); // placeholder for first code
+bool SerialInterface::identify_(int timeoutMs)
+{
+    constexpr int kRetryMs = 250;   // frames sent while the bootloader runs are lost
 
-    for (unsigned char uc : input) {
-        if (uc == 0x00) {
-            out[code_index] = static_cast<char>(code);
-            code_index = out.size();
-            out.append('\x00'); // placeholder for next code
-            code = 1;
-        } else {
-            out.append(static_cast<char>(uc));
-            ++code;
-            if (code == 0xFF) {
-                out[code_index] = static_cast<char>(code);
-                code_index = out.size();
-                out.append('\x00'); // placeholder for next code
-                code = 1;
+    infoReceived_ = false;
+    const qint64 deadline = nowNs() + qint64(timeoutMs) * 1000000;
+    for (qint64 left = timeoutMs; left > 0; left = (deadline - nowNs()) / 1000000) {
+        if (!writeV2_(LinkProtocol::MsgType::Identify, nullptr, 0)) return false;
+        if (waitFor_(int(std::min<qint64>(left, kRetryMs)), [this](){ return infoReceived_; })) return true;
+        if (aborting_.load(std::memory_order_relaxed)) return false;
+    }
+    return false;
+}
+
+SerialInterface::LinkProbe SerialInterface::runProbe_(int durationMs, int payloadLen)
+{
+    payloadLen = std::clamp(payloadLen, 2, int(LinkProtocol::kMaxPayload));
+    probe_ = ProbeState();
+    probe_.active     = true;
+    probe_.payloadLen = payloadLen;
+
+    const quint64 bytes0 = txBytes_.load(std::memory_order_relaxed) + rxBytes_.load(std::memory_order_relaxed);
+    const qint64  t0     = nowNs();
+    const qint64  end    = t0 + qint64(durationMs) * 1000000;
+    const qint64  timeoutNs = qint64(kProbeTimeoutMs) * 1000000;
+
+    auto expire = [&](qint64 now, bool all) {
+        for (size_t i = 0; i < probe_.sentNs.size(); ++i) {
+            if (probe_.sentNs[i] == 0 || (!all && now - probe_.sentNs[i] < timeoutNs)) continue;
+            probe_.sentNs[i] = 0;
+            --probe_.outstanding;
+            ++probe_.lost;
+        }
+    };
+
+    uint8_t payload[LinkProtocol::kMaxPayload];
+    for (qint64 now = t0; now < end; now = nowNs()) {
+        expire(now, false);
+
+        // Keep the window full; a slot still waiting for its answer is not reused
+        while (probe_.outstanding < kProbeWindow) {
+            const quint16 nonce = ++probe_.nextNonce;
+            const size_t  slot  = nonce & 0xFF;
+            if (probe_.sentNs[slot] != 0) break;
+
+            payload[0] = uint8_t(nonce >> 8);
+            payload[1] = uint8_t(nonce & 0xFF);
+            for (int i = 2; i < payloadLen; ++i) payload[i] = uint8_t(nonce * 31 + i * 7);
+
+            probe_.nonce[slot]  = nonce;
+            probe_.sentNs[slot] = nowNs();
+            if (!writeV2_(LinkProtocol::MsgType::Ping, payload, size_t(payloadLen))) {
+                probe_.sentNs[slot] = 0;
+                break;
             }
+            ++probe_.outstanding;
+            ++probe_.sent;
         }
+        serial_->waitForReadyRead(2);
     }
-    out[code_index] = static_cast<char>(code);
-    return out;
+
+    // Let the last answers come in, then count what is still missing as lost
+    waitFor_(kProbeTimeoutMs, [this](){ return probe_.outstanding == 0; });
+    expire(nowNs(), true);
+    probe_.active = false;
+
+    LinkProbe p;
+    p.baud      = baudRate_.load(std::memory_order_relaxed);
+    p.sent      = probe_.sent;
+    p.echoed    = probe_.echoed;
+    p.lost      = probe_.lost;
+    p.corrupted = probe_.corrupted;
+
+    const double elapsed = double(nowNs() - t0) / 1e9;
+    const quint64 bytes  = txBytes_.load(std::memory_order_relaxed) + rxBytes_.load(std::memory_order_relaxed) - bytes0;
+    if (elapsed > 0.0) {
+        p.framesPerSec = double(p.echoed) / elapsed;
+        p.bytesPerSec  = double(bytes) / elapsed;
+    }
+    if (p.sent > 0)   p.errorRate = double(p.lost + p.corrupted) / double(p.sent);
+    if (p.echoed > 0) p.rttMeanUs = double(probe_.rttSumUs) / double(p.echoed);
+    return p;
 }
 
-// Decode algorithm: walk code blocks; code=n means (n-1) following non-zero bytes; if code=0 → error.
-// Returns empty on malformed input.
-QByteArray SerialInterface::cobsDecode(const QByteArray& encoded)
+int SerialInterface::negotiate_(const QList<int>& candidates, QVector<LinkProbe>* report)
 {
-    QByteArray out;
-    out.reserve(encoded.size()); // approximate
+    constexpr int kAckTimeoutMs = 300;
+    constexpr int kProbeMs      = 200;
+    constexpr int kPayloadLen   = 16;
+
+    auto log = [](const LinkProbe& p) {
+        qDebug() << "[Serial] Baud" << p.baud << (p.ok ? "ok:" : "rejected:") << QString::number(p.framesPerSec, 'f', 0)
+                 << "pings/s," << QString::number(p.bytesPerSec / 1024.0, 'f', 1) << "KB/s, error rate"
+                 << QString::number(p.errorRate * 100.0, 'f', 2) << "%, RTT" << QString::number(p.rttMeanUs, 'f', 0)
+                 << "us (" << p.echoed << "/" << p.sent << "echoed )";
+    };
+
+    int current = baudRate_.load(std::memory_order_relaxed);
+
+    LinkProbe baseline = runProbe_(kProbeMs, kPayloadLen);
+    baseline.ok = baseline.echoed > 0;
+    log(baseline);
+    if (report) report->push_back(baseline);
+    if (!baseline.ok) {
+        emit errorOccurred("[Serial] Baud negotiation: no answer to pings at the current rate.");
+        return current;
+    }
+
+    QList<int> rates = candidates;
+    std::sort(rates.begin(), rates.end());
+
+    for (int rate : rates) {
+        if (rate <= current) continue;
 
-    int i = 0;
-    const int n = encoded.size();
+        uint8_t arg[4];
+        LinkProtocol::putU32(arg, quint32(rate));
+        auto acked = [&](LinkProtocol::BaudStatus status) {
+            return waitFor_(kAckTimeoutMs, [this](){ return baudAck_.received; })
+                && baudAck_.baud == quint32(rate) && baudAck_.status == quint8(status);
+        };
 
-    while (i < n) {
-        const quint8 code = static_cast<quint8>(encoded.at(i));
-        if (code == 0) {
-            return QByteArray(); // invalid
+        baudAck_ = BaudAck();
+        if (!writeV2_(LinkProtocol::MsgType::BaudPropose, arg, sizeof(arg))
+            || !acked(LinkProtocol::BaudStatus::Switching)) {
+            qDebug() << "[Serial] Baud" << rate << "not supported by the firmware";
+            LinkProbe p;
+            p.baud = rate;
+            if (report) report->push_back(p);
+            break;
         }
-        ++i;
-        const int copy_len = code - 1;
 
-        if (i + copy_len > n) {
-            return QByteArray(); // truncated
+        // The firmware switches right after the ack went out
+        const qint64 switchedNs = nowNs();
+        serial_->setBaudRate(rate);
+        serial_->clear(QSerialPort::Input);
+        rx_framer_.clear();
+        baudRate_.store(rate, std::memory_order_relaxed);
+
+        LinkProbe p = runProbe_(kProbeMs, kPayloadLen);
+        p.ok = p.sent > 0 && p.echoed * 100 >= p.sent * 98 && p.errorRate <= 0.01;
+        if (p.ok) {
+            baudAck_ = BaudAck();
+            p.ok = writeV2_(LinkProtocol::MsgType::BaudCommit, arg, sizeof(arg))
+                && acked(LinkProtocol::BaudStatus::Committed);
         }
-        out.append(encoded.constData() + i, copy_len);
-        i += copy_len;
+        log(p);
+        if (report) report->push_back(p);
 
-        // if code < 0xFF and not at the very end, we insert a zero
-        if (code < 0xFF && i < n) {
-            out.append('\x00');
+        if (!p.ok) {
+            // Back to the last good rate once the firmware has reverted on its own
+            serial_->setBaudRate(current);
+            baudRate_.store(current, std::memory_order_relaxed);
+            const qint64 revertNs = switchedNs + qint64(kBaudRevertMs + 50) * 1000000;
+            waitFor_(int(std::max<qint64>(0, revertNs - nowNs()) / 1000000), [](){ return false; });
+            serial_->clear(QSerialPort::Input);
+            rx_framer_.clear();
+            writeV2_(LinkProtocol::MsgType::Heartbeat, nullptr, 0);   // feed the PowerGuard right away
+            break;
         }
+        current = rate;
     }
-    return out;
+
+    qDebug() << "[Serial] Baud rate:" << current;
+    return current;
 }
 
-// For a raw payload of length L:
-// - Min encoded length occurs when there are no zeros and all code blocks are full (except last).
-//   Every 254 bytes forces a code byte. Rough bound: ceil(L/254) code bytes + L data bytes.
-//   We return a simple safe bound here.
-int SerialInterface::minCobsEncodedLength(int raw_len)
+void SerialInterface::logStats_()
 {
-    if (raw_len <= 0) return 0;
-    const int code_bytes = (raw_len + 253) / 254; // ceil
-    return raw_len + code_bytes;
+    if (!lcSerialStats().isDebugEnabled()) return;
+
+    const LinkStats s = stats();
+    qCDebug(lcSerialStats) << "[Serial] TX" << s.txFrames << "frames (" << s.txDropped << "dropped), latency"
+                           << s.txMeanUs << "us mean /" << s.txMaxUs << "us max | RX" << s.rxFrames << "frames ("
+                           << s.rxDropped << "dropped), latency" << s.rxMeanUs << "us mean /" << s.rxMaxUs << "us max";
+    qCDebug(lcSerialStats) << "[Serial] RX" << s.rxV1Frames << "V1 /" << s.rxV2Frames << "V2 frames," << s.rxCrcErrors
+                           << "CRC errors," << s.rxBadFrames << "bad frames," << s.rxLost << "lost, error rate"
+                           << QString::number(s.rxErrorRate * 100.0, 'f', 3) << "%, utilization"
+                           << QString::number(s.rxUtilization * 100.0, 'f', 2) << "% | firmware" << s.fwRxFrames
+                           << "frames /" << s.fwRxErrors << "errors";
+    qCDebug(lcSerialStats) << "[Serial] TX mix" << s.txScheduled << "scheduled /" << s.txUrgent << "urgent /"
+                           << s.txHeartbeats << "heartbeat," << s.updates << "field updates, utilization"
+                           << QString::number(s.txUtilization * 100.0, 'f', 2) << "%";
+    for (const FieldLatency& f : fieldLatency()) {
+        qCDebug(lcSerialStats) << "[Serial] Field" << f.position << "update-to-wire" << f.meanUs << "us mean /"
+                               << f.maxUs << "us max (" << f.count << "frames )";
+    }
+
+    if (seqEnabled_) {
+        const RoundTripTracker::Snapshot rt = roundTrip_.snapshot();
+        qCDebug(lcSerialStats) << "[Serial] RTT" << rt.samples << "samples, p50" << rt.p50Us << "us / p95" << rt.p95Us
+                               << "us / p99" << rt.p99Us << "us / max" << rt.maxUs << "us |" << rt.lost << "lost,"
+                               << rt.reordered << "reordered";
+    }
 }
 
-// Max encoded length occurs when every byte is zero -> each code byte covers 0 data bytes,
-// but COBS still emits a code byte per zero (value 0x01). So encoded length == raw_len + 1.
-int SerialInterface::maxCobsEncodedLength(int raw_len)
+// ======================= Owner thread =======================
+
+SerialInterface::LinkProbe SerialInterface::benchmark(int durationMs, int payloadLen)
 {
-    if (raw_len <= 0) return 0;
-    return raw_len + 1;
+    LinkProbe p;
+    if (!isOpen() || protocol() != Protocol::V2) {
+        emit errorOccurred("[Serial] Benchmark needs an open port and protocol V2.");
+        return p;
+    }
+    QMetaObject::invokeMethod(serial_, [&](){ p = runProbe_(durationMs, payloadLen); },
+                              Qt::BlockingQueuedConnection);
+    return p;
+}
+
+int SerialInterface::negotiateBaud(const QList<int>& candidates, QVector<LinkProbe>* report)
+{
+    if (!isOpen() || protocol() != Protocol::V2) {
+        emit errorOccurred("[Serial] Baud negotiation needs an open port and protocol V2.");
+        return baudRate();
+    }
+
+    int rate = baudRate();
+    QMetaObject::invokeMethod(serial_, [&](){ rate = negotiate_(candidates, report); },
+                              Qt::BlockingQueuedConnection);
+    return rate;
+}
+
+bool SerialInterface::injectReceived(const uint8_t* payload, int len)
+{
+    if (len != rx_len_) {
+        emit errorOccurred(QString("[Serial] Replay frame size: %1 (expected %2)").arg(len).arg(rx_len_));
+        return true;   // consumed (and dropped) so the replayer moves on
+    }
+
+    RxFrame f;
+    std::memcpy(f.payload.data(), payload, size_t(len));
+    f.receivedNs = nowNs();
+    if (!replayQueue_.push(f)) return false;
+
+    if (!rxWakePending_.exchange(true, std::memory_order_acq_rel)) {
+        QMetaObject::invokeMethod(this, [this](){ drainRx_(); }, Qt::QueuedConnection);
+    }
+    return true;
+}
+
+void SerialInterface::drainRx_()
+{
+    rxWakePending_.store(false, std::memory_order_release);
+
+    RxFrame f;
+    while (rxQueue_.pop(f) || replayQueue_.pop(f)) {
+        // Rewritten in place; only detaches if a receiver still holds the previous payload
+        std::memcpy(latest_rx_payload_.data(), f.payload.data(), size_t(rx_len_));
+        rxLatency_.add((nowNs() - f.receivedNs) / 1000);
+        rxFrames_.fetch_add(1, std::memory_order_relaxed);
+
+        emit dataReceived(latest_rx_payload_);
+    }
+}
+
+// ======================= Helpers =======================
+
+bool SerialInterface::enqueueTx_(TxKind kind)
+{
+    TxFrame f;
+    f.kind = kind;
+    {
+        QMutexLocker lock(&txMutex_);
+        std::memcpy(f.raw.data(), tx_message_.constData(), size_t(tx_len_));
+
+        // This frame carries every change made so far
+        f.dirtyMask = dirtyMask_;
+        f.dirtyNs   = dirtyNs_;
+
+        // Sequence number for round-trip matching (0 = "none" on the firmware side)
+        if (++txSeq_ == 0) ++txSeq_;
+        f.seq = txSeq_;
+        if (seqEnabled_) {
+            f.raw[kTxSeqPos]     = uint8_t(f.seq >> 8);
+            f.raw[kTxSeqPos + 1] = uint8_t(f.seq & 0xFF);
+        }
+
+        // V1: the whole image. V2: one typed message (the image is still what gets logged)
+        std::array<uint8_t, LinkProtocol::kMaxFrame> v2;
+        const uint8_t* wire    = f.raw.data();
+        size_t         wireLen = size_t(tx_len_);
+        if (protocol() == Protocol::V2) {
+            wireLen = buildV2_(kind, f.seq, v2.data());
+            wire    = v2.data();
+        }
+
+        // COBS encode + trailing 0x00 delimiter
+        const size_t n = CobsFramer::encode(wire, wireLen, f.bytes.data());
+        f.bytes[n] = 0x00; // delimiter
+        f.len = int(n + 1);
+        f.enqueuedNs = nowNs();
+
+        // Single producer at a time: the push stays under the message lock.
+        // The pending changes are only cleared once a frame carries them; after a failed push
+        // they stay dirty, so the next frame (a later Send() or heartbeat) still sends them.
+        if (txQueue_.push(f)) {
+            txRequested_.store(false, std::memory_order_release);
+            dirtyMask_   = 0;
+            dirtyMotors_ = 0;
+            return true;
+        }
+        txSeq_ = quint16(f.seq - 1);
+    }
+    txDropped_.fetch_add(1, std::memory_order_relaxed);
+    return false;
+}
+
+size_t SerialInterface::buildV2_(TxKind kind, quint16 seq, uint8_t* out)
+{
+    using namespace LinkProtocol;
+    constexpr uint8_t kAllMotors   = uint8_t((1u << kMotorCount) - 1);
+    constexpr quint32 kRefreshEvery = 4;   // heartbeats between full-state refreshes
+
+    uint8_t mask = 0;
+    switch (kind) {
+    case TxKind::Urgent:    mask = kAllMotors; break;
+    case TxKind::Scheduled: mask = dirtyMotors_; break;
+    case TxKind::Heartbeat:
+        // enqueueTx_ clears the pending request and dirtyMotors_ for every queued frame kind, so
+        // a heartbeat that overtakes a queued scheduleTx_() must carry the changed motors itself
+        mask = (++v2Heartbeats_ % kRefreshEvery == 0) ? kAllMotors : dirtyMotors_;
+        break;
+    }
+
+    if (mask == 0) return build(MsgType::Heartbeat, seq, nullptr, 0, out);
+
+    uint8_t payload[kMaxPayload];
+    const size_t len = buildSetMotors(mask, reinterpret_cast<const uint8_t*>(tx_message_.constData()), payload);
+    return build(MsgType::SetMotors, seq, payload, len, out);
+}
+
+bool SerialInterface::wakeTx_()
+{
+    if (!txWakePending_.exchange(true, std::memory_order_acq_rel)) {
+        QMetaObject::invokeMethod(serial_, [this](){ drainTx_(); }, Qt::QueuedConnection);
+    }
+    return true;
+}
+
+qint64 SerialInterface::nowNs()
+{
+    // Same clock as the binary log timestamps
+    return SerialLog::monotonicNs();
+}
+
+void SerialInterface::LatencyAcc::add(qint64 us)
+{
+    if (us < 0) us = 0;
+    count.fetch_add(1, std::memory_order_relaxed);
+    sumUs.fetch_add(quint64(us), std::memory_order_relaxed);
+    quint64 prev = maxUs.load(std::memory_order_relaxed);
+    while (quint64(us) > prev && !maxUs.compare_exchange_weak(prev, quint64(us), std::memory_order_relaxed)) {}
+}
+
+void SerialInterface::saveLatestTxCsv_()
+{
+    QDir base(QCoreApplication::applicationDirPath());
+    const QString dn = base.dirName().toLower();
+
+    if (dn == "release" || dn == "debug") base.cdUp();
+    base.mkpath("SerialLogs");
+    const QString path = base.filePath("SerialLogs/LatestSentSerial.csv");
+
+    QFile f(path);
+    if (!f.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text))
+    {
+        emit errorOccurred(QString("[Serial] Save latest TX failed: %1").arg(f.errorString()));
+        return;
+    }
+
+    QTextStream s(&f);
+#if QT_VERSION >= QT_VERSION_CHECK(6,0,0)
+    s.setEncoding(QStringConverter::Utf8);
+#endif
+
+    s << "timestamp";
+    for (int i = 0; i < tx_len_; ++i) s << ",b" << i;
+    s << '\n';
+
+    QByteArray message;
+    {
+        QMutexLocker lock(&txMutex_);
+        message = tx_message_;
+    }
+
+    const QString ts = QDateTime::currentDateTime().toString("yyyy-MM-dd HH:mm:ss.zzz");
+    s << ts;
+    for (int i = 0; i < message.size(); ++i) {
+        const auto v = static_cast<unsigned char>(message.at(i));
+        s << ',' << v;
+    }
+    s << '\n';
 }
@@ -9,13 +9,27 @@
 #include <QDebug>
 #include <QDir>
 #include <QFile>
+#include <QMutex>
 #include <QObject>
 #include <QSerialPort>
 #include <QSerialPortInfo>
 #include <QStandardPaths>
 #include <QString>
 #include <QTextStream>
+#include <QThread>
 #include <QTimer>
+#include <QVector>
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+
+#include "cobsframer.h"
+#include "linkprotocol.h"
+#include "roundtriptracker.h"
+#include "seriallog.h"
+#include "spscqueue.h"
 
 /**
  * @brief Qt-based serial interface with COBS framing for fixed-length TX/RX (Transmitter/Receiver) payloads.
@@ -23,13 +37,57 @@
  * Usage:
  *   SerialInterface serialInterface(tx_len, rx_len);
  *   serialInterface.open("COM3", 115200);
+ *   serialInterface.setFrameRate(50);        // optional TX scheduler
  *   serialInterface.SetMessage(0, QByteArray::fromHex("01020304"));
- *   serialInterface.Send();
+ *   serialInterface.Send();                  // next frame slot (coalesced)
+ *   serialInterface.SendUrgent();            // now
  *   auto latest = serialInterface.readLatest(); // fixed length rx_len
  *
+ * Threading:
+ *   The port, COBS framing and the heartbeat run on a dedicated I/O thread.
+ *   SetMessage()/Send() may be called from any thread: Send() encodes the current
+ *   message into a TX queue slot and wakes the I/O thread. Decoded RX payloads come
+ *   back through a second queue and are emitted on the thread that owns this object.
+ *   Both queues are lock-free SPSC rings; concurrent Send() callers are serialised
+ *   on the producer side by the message mutex.
+ *
+ * TX scheduling (setFrameRate > 0):
+ *   Send() only asks for a frame. Frames are at least one frame period apart: a request
+ *   after an idle period goes out at once, later ones wait for the next slot, and every
+ *   SetMessage() change made in between travels in that one frame. Unchanged bytes do
+ *   not mark the message dirty. Heartbeats are only sent when nothing else went out
+ *   for the heartbeat interval. SendUrgent() bypasses the clock.
+ *   With a frame rate of 0, Send() behaves like SendUrgent().
+ *
+ * Protocol:
+ *   V1 sends the whole fixed TX image in every frame. V2 (setProtocol) wraps typed messages
+ *   in a header with version, type, sequence number, length and CRC16 (see linkprotocol.h):
+ *   scheduled frames carry only the motors whose bytes changed, heartbeats carry only the
+ *   changes still pending (usually none), and urgent frames / every 4th heartbeat carry
+ *   all motors. Only the motor fields (bytes 0-11) travel in V2. Incoming V2 telemetry is
+ *   translated back into the fixed RX image described by TelemetrySchema.h (read it
+ *   through TelemetryView), so dataReceived(), the binary log and replay look the same
+ *   for both versions.
+ *   V1 frames are always accepted on receive; the firmware picks the version per frame.
+ *
+ * Baud rate (V2 only):
+ *   negotiateBaud() proposes each candidate rate in turn. The firmware acknowledges and
+ *   switches, the link is exercised with echoed Ping frames (benchmark()), and the rate is
+ *   committed only if nearly every ping came back intact; otherwise both sides fall back
+ *   (the firmware on its own after 500 ms). Both calls block the caller and pause the
+ *   regular traffic while they run.
+ *
+ * Round trip:
+ *   Every frame is stamped with a 16-bit sequence number in TX bytes 28-29 (big endian,
+ *   0 is skipped). The firmware echoes the last one it received in RX bytes 11-12, and
+ *   roundTrip() reports the Send() -> echo histogram plus loss / reorder counts.
+ *   SetMessage() writes into those two bytes are overwritten by the stamp.
+ *
  * Signals:
  *   dataReceived(QByteArray) emitted when a full valid frame is decoded.
  *   errorOccurred(QString) on errors (range, framing, port errors).
+ *   probeFinished(bool) at the end of probe().
+ *   disconnected() when the port reports a resource error (device removed).
  */
 
 class SerialInterface : public QObject
@@ -44,62 +102,287 @@ public:
     // This function returns the first port.
     QString port();
 
+    // Description / manufacturer look like an Arduino or a common USB-serial bridge
+    static bool isCandidatePort(const QSerialPortInfo& info);
+
     bool open(const QString& port_name, int baud_rate);
     void close();
     bool isOpen() const;
+    QString portName() const;
+
+    // Handshake (V2): opens the port and repeats Identify until the firmware answers with
+    // Info or `timeoutMs` runs out (an Uno reboots when the port is opened). Non-empty
+    // `baudCandidates` are then negotiated as in negotiateBaud(). Runs on the I/O thread and
+    // ends with probeFinished(); on failure the port is closed again.
+    struct DeviceInfo {
+        int     id       = -1;
+        int     firmware = 0;
+        QString name;
+    };
+    void probe(const QString& port_name, int baud_rate, int timeoutMs,
+               const QList<int>& baudCandidates = {});
+    DeviceInfo deviceInfo() const;
 
     // Transmitter
     bool SetMessage(int position, const QByteArray& chunk);
-    bool Send();
+    bool Send();          // scheduled (see TX scheduling)
+    bool SendUrgent();    // immediately, regardless of the frame clock
+
+    // Minimum spacing of scheduled frames (0 = Send() is immediate).
+    void setFrameRate(int hz);
+
+    // Echoed-ping benchmark at the current rate
+    struct LinkProbe {
+        int     baud         = 0;
+        bool    ok           = false;   // accepted by negotiateBaud()
+        quint64 sent         = 0;
+        quint64 echoed       = 0;
+        quint64 lost         = 0;       // no answer within kProbeTimeoutMs
+        quint64 corrupted    = 0;       // answered, but not with the bytes that were sent
+        double  framesPerSec = 0.0;     // echoed pings per second
+        double  bytesPerSec  = 0.0;     // both directions, on the wire
+        double  errorRate    = 0.0;     // (lost + corrupted) / sent
+        double  rttMeanUs    = 0.0;
+    };
+    LinkProbe benchmark(int durationMs, int payloadLen = 16);
+
+    // Returns the rate in use afterwards; `report` gets the baseline plus one entry per tried rate.
+    int negotiateBaud(const QList<int>& candidates, QVector<LinkProbe>* report = nullptr);
+    int baudRate() const { return baudRate_.load(std::memory_order_relaxed); }
+
+    enum class Protocol { V1 = 1, V2 = 2 };
+    void     setProtocol(Protocol protocol);
+    Protocol protocol() const { return Protocol(protocol_.load(std::memory_order_relaxed)); }
+
+    // Re-send the current message from the I/O thread when the link was idle for `ms` (0 = off).
+    // Keeps the firmware's PowerGuard fed even while the GUI thread is busy.
+    void setHeartbeatInterval(int ms);
 
     // Receiver
     QByteArray read() const;
 
+    // Feed a decoded RX payload as if it had arrived on the port (log replay).
+    // Single producer; returns false while the replay queue is full so the caller can retry.
+    bool injectReceived(const uint8_t* payload, int len);
+
+    // Latency is measured in microseconds:
+    //   TX: Send() -> bytes handed to the driver (bytesWritten)
+    //   RX: bytes read on the I/O thread -> dataReceived emitted
+    struct LinkStats {
+        quint64 txFrames      = 0;
+        quint64 txDropped     = 0;     // TX queue full
+        quint64 txBytes       = 0;     // on the wire incl. COBS overhead and delimiter
+        quint64 txScheduled   = 0;     // frames sent by the frame clock
+        quint64 txUrgent      = 0;
+        quint64 txHeartbeats  = 0;
+        quint64 updates       = 0;     // SetMessage() calls that changed the message
+        double  txUtilization = 0.0;   // TX bits / line capacity since open (0..1)
+        quint64 rxFrames   = 0;
+        quint64 rxDropped  = 0;   // RX queue full
+        quint64 rxBytes       = 0;
+        double  rxUtilization = 0.0;
+        quint64 rxV1Frames    = 0;
+        quint64 rxV2Frames    = 0;
+        quint64 rxCrcErrors   = 0;     // V2 frames with a bad CRC
+        quint64 rxBadFrames   = 0;     // framing / length errors
+        quint64 rxLost        = 0;     // gaps in the firmware's V2 sequence numbers
+        double  rxErrorRate   = 0.0;   // rejected / (accepted + rejected)
+        quint64 fwRxFrames    = 0;     // reported by the firmware (V2 telemetry, 16-bit wrap)
+        quint64 fwRxErrors    = 0;
+        double  txMeanUs   = 0.0;
+        double  txMaxUs    = 0.0;
+        double  rxMeanUs   = 0.0;
+        double  rxMaxUs    = 0.0;
+    };
+    LinkStats stats() const;
+
+    // SetMessage() -> frame handed to the driver, per field start position
+    struct FieldLatency {
+        int     position = 0;
+        quint64 count    = 0;
+        double  meanUs   = 0.0;
+        double  maxUs    = 0.0;
+    };
+    QVector<FieldLatency> fieldLatency() const;
+
+    // Send() -> echoed sequence number received on the I/O thread
+    RoundTripTracker::Snapshot roundTrip() const { return roundTrip_.snapshot(); }
+    void resetRoundTrip() { roundTrip_.reset(); }
+    bool hasRoundTrip() const { return seqEnabled_; }
+
 signals:
     void dataReceived(const QByteArray& payload); // size == rx_len_
     void errorOccurred(const QString& message);
+    void probeFinished(bool ok);
+    void disconnected();   // the port went away (e.g. unplugged) and has been closed
 
 public slots:
     void changeRecordState();
 
-private slots:
-    void onReadyRead();
-
 private:
-    // --- COBS helpers ---
-    // Returns encoded frame WITHOUT trailing 0x00; caller appends 0x00.
-    static QByteArray cobsEncode(const QByteArray& input);
-    // Decodes one COBS-encoded frame (without trailing 0x00). Returns empty on error.
-    static QByteArray cobsDecode(const QByteArray& encoded);
+    static constexpr int kMaxFrameBytes = 512;   // encoded frame incl. delimiter / raw payload
+    static constexpr size_t kQueueDepth = 64;
+    static constexpr int kTxSeqPos  = 28;   // sequence number stamped into TX payload (2 bytes)
+    static constexpr int kRxEchoPos = TelemetryImage::echoSeq;   // firmware echo of the last received sequence number
+    static constexpr int kMaxFields = 32;   // field latency is tracked for positions below this
+    static constexpr int kProbeWindow    = 2;     // pings in flight; 2 x 16-byte pings fit the Uno's 64-byte RX buffer
+    static constexpr int kProbeTimeoutMs = 100;
+    static constexpr int kBaudRevertMs   = 500;   // firmware falls back after this without a commit
 
-    static int minCobsEncodedLength(int raw_len);
-    static int maxCobsEncodedLength(int raw_len);
+    enum class TxKind { Scheduled, Urgent, Heartbeat };
+
+    struct TxFrame {
+        std::array<uint8_t, kMaxFrameBytes> bytes;   // COBS frame + delimiter
+        int     len = 0;
+        std::array<uint8_t, kMaxFrameBytes> raw;     // payload as sent (for the log)
+        qint64  enqueuedNs = 0;
+        quint16 seq = 0;
+        TxKind  kind = TxKind::Urgent;
+        quint32 dirtyMask = 0;                        // fields changed since the previous frame
+        std::array<qint64, kMaxFields> dirtyNs;       // first change of each field
+    };
+
+    struct RxFrame {
+        std::array<uint8_t, kMaxFrameBytes> payload;
+        qint64  receivedNs = 0;
+    };
+
+    // Atomic running statistics (written by one thread, read by any)
+    struct LatencyAcc {
+        std::atomic<quint64> count{0};
+        std::atomic<quint64> sumUs{0};
+        std::atomic<quint64> maxUs{0};
+        void add(qint64 us);
+    };
+
+    static qint64 nowNs();
 
     void configurePort(const QString& port_name, int baud_rate);
 
-    // framing
-    void processIncoming(); // parse rx_accumulator_ for 0x00-terminated frames
+    // ---- I/O thread ----
+    void onReadyRead_();
+    void onBytesWritten_(qint64 bytes);
+    void drainTx_();
+    void scheduleTx_();             // frame clock: send now or arm frameTimer_
+    void sendFrame_(TxKind kind);
+    void heartbeat_();
+    void processIncoming(); // pull 0x00-terminated frames out of rx_framer_
+    void startRecording_();
+    void stopRecording_();
+    void logStats_();       // every 10 s when "bendemo.stats.serial" debug output is enabled
+
+    // ---- Owner thread ----
+    void drainRx_();
 
+    bool enqueueTx_(TxKind kind);
+    size_t buildV2_(TxKind kind, quint16 seq, uint8_t* out);   // under txMutex_
+    const uint8_t* translateTelemetry_(const LinkProtocol::Message& msg);
+
+    bool wakeTx_();                 // any thread -> I/O thread, drainTx_()
     void saveLatestTxCsv_();
 
+    // ---- Port lifetime (I/O thread) ----
+    bool openPort_(const QString& port_name, int baud_rate);
+    void closePort_();
+
+    // ---- Handshake / benchmark / negotiation (I/O thread, blocking) ----
+    void handleControl_(const LinkProtocol::Message& msg, qint64 receivedNs);
+    bool writeV2_(LinkProtocol::MsgType type, const uint8_t* payload, size_t len);
+    bool waitFor_(int ms, const std::function<bool()>& done);   // false on timeout or shutdown
+    bool identify_(int timeoutMs);
+    LinkProbe runProbe_(int durationMs, int payloadLen);
+    int  negotiate_(const QList<int>& candidates, QVector<LinkProbe>* report);
+
 private:
-    QSerialPort serial_;
     const int tx_len_;
     const int rx_len_;
-    bool isOpened_{false};
+    std::atomic<bool> isOpened_{false};
+
+    // I/O thread and the objects living on it
+    QThread      ioThread_;
+    QSerialPort* serial_         = nullptr;   // deleted on the I/O thread when it finishes
+    QTimer*      heartbeatTimer_ = nullptr;
+    QTimer*      frameTimer_     = nullptr;   // single shot, armed for the next frame slot
+    QTimer*      statsTimer_     = nullptr;
+
+    // Message being built by SetMessage() (any thread)
+    mutable QMutex txMutex_;
+    QByteArray     tx_message_;        // fixed length = tx_len_
+    quint16        txSeq_ = 0;         // last stamped sequence number
+    quint32        dirtyMask_ = 0;     // fields changed since the last frame
+    quint8         dirtyMotors_ = 0;   // V2: motors whose bytes changed since the last frame
+    quint32        v2Heartbeats_ = 0;
+    std::array<qint64, kMaxFields> dirtyNs_{};
+    const bool     seqEnabled_;        // both payloads are long enough to carry seq / echo
+
+    QByteArray latest_rx_payload_; // fixed length = rx_len_ (owner thread)
+
+    // Queues + wakeup flags (wake only when the flag goes false -> true)
+    SpscQueue<TxFrame, kQueueDepth> txQueue_;
+    SpscQueue<RxFrame, kQueueDepth> rxQueue_;
+    SpscQueue<RxFrame, kQueueDepth> replayQueue_;   // injectReceived() -> owner thread
+    std::atomic<bool> txWakePending_{false};
+    std::atomic<bool> rxWakePending_{false};
+    std::atomic<bool> schedWakePending_{false};
+
+    // Scheduler
+    std::atomic<bool>   txRequested_{false};   // Send() called since the last frame
+    std::atomic<int>    frameIntervalUs_{0};
+    std::atomic<int>    heartbeatMs_{0};
+    std::atomic<int>    baudRate_{0};
+    std::atomic<qint64> openedNs_{0};
+    std::atomic<int>    protocol_{int(Protocol::V1)};
+    qint64              lastTxNs_ = 0;         // I/O thread
+
+    // I/O thread only
+    CobsFramer rx_framer_;         // ring buffer + in-place decode, no per-frame allocation
+    std::array<uint8_t, kMaxFrameBytes> rxImage_{};   // V2 telemetry as a fixed RX image
+    quint16 lastRxSeq_ = 0;
+
+    struct ProbeState {
+        bool    active     = false;
+        int     payloadLen = 0;
+        quint16 nextNonce  = 0;
+        int     outstanding = 0;
+        std::array<qint64, 256>  sentNs{};    // by nonce & 0xFF, 0 = free
+        std::array<quint16, 256> nonce{};
+        quint64 sent = 0, echoed = 0, lost = 0, corrupted = 0;
+        quint64 rttSumUs = 0;
+    } probe_;
+
+    struct BaudAck {
+        bool    received = false;
+        quint32 baud     = 0;
+        quint8  status   = 0;
+    } baudAck_;
+
+    bool infoReceived_ = false;
+
+    mutable QMutex infoMutex_;
+    DeviceInfo     info_;              // last Info answer
+    QString        portName_;
+
+    std::atomic<bool> aborting_{false};   // destructor: cut blocking I/O-thread work short
 
-    QByteArray tx_message_;        // fixed length = tx_len_
-    QByteArray latest_rx_payload_; // fixed length = rx_len_
+    struct InFlight { qint64 endOffset; qint64 enqueuedNs; };
+    std::array<InFlight, kQueueDepth> inFlight_{};
+    size_t  inFlightHead_ = 0, inFlightTail_ = 0;
+    qint64  writtenOffset_ = 0;    // bytes handed to write()
+    qint64  flushedOffset_ = 0;    // bytes confirmed by bytesWritten
 
-    QByteArray rx_accumulator_;    // collects bytes until 0x00 (frame delimiter)
+    // Stats
+    std::atomic<quint64> txFrames_{0}, txDropped_{0}, rxFrames_{0}, rxDropped_{0};
+    std::atomic<quint64> txBytes_{0}, txScheduled_{0}, txUrgent_{0}, txHeartbeats_{0}, updates_{0};
+    std::atomic<quint64> rxBytes_{0}, rxV1Frames_{0}, rxV2Frames_{0}, rxCrcErrors_{0}, rxBadFrames_{0}, rxLost_{0};
+    std::atomic<quint64> fwRxFrames_{0}, fwRxErrors_{0};
+    std::array<LatencyAcc, kMaxFields> fieldLatency_;
+    LatencyAcc txLatency_;
+    LatencyAcc rxLatency_;
+    RoundTripTracker roundTrip_;       // fed on the I/O thread
 
-    // Logging
-    bool        isRecording_{false};
-    QFile       logFile_;
-    QTextStream logStream_;
-    QTimer      flushTimer_;
-    QDate       currentDate_;
-    QString     currentStamp_;
+    // Recording (I/O thread): binary log, written by its own thread
+    bool            isRecording_{false};
+    SerialLogWriter logWriter_;
 };
 
 #endif // SERIALINTERFACE_H
@@ -1,5 +1,13 @@
 #include "AutoBending.h"
 
+#include <cmath>
+
+namespace {
+constexpr int64_t kModelStepNs  = 1000000;      // サーボモデルの積分刻み 1 ms
+constexpr int64_t kModelResetNs = 2000000000;   // これ以上空いたらモデルを指令値に合わせ直す
+constexpr size_t  kHistorySize  = 2048;         // 約 2 s 分
+}
+
 void AutoBending::reset()
 {
     integX_ = integY_ = 0.0;
@@ -7,6 +15,13 @@ void AutoBending::reset()
     dStateX_ = dStateY_ = 0.0;
     started_ = false;
     t_.invalidate();
+    lastStepNs_ = 0;
+
+    modelStarted_ = false;
+    pending_.clear();
+    history_.clear();
+    historyHead_ = 0;
+    lastCapturedNs_ = 0;
 }
 
 double AutoBending::pidAxis_(double err_px, double dt, double pxPerUnit,
@@ -58,7 +73,45 @@ bool AutoBending::step(double differenceX_px, double differenceY_px,
     } else {
         dt = std::max(1e-3, t_.restart() / 1000.0);
     }
+    return stepWithDt_(dt, differenceX_px, differenceY_px, outDeltaX, outDeltaY);
+}
 
+bool AutoBending::stepAt(int64_t nowNs, double differenceX_px, double differenceY_px,
+                         double& outDeltaX, double& outDeltaY)
+{
+    if (!enabled_) { outDeltaX = outDeltaY = 0.0; return false; }
+
+    double dt = 0.02;
+    if (started_) dt = std::max(1e-3, double(nowNs - lastStepNs_) / 1e9);
+    started_ = true;
+    lastStepNs_ = nowNs;
+    return stepWithDt_(dt, differenceX_px, differenceY_px, outDeltaX, outDeltaY);
+}
+
+bool AutoBending::stepDelayed(int64_t capturedNs, int64_t nowNs,
+                              double differenceX_px, double differenceY_px,
+                              double& outDeltaX, double& outDeltaY)
+{
+    // 撮影→処理の遅延を計測（新しいフレームのときだけ）
+    if (capturedNs != lastCapturedNs_) {
+        const double d = std::max(0.0, double(nowNs - capturedNs) / 1e9);
+        delayEmaSec_ = (delayEmaSec_ <= 0.0) ? d : delayEmaSec_ + 0.1 * (d - delayEmaSec_);
+        lastCapturedNs_ = capturedNs;
+    }
+
+    double errX = differenceX_px, errY = differenceY_px;
+    if (compensate_ && modelStarted_) {
+        advanceModel_(nowNs);
+        double sX, sY;
+        toStabilized(capturedNs, differenceX_px, differenceY_px, sX, sY);
+        fromStabilized(sX, sY, errX, errY);
+    }
+    return stepAt(nowNs, errX, errY, outDeltaX, outDeltaY);
+}
+
+bool AutoBending::stepWithDt_(double dt, double differenceX_px, double differenceY_px,
+                              double& outDeltaX, double& outDeltaY)
+{
     const double uX = pidAxis_(differenceX_px, dt, pxPerUnitX_,
                                integX_, prevErrUnitX_, dStateX_);
     const double uY = pidAxis_(differenceY_px, dt, pxPerUnitY_,
@@ -68,3 +121,125 @@ bool AutoBending::step(double differenceX_px, double differenceY_px,
     outDeltaY = uY;
     return true;
 }
+
+// ======================= 遅延補償（サーボモデル） =======================
+
+void AutoBending::setLatencyCompensation(bool on, const ServoModel& model)
+{
+    compensate_ = on;
+    model_ = model;
+}
+
+void AutoBending::noteCommand(int64_t atNs, double targetX, double targetY)
+{
+    if (!modelStarted_) {
+        // 最初の指令はすでに到達しているものとする
+        modelStarted_ = true;
+        modelNs_ = atNs;
+        cmdX_ = targetX_ = slewX_ = angX_ = targetX;
+        cmdY_ = targetY_ = slewY_ = angY_ = targetY;
+        pending_.clear();
+        history_.assign(1, {atNs, angX_, angY_});
+        historyHead_ = 0;
+        return;
+    }
+
+    advanceModel_(atNs);
+    cmdX_ = targetX;
+    cmdY_ = targetY;
+    pending_.push_back({atNs + int64_t(model_.commandDelaySec * 1e9), targetX, targetY});
+}
+
+void AutoBending::toStabilized(int64_t capturedNs, double differenceX_px, double differenceY_px,
+                               double& stabilizedX, double& stabilizedY)
+{
+    if (!modelStarted_) { stabilizedX = differenceX_px; stabilizedY = differenceY_px; return; }
+
+    double ax, ay;
+    angleAt_(capturedNs, ax, ay);
+    stabilizedX = differenceX_px + pxPerUnitX_ * ax;
+    stabilizedY = differenceY_px + pxPerUnitY_ * ay;
+}
+
+void AutoBending::fromStabilized(double stabilizedX, double stabilizedY,
+                                 double& differenceX_px, double& differenceY_px) const
+{
+    if (!modelStarted_) { differenceX_px = stabilizedX; differenceY_px = stabilizedY; return; }
+
+    differenceX_px = stabilizedX - pxPerUnitX_ * cmdX_;
+    differenceY_px = stabilizedY - pxPerUnitY_ * cmdY_;
+}
+
+void AutoBending::advanceModel_(int64_t toNs)
+{
+    if (!modelStarted_ || toNs <= modelNs_) return;
+
+    // 長く止まっていたら指令に到達済みとする
+    if (toNs - modelNs_ > kModelResetNs) {
+        targetX_ = slewX_ = angX_ = cmdX_;
+        targetY_ = slewY_ = angY_ = cmdY_;
+        pending_.clear();
+        modelNs_ = toNs;
+        history_.assign(1, {toNs, angX_, angY_});
+        historyHead_ = 0;
+        return;
+    }
+
+    const double lagTau = model_.timeConstantSec;
+    while (modelNs_ < toNs) {
+        const int64_t h = std::min(kModelStepNs, toNs - modelNs_);
+        modelNs_ += h;
+
+        size_t arrived = 0;
+        while (arrived < pending_.size() && pending_[arrived].effectiveNs <= modelNs_) {
+            targetX_ = pending_[arrived].x;
+            targetY_ = pending_[arrived].y;
+            ++arrived;
+        }
+        if (arrived) pending_.erase(pending_.begin(), pending_.begin() + std::ptrdiff_t(arrived));
+
+        // ファームウェアのスルーレート制限 → サーボの一次遅れ
+        const double dt = double(h) / 1e9;
+        const double maxStep = model_.slewDegPerSec > 0.0 ? model_.slewDegPerSec * dt : 1e9;
+        slewX_ += std::clamp(targetX_ - slewX_, -maxStep, maxStep);
+        slewY_ += std::clamp(targetY_ - slewY_, -maxStep, maxStep);
+        const double a = lagTau > 0.0 ? 1.0 - std::exp(-dt / lagTau) : 1.0;
+        angX_ += a * (slewX_ - angX_);
+        angY_ += a * (slewY_ - angY_);
+
+        const ModelSample sample{modelNs_, angX_, angY_};
+        if (history_.size() < kHistorySize) {
+            history_.push_back(sample);
+            historyHead_ = history_.size() - 1;
+        } else {
+            historyHead_ = (historyHead_ + 1) % kHistorySize;
+            history_[historyHead_] = sample;
+        }
+    }
+}
+
+void AutoBending::angleAt_(int64_t atNs, double& x, double& y) const
+{
+    x = angX_;
+    y = angY_;
+    if (history_.empty() || atNs >= history_[historyHead_].t) return;
+
+    // 新しい方から遡って atNs を挟む 2 点を探し、線形補間
+    const size_t n = history_.size();
+    size_t newer = historyHead_;
+    for (size_t k = 1; k < n; ++k) {
+        const size_t older = (historyHead_ + n - k) % n;
+        const ModelSample& o = history_[older];
+        if (o.t <= atNs) {
+            const ModelSample& nw = history_[newer];
+            const double w = nw.t > o.t ? double(atNs - o.t) / double(nw.t - o.t) : 0.0;
+            x = o.x + w * (nw.x - o.x);
+            y = o.y + w * (nw.y - o.y);
+            return;
+        }
+        newer = older;
+    }
+    // 履歴より古い：最古の値
+    x = history_[newer].x;
+    y = history_[newer].y;
+}
@@ -4,6 +4,8 @@
 #include <QDebug>
 #include <QElapsedTimer>
 #include <algorithm>
+#include <cstdint>
+#include <vector>
 
 #define _USE_MATH_DEFINES
 #include <math.h>
@@ -18,6 +20,42 @@ public:
     bool step(double differenceX_px, double differenceY_px,
               double& outDeltaX, double& outDeltaY);
 
+    // —— タイムスタンプ版（時刻はすべて steady_clock [ns]）——
+    // stepAt: dt を nowNs から求める（シミュレーションでも実時間に依存しない）
+    bool stepAt(int64_t nowNs, double differenceX_px, double differenceY_px,
+                double& outDeltaX, double& outDeltaY);
+    // stepDelayed: capturedNs に撮影されたフレームの誤差を、遅延補償してから stepAt
+    bool stepDelayed(int64_t capturedNs, int64_t nowNs,
+                     double differenceX_px, double differenceY_px,
+                     double& outDeltaX, double& outDeltaY);
+
+    // —— 遅延補償（Smith predictor）——
+    // 送信済みの目標角度からサーボの実角度をモデルで推定し、
+    //   補償後誤差 = 計測誤差 - pxPerUnit * (最新の指令角度 - 撮影時刻の推定実角度)
+    // とする。つまり「撮影後に動いた分」と「送信済みでまだ動いていない分」を差し引いた、
+    // 全指令が実行された後に残る誤差。正の出力で誤差が減る向き（既存の符号）を前提とする。
+    struct ServoModel {
+        double slewDegPerSec   = 300.0;   // ServoArrayController::SetSlewRateDegPerSec
+        double timeConstantSec = 0.04;    // サーボ機構の一次遅れ
+        double commandDelaySec = 0.02;    // 送信（フレーム周期）+ シリアル
+    };
+    void setLatencyCompensation(bool on) { compensate_ = on; }
+    void setLatencyCompensation(bool on, const ServoModel& model);
+    bool latencyCompensation() const { return compensate_; }
+
+    // 送信した目標角度 [deg]（X = 水平, Y = 垂直）。目標が変わるたびに呼ぶ
+    void noteCommand(int64_t atNs, double targetX, double targetY);
+
+    // 台座に固定した座標系での目標位置 [px]（撮影時刻の推定角度を足し戻したもの）と、その逆変換。
+    // トラッカーは自分の動きを含まないこちらで追う。
+    void toStabilized(int64_t capturedNs, double differenceX_px, double differenceY_px,
+                      double& stabilizedX, double& stabilizedY);
+    void fromStabilized(double stabilizedX, double stabilizedY,
+                        double& differenceX_px, double& differenceY_px) const;
+
+    // 撮影→step の遅延（EMA）[s]
+    double pipelineDelaySec() const { return delayEmaSec_; }
+
     // 有効/無効
     void setEnabled(bool on) { enabled_ = on; if (!on) reset(); }
     bool isEnabled() const { return enabled_; }
@@ -47,6 +85,13 @@ private:
     double pidAxis_(double err_px, double dt, double pxPerUnit,
                     double& integ, double& prevErrUnit, double& dState);
 
+    bool stepWithDt_(double dt, double differenceX_px, double differenceY_px,
+                     double& outDeltaX, double& outDeltaY);
+
+    // サーボモデル
+    void advanceModel_(int64_t toNs);
+    void angleAt_(int64_t atNs, double& x, double& y) const;
+
 private:
     bool enabled_ = true;
 
@@ -79,6 +124,24 @@ private:
 
     QElapsedTimer t_;
     bool started_ = false;
+    int64_t lastStepNs_ = 0;
+
+    // 遅延補償
+    struct Command { int64_t effectiveNs; double x, y; };
+    struct ModelSample { int64_t t; double x, y; };
+    bool       compensate_ = false;
+    ServoModel model_;
+    bool       modelStarted_ = false;
+    int64_t    modelNs_ = 0;
+    double     cmdX_ = 0.0, cmdY_ = 0.0;     // 最新の指令（送信済み）
+    double     targetX_ = 0.0, targetY_ = 0.0; // サーボに届いている指令
+    double     slewX_ = 0.0, slewY_ = 0.0;   // スルーレート制限後（ファームウェアの出力）
+    double     angX_ = 0.0, angY_ = 0.0;     // 推定実角度
+    std::vector<Command>     pending_;       // 送信済み・未到達の指令
+    std::vector<ModelSample> history_;       // 推定実角度の履歴（リング）
+    size_t     historyHead_ = 0;
+    int64_t    lastCapturedNs_ = 0;
+    double     delayEmaSec_ = 0.0;
 };
 
 #endif // AUTOBENDING_H
@@ -1,5 +1,9 @@
 #include "bbox_renderer.h"
 #include <algorithm>
+#include <cmath>
+
+#include <QBrush>
+#include <QPen>
 
 BBoxRenderer::BBoxRenderer(QGraphicsView* canvas,
                            QCheckBox* isDisplayingCheckBox,
@@ -8,37 +12,79 @@ BBoxRenderer::BBoxRenderer(QGraphicsView* canvas,
     canvas_(canvas),
     isDisplayingCheckBox_(isDisplayingCheckBox)
 {
+    font_ = QFont("Arial Black", fontPoint_, QFont::Bold);
+
     canvas_->setStyleSheet("background: transparent;");
     canvas_->setAttribute(Qt::WA_TranslucentBackground, true);
     canvas_->setHorizontalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
     canvas_->setVerticalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
+    canvas_->setRenderHint(QPainter::Antialiasing, true);
+    canvas_->setViewportUpdateMode(QGraphicsView::MinimalViewportUpdate);
 
     scene_ = canvas_->scene();
     if (!scene_) {
         scene_ = new QGraphicsScene(canvas_);
         canvas_->setScene(scene_);
     }
+}
+
+void BBoxRenderer::setFontPoint(int pt)
+{
+    if (pt == fontPoint_) return;
+    fontPoint_ = pt;
+    font_.setPointSize(pt);
+    for (Slot& s : slots_) s.text->setFont(font_);
+    if (glView_) glView_->setFontPoint(pt);
+}
 
-    overlayItem_ = new QGraphicsPixmapItem();
-    overlayItem_->setZValue(1.0);
-    scene_->addItem(overlayItem_);
+void BBoxRenderer::setGLView(GLVideoView* view)
+{
+    hideFrom_(0);
+    glView_ = view;
+    if (glView_) glView_->setFontPoint(fontPoint_);
+}
 
-    ensureOverlayAligned_();
+BBoxRenderer::Slot& BBoxRenderer::slotAt_(int i)
+{
+    while (slots_.size() <= i) {
+        Slot s;
+        s.box = scene_->addRect(QRectF());
+        s.box->setBrush(Qt::NoBrush);
+        s.box->setZValue(1.0);
+
+        s.label = scene_->addRect(QRectF());
+        s.label->setPen(Qt::NoPen);
+        s.label->setZValue(1.1);
+
+        s.text = scene_->addSimpleText(QString(), font_);
+        s.text->setBrush(Qt::white);
+        s.text->setZValue(1.2);
+        // Glyphs are rasterised once and reused until the text changes
+        s.text->setCacheMode(QGraphicsItem::DeviceCoordinateCache);
+
+        s.box->hide();
+        s.label->hide();
+        s.text->hide();
+        slots_.push_back(s);
+    }
+    return slots_[i];
 }
 
-void BBoxRenderer::ensureOverlayAligned_()
+void BBoxRenderer::hideFrom_(int first)
 {
-    const int W = canvas_->viewport()->width();
-    const int H = canvas_->viewport()->height();
-    overlayItem_->setOffset(-W/2.0, -H/2.0);
-    overlayItem_->setPos(0, 0);
+    for (int i = first; i < slots_.size(); ++i) {
+        Slot& s = slots_[i];
+        if (!s.visible) continue;
+        s.box->hide();
+        s.label->hide();
+        s.text->hide();
+        s.visible = false;
+    }
 }
 
 void BBoxRenderer::UpdateBoundingBoxes(const QVector<Detector::DetectedObject>& detectedObjects,
                                        const QSize& cameraResolution, int maximumBoxes)
 {
-    if (!overlayItem_) return;
-
     if (detectedObjects.isEmpty())
     {
         DeleteAllBoxes();
@@ -51,83 +97,94 @@ void BBoxRenderer::UpdateBoundingBoxes(const QVector<Detector::DetectedObject>&
         return;
     }
 
-    const int W = canvas_->viewport()->width();
-    const int H = canvas_->viewport()->height();
-    QImage bboxImage(W, H, QImage::Format_ARGB32_Premultiplied);
-    bboxImage.fill(Qt::transparent);
+    if (!cameraResolution.isValid() || cameraResolution.width() <= 0 || cameraResolution.height() <= 0)
+    {
+        DeleteAllBoxes();
+        return;
+    }
+
+    const int W = glView_ ? glView_->width()  : canvas_->viewport()->width();
+    const int H = glView_ ? glView_->height() : canvas_->viewport()->height();
+
+    const float reductionRatio = float(W) / float(cameraResolution.width());
+    const float heightOffset   = (H - cameraResolution.height() * reductionRatio) / 2.0f;
 
-    if (cameraResolution.isValid() && cameraResolution.width() > 0 && cameraResolution.height() > 0)
+    // Scene origin is the viewport centre; the GL view uses canvas pixels
+    const float originX = glView_ ? 0.0f : -W / 2.0f;
+    const float originY = glView_ ? 0.0f : -H / 2.0f;
+
+    QVector<GLVideoView::Box> glBoxes;
+    int used = 0;
+    for (const auto& object : detectedObjects)
     {
-        const float reductionRatio = float(W) / float(cameraResolution.width());
-        const float heightOffset   = (H - cameraResolution.height() * reductionRatio) / 2.0f;
-
-        QPainter painter(&bboxImage);
-        painter.setRenderHint(QPainter::Antialiasing, true);
-        painter.setFont(QFont("Arial Black", fontPoint_, QFont::Bold));
-
-        int counter = 1;
-        for (const auto& object : detectedObjects)
-        {
-            if(counter++ > maximumBoxes) break;
-
-            // 座標変換（元画像 → 画面）
-            const float x1 = object.x1 * reductionRatio;
-            const float y1 = object.y1 * reductionRatio + heightOffset;
-            const float x2 = object.x2 * reductionRatio;
-            const float y2 = object.y2 * reductionRatio + heightOffset;
-
-            // 色・太さ
-            QColor lineColor;
-            if (object.classifySize == 1) {
-                lineColor.setHsv(180, 250, 250); // 水色
-                thicknessAdjustment_ = 3;
-            } else if (object.classifySize == 2) {
-                lineColor.setHsv(object.index == 0 ? 180 : 0, 250, 250); // 水/赤
-                thicknessAdjustment_ = 3;
-            } else {
-                int hue = (object.classifySize > 0)
-                ? (object.index * 360 / object.classifySize) : 180;
-                lineColor.setHsv(hue, 250, 250);
-                thicknessAdjustment_ = 1;
-            }
-
-            const int thickness = std::max(1, int((object.score + 0.1f) * baseThickness_ * thicknessAdjustment_));
-
-            // 描画
-            const QRect rect(int(x1), int(y1), int(x2 - x1), int(y2 - y1));
-            const QRect textRect(int(x1), int(y1), 250, fontPoint_ + 10);
-
-            painter.setPen(QPen(lineColor, thickness));
-            painter.setBrush(Qt::NoBrush);
-            painter.drawRect(rect);
-
-            painter.setBrush(QBrush(lineColor));
-            painter.setPen(Qt::NoPen);
-            painter.drawRect(textRect);
-
-            painter.setPen(QPen(Qt::white));
-            const QString scoreStr = QString::number(object.score, 'f', 2);
-            painter.drawText(textRect.left() + 4,
-                             textRect.top() + fontPoint_ + 2,
-                             QString::fromStdString(object.name) + " : " + scoreStr);
+        if (used >= maximumBoxes) break;
+
+        // 座標変換（元画像 → 画面）
+        const float x1 = object.x1 * reductionRatio + originX;
+        const float y1 = object.y1 * reductionRatio + heightOffset + originY;
+        const float x2 = object.x2 * reductionRatio + originX;
+        const float y2 = object.y2 * reductionRatio + heightOffset + originY;
+
+        // 色・太さ
+        QColor lineColor;
+        if (object.classifySize == 1) {
+            lineColor.setHsv(180, 250, 250); // 水色
+            thicknessAdjustment_ = 3;
+        } else if (object.classifySize == 2) {
+            lineColor.setHsv(object.index == 0 ? 180 : 0, 250, 250); // 水/赤
+            thicknessAdjustment_ = 3;
+        } else {
+            int hue = (object.classifySize > 0)
+            ? (object.index * 360 / object.classifySize) : 180;
+            lineColor.setHsv(hue, 250, 250);
+            thicknessAdjustment_ = 1;
+        }
+
+        // Score in 0.1 steps: caption and pen only change (and the cached text is only
+        // re-rasterised) when the score moves by a visible amount, not on every detection
+        const float shownScore = std::round(object.score * 10.0f) / 10.0f;
+        const int thickness = std::max(1, int((shownScore + 0.1f) * baseThickness_ * thicknessAdjustment_));
+
+        const QRectF rect(int(x1), int(y1), int(x2 - x1), int(y2 - y1));
+        const QRectF textRect(int(x1), int(y1), 250, fontPoint_ + 10);
+        const QString caption = QString::fromStdString(object.name) + " : " + QString::number(shownScore, 'f', 1);
+
+        if (glView_) {
+            glBoxes.push_back({rect, textRect, lineColor, float(thickness), caption});
+            ++used;
+            continue;
         }
-    }
 
-    overlayItem_->setPixmap(QPixmap::fromImage(bboxImage));
+        // 既存アイテムを移動・更新するだけ（再生成しない）
+        Slot& s = slotAt_(used++);
 
-    overlayItem_->setOffset(-bboxImage.width()/2.0, -bboxImage.height()/2.0);
-    overlayItem_->setPos(0, 0);
+        const QPen pen(lineColor, thickness);
+        if (s.box->pen() != pen) s.box->setPen(pen);
+        if (s.box->rect() != rect) s.box->setRect(rect);
+
+        if (s.label->brush().color() != lineColor) s.label->setBrush(lineColor);
+        if (s.label->rect() != textRect) s.label->setRect(textRect);
+
+        if (s.text->text() != caption) s.text->setText(caption);
+        s.text->setPos(textRect.left() + 4, textRect.top() + 2);
+
+        if (!s.visible) {
+            s.box->show();
+            s.label->show();
+            s.text->show();
+            s.visible = true;
+        }
+    }
+
+    if (glView_) {
+        glView_->setBoxes(glBoxes);
+        return;
+    }
+    hideFrom_(used);
 }
 
 void BBoxRenderer::DeleteAllBoxes()
 {
-    if (!overlayItem_) return;
-    const int W = canvas_->viewport()->width();
-    const int H = canvas_->viewport()->height();
-    QImage clearImg(W, H, QImage::Format_ARGB32_Premultiplied);
-    clearImg.fill(Qt::transparent);
-
-    overlayItem_->setPixmap(QPixmap::fromImage(clearImg));
-    overlayItem_->setOffset(-W/2.0, -H/2.0);
-    overlayItem_->setPos(0, 0);
+    if (glView_) glView_->setBoxes({});
+    hideFrom_(0);
 }
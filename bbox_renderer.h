@@ -2,15 +2,28 @@
 #include <QObject>
 #include <QGraphicsView>
 #include <QGraphicsScene>
-#include <QGraphicsPixmapItem>
+#include <QGraphicsRectItem>
+#include <QGraphicsSimpleTextItem>
 #include <QCheckBox>
 #include <QVector>
-#include <QImage>
-#include <QPixmap>
-#include <QPainter>
+#include <QFont>
 
 #include "darknessdetector.h" // DetectedObject
+#include "glvideoview.h"
 
+/**
+ * Retained-mode bounding-box overlay.
+ *
+ * A small pool of scene items (box outline, label background, label text) is
+ * created once and only moved / recoloured per update; unused entries are
+ * hidden. No full-canvas pixmap is rasterised or uploaded. The caption and the
+ * pen width use the score in 0.1 steps, so the cached label text is only
+ * re-rasterised when that step changes; a typical update just moves the items
+ * and the view repaints the dirty regions.
+ *
+ * With setGLView() the same boxes are handed to a GLVideoView instead and
+ * drawn as GPU primitives in the video pass; the scene items stay hidden.
+ */
 class BBoxRenderer : public QObject
 {
     Q_OBJECT
@@ -25,16 +38,28 @@ public:
     void DeleteAllBoxes();
 
     void setThicknessBase(int v) { baseThickness_ = v; }
-    void setFontPoint(int pt)    { fontPoint_ = pt;   }
+    void setFontPoint(int pt);
+    void setGLView(GLVideoView* view);
 
 private:
-    void ensureOverlayAligned_();
+    struct Slot {
+        QGraphicsRectItem*       box   = nullptr;
+        QGraphicsRectItem*       label = nullptr;
+        QGraphicsSimpleTextItem* text  = nullptr;
+        bool visible = false;
+    };
+
+    Slot& slotAt_(int i);
+    void  hideFrom_(int first);
 
 private:
     QGraphicsView*        canvas_ = nullptr;
     QGraphicsScene*       scene_  = nullptr;
-    QGraphicsPixmapItem*  overlayItem_ = nullptr;
     QCheckBox*            isDisplayingCheckBox_ = nullptr;
+    GLVideoView*          glView_ = nullptr;
+
+    QVector<Slot> slots_;
+    QFont         font_;
 
     int baseThickness_ = 5;
     int thicknessAdjustment_ = 1;
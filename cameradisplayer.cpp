@@ -1,4 +1,5 @@
 #include "CameraDisplayer.h"
+#include "glvideoview.h"
 
 #include <QCamera>
 #include <QCheckBox>
@@ -63,12 +64,18 @@ CameraDisplayer::CameraDisplayer(QGraphicsView *graphicsView,
     videoPixmapItem_->setZValue(0);
     scene_->addItem(videoPixmapItem_);
 
+    // --- Frame conversion thread ---
+    convertThread_.setObjectName("CameraConvert");
+    converter_.moveToThread(&convertThread_);
+    convertThread_.start();
+
     // --- Populate devices ---
     ListCameraDevices();
 
     // --- Connections ---
+    // Direct: the sink's thread only drops the frame into the mailbox
     connect(videoSink_, &QVideoSink::videoFrameChanged,
-            this, &CameraDisplayer::ProcessVideoFrame);
+            this, &CameraDisplayer::ProcessVideoFrame, Qt::DirectConnection);
 
     connect(deviceComboBox_, &QComboBox::currentIndexChanged,
             this, [this](int index){ DisplayVideo(index); });
@@ -77,7 +84,7 @@ CameraDisplayer::CameraDisplayer(QGraphicsView *graphicsView,
             this, [this](){ SaveImage(); });
 
     connect(flipCheckBox_, &QCheckBox::clicked,
-            this, [this](){ isReversing_ = flipCheckBox_->isChecked(); });
+            this, [this](){ isReversing_.store(flipCheckBox_->isChecked(), std::memory_order_relaxed); });
 
     // --- Initial selection: prefer PRIMARY, fallback to first real device ---
     int idx = 0;
@@ -91,7 +98,7 @@ CameraDisplayer::CameraDisplayer(QGraphicsView *graphicsView,
 
     if(flipCheckBox_->isChecked())
     {
-        isReversing_ = flipCheckBox_->isChecked();
+        isReversing_.store(flipCheckBox_->isChecked(), std::memory_order_relaxed);
     }
 }
 
@@ -102,17 +109,9 @@ CameraDisplayer::~CameraDisplayer()
         camera_->deleteLater();
         camera_ = nullptr;
     }
-}
-
-void CameraDisplayer::onVideoFrame(const QVideoFrame& frame)
-{
-    if (!frame.isValid()) return;
-    QImage img = frame.toImage();
-    if (img.isNull()) return;
 
-    if (isReversing_) img = img.mirrored(true, false);
-
-    emit frameReady(img);
+    convertThread_.quit();
+    convertThread_.wait();
 }
 
 void CameraDisplayer::DisplayVideo(const int cameraIndex)
@@ -165,33 +164,73 @@ void CameraDisplayer::ListCameraDevices()
 
 void CameraDisplayer::ProcessVideoFrame(const QVideoFrame& frame)
 {
-    QVideoFrame f(frame);
+    if (!frame.isValid()) return;
+
+    // Latest frame wins; wake the converter only when the slot was empty
+    if (pendingFrames_.publish(frame)) {
+        QMetaObject::invokeMethod(&converter_, [this]{ convertFrame_(); }, Qt::QueuedConnection);
+    }
+}
 
-    emit onVideoFrame(f);
+void CameraDisplayer::convertFrame_()
+{
+    const std::unique_ptr<QVideoFrame> pending = pendingFrames_.take();
+    if (!pending) return;
 
-    if (!f.isValid()) return;
+    QVideoFrame f(*pending);
 
+    // One deep copy per frame: mirroring and format fixes below work in place on it
     QImage img;
     if (f.map(QVideoFrame::ReadOnly)) {
         const QImage::Format fmt = QVideoFrameFormat::imageFormatFromPixelFormat(f.pixelFormat());
         if (fmt != QImage::Format_Invalid) {
-            img = QImage(f.bits(0), f.width(), f.height(), f.bytesPerLine(0), fmt).copy(); // ★安全のため最小コピー
+            img = QImage(f.bits(0), f.width(), f.height(), f.bytesPerLine(0), fmt).copy();
         }
         f.unmap();
     }
 
     if (img.isNull())
-        img = frame.toImage();
+        img = f.toImage();   // YUV and other planar formats
 
     if (img.isNull()) return;
 
-    if (isReversing_) img = img.mirrored(true, false);
+    // The GL canvas takes tightly packed 32-bit frames as they are
+    if (!GLVideoView::uploadsAsIs(img))
+        img = std::move(img).convertToFormat(QImage::Format_RGB32);
+
+    if (isReversing_.load(std::memory_order_relaxed))
+        img = std::move(img).mirrored(true, false);
 
     const int angleDegrees = 0;
     if (angleDegrees % 360 != 0) {
         img = rotateImageWithWhiteBackground(img, angleDegrees);
     }
 
+    emit frameReady(img);
+
+    {
+        QMutexLocker lock(&glViewMutex_);
+        if (glView_) glView_->setFrame(img);   // copied into a mapped PBO on this thread
+    }
+
+    if (pendingDisplay_.publish(img)) {
+        QMetaObject::invokeMethod(this, [this]{ showFrame_(); }, Qt::QueuedConnection);
+    }
+}
+
+void CameraDisplayer::showFrame_()
+{
+    const std::unique_ptr<QImage> pending = pendingDisplay_.take();
+    if (!pending) return;
+    const QImage& img = *pending;
+
+    if (glView_) {
+        // GPU path: convertFrame_() already handed the frame to the view, which scales it itself
+        latestImage_ = img;
+        scaleX_ = scaleY_ = std::min(float(CANVAS_SIZE) / img.width(), float(CANVAS_SIZE) / img.height());
+        return;
+    }
+
     QPixmap pix = QPixmap::fromImage(img);
 
     const qreal canvasW = CANVAS_SIZE, canvasH = CANVAS_SIZE;
@@ -210,6 +249,16 @@ void CameraDisplayer::ProcessVideoFrame(const QVideoFrame& frame)
     scaleY_ = float(scale);
 }
 
+void CameraDisplayer::setGLView(GLVideoView* view)
+{
+    {
+        QMutexLocker lock(&glViewMutex_);
+        glView_ = view;
+    }
+    videoPixmapItem_->setVisible(glView_ == nullptr);
+    if (glView_) videoPixmapItem_->setPixmap(QPixmap());
+}
+
 void CameraDisplayer::SaveImage()
 {
     const QString ts = QDateTime::currentDateTime().toString("yyyy-MM-dd_HH-mm-ss");
@@ -4,9 +4,16 @@
 #include <QDir>
 #include <QFileInfo>
 #include <QImage>
+#include <QMutex>
 #include <QObject>
 #include <QSize>
+#include <QThread>
 #include <QVector>
+#include <QVideoFrame>
+
+#include <atomic>
+
+#include "latestslot.h"
 
 // Forward declarations
 class QCamera;
@@ -19,9 +26,22 @@ class QLabel;
 class QMediaCaptureSession;
 class QMediaPlayer;
 class QPushButton;
-class QVideoFrame;
 class QVideoSink;
 
+class GLVideoView;
+
+/**
+ * Camera input + video canvas.
+ *
+ * Frame path:
+ *   - The sink's frames go into a single-slot mailbox (latest frame wins).
+ *   - A converter thread maps each frame once, copies it into a 32-bit QImage, mirrors it in
+ *     place when flipping is on and emits frameReady() from that thread.
+ *   - With a GL canvas the converter thread also copies the image into the canvas' mapped
+ *     pixel buffer (GLVideoView::setFrame), so the GUI thread touches no pixels at any
+ *     resolution. The scene canvas gets the image on the GUI thread through a second
+ *     single-slot mailbox (QPixmap has to be made there).
+ */
 class CameraDisplayer : public QObject
 {
     Q_OBJECT
@@ -45,18 +65,25 @@ public:
     QSize OriginalResolution(){return QSize(resolution_.front());}
     int CanvasSize() noexcept {return CANVAS_SIZE;}
 
+    // Route frames to a GL canvas instead of the scene pixmap (nullptr = scene).
+    // Once this returns the converter thread no longer uses the previous view.
+    void setGLView(GLVideoView* view);
+
 signals:
+    // Emitted on the converter thread (connect with a DirectConnection or a receiver context).
     void frameReady(const QImage& img);
 
 private slots:
-    // Called by QVideoSink for each new frame
+    // Called by QVideoSink for each new frame (on the thread that delivers it)
     void ProcessVideoFrame(const QVideoFrame& frame);
-    void onVideoFrame(const QVideoFrame& frame);
 
     // Save the latest frame as jpg
     void SaveImage();
 
 private:
+    void convertFrame_();   // converter thread
+    void showFrame_();      // GUI thread
+
     // Utility: rotate with white background (no transparency)
     QImage rotateImageWithWhiteBackground(const QImage& src, int angleDegrees);
 
@@ -74,6 +101,8 @@ private:
     // Scene graph (owned by Qt via parents)
     QGraphicsScene*      scene_          = nullptr;
     QGraphicsPixmapItem* videoPixmapItem_= nullptr;
+    GLVideoView*         glView_         = nullptr;   // guarded by glViewMutex_ off the GUI thread
+    QMutex               glViewMutex_;
 
     // Media pipeline (owned by Qt via parents)
     QMediaCaptureSession* captureSession_ = nullptr;
@@ -81,11 +110,17 @@ private:
     QMediaPlayer*         videoPlayer_    = nullptr;
     QCamera*              camera_         = nullptr;
 
+    // Frame conversion
+    QThread                 convertThread_;
+    QObject                 converter_;        // lives on convertThread_
+    LatestSlot<QVideoFrame> pendingFrames_;    // newest sink frame, not yet converted
+    LatestSlot<QImage>      pendingDisplay_;   // newest converted frame, not yet shown
+
     // State
     QVector<QCameraDevice> cameras_;
     QVector<QSize>         resolution_;
     QVector<int>           aspectRatio_{1,1};
-    bool                   isReversing_{false};
+    std::atomic<bool>      isReversing_{false};
     QImage                 latestImage_;
     float                  scaleX_        = 1.0f;
     float                  scaleY_        = 1.0f;
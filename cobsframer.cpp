@@ -0,0 +1,178 @@
+#include "cobsframer.h"
+
+#include <algorithm>
+#include <cstring>
+
+// ======================== Public ========================
+
+CobsFramer::CobsFramer(size_t payloadLen, size_t capacity)
+    : CobsFramer(payloadLen, payloadLen, capacity)
+{
+}
+
+CobsFramer::CobsFramer(size_t minPayloadLen, size_t maxPayloadLen, size_t capacity)
+    : payload_(maxPayloadLen, 0),
+    minLen_(minPayloadLen),
+    maxLen_(maxPayloadLen),
+    len_(maxPayloadLen)
+{
+    // Round up to a power of two and leave room for at least two worst-case frames
+    size_t cap = 64;
+    const size_t need = std::max(capacity, 2 * (maxEncodedLength(maxPayloadLen) + 1));
+    while (cap < need) cap <<= 1;
+    ring_.assign(cap, 0);
+    mask_ = cap - 1;
+}
+
+uint8_t* CobsFramer::writePtr(size_t& contiguous)
+{
+    const size_t cap  = mask_ + 1;
+    const size_t pos  = tail_ & mask_;
+    const size_t free = cap - (tail_ - head_);
+    contiguous = std::min(free, cap - pos);
+    return ring_.data() + pos;
+}
+
+void CobsFramer::commit(size_t n)
+{
+    tail_ += n;
+    stats_.bytes += n;
+}
+
+size_t CobsFramer::write(const uint8_t* data, size_t n)
+{
+    size_t done = 0;
+    while (done < n) {
+        size_t room = 0;
+        uint8_t* dst = writePtr(room);
+        if (room == 0) break;
+        const size_t k = std::min(room, n - done);
+        std::memcpy(dst, data + done, k);
+        commit(k);
+        done += k;
+    }
+    return done;
+}
+
+CobsFramer::Result CobsFramer::next()
+{
+    const size_t cap = mask_ + 1;
+
+    while (scan_ < tail_) {
+        const size_t pos = scan_ & mask_;
+        const size_t len = std::min(tail_ - scan_, cap - pos);
+        const uint8_t* base = ring_.data() + pos;
+
+        const void* hit = std::memchr(base, 0, len);
+        if (!hit) {
+            scan_ += len;
+            continue;
+        }
+
+        const size_t delim = scan_ + size_t(static_cast<const uint8_t*>(hit) - base);
+        const size_t start = head_;
+        head_ = scan_ = delim + 1;   // consume frame + delimiter
+
+        const Result r = decode_(start, delim - start);
+        if (r == Result::Frame) ++stats_.frames;
+        else                    ++stats_.badFrames;
+        return r;
+    }
+
+    if (tail_ - head_ == cap) {
+        // A frame can never be longer than the ring; drop everything and resync on the next 0x00
+        clear();
+        ++stats_.overflows;
+        return Result::Overflow;
+    }
+    return Result::None;
+}
+
+void CobsFramer::clear()
+{
+    head_ = scan_ = tail_;
+}
+
+// Emit a code byte followed by up to 254 non-zero bytes, repeat; no zero in the output.
+size_t CobsFramer::encode(const uint8_t* in, size_t n, uint8_t* out)
+{
+    if (n == 0) return 0;
+
+    size_t codeIndex = 0;
+    size_t o = 1;        // out[0] is the first code placeholder
+    uint8_t code = 1;
+    for (size_t i = 0; i < n; ++i) {
+        if (in[i] == 0) {
+            out[codeIndex] = code;
+            codeIndex = o++;
+            code = 1;
+        } else {
+            out[o++] = in[i];
+            if (++code == 0xFF) {
+                out[codeIndex] = code;
+                codeIndex = o++;
+                code = 1;
+            }
+        }
+    }
+    out[codeIndex] = code;
+    return o;
+}
+
+// Shortest when a zero occurs at least every 254 bytes: one code byte per zero plus the leading one.
+size_t CobsFramer::minEncodedLength(size_t rawLen)
+{
+    if (rawLen == 0) return 0;
+    return rawLen + 1;
+}
+
+// Longest without zeros: every full 254-byte block costs an extra code byte.
+size_t CobsFramer::maxEncodedLength(size_t rawLen)
+{
+    if (rawLen == 0) return 0;
+    return rawLen + 1 + rawLen / 254;
+}
+
+// ======================== Private ========================
+
+void CobsFramer::copyOut_(size_t from, uint8_t* dst, size_t n) const
+{
+    const size_t pos   = from & mask_;
+    const size_t first = std::min(n, mask_ + 1 - pos);
+    std::memcpy(dst, ring_.data() + pos, first);
+    if (first < n) std::memcpy(dst + first, ring_.data(), n - first);
+}
+
+// code = n means (n-1) non-zero bytes follow; a zero is implied after every block with
+// code < 0xFF except the last one.
+CobsFramer::Result CobsFramer::decode_(size_t start, size_t encodedLen)
+{
+    lastEncodedLen_ = encodedLen;
+
+    const size_t L = maxLen_;
+    if (encodedLen < minEncodedLength(minLen_) || encodedLen > maxEncodedLength(L)) {
+        return Result::BadLength;
+    }
+
+    uint8_t* out = payload_.data();
+    size_t i = 0, o = 0;
+    while (i < encodedLen) {
+        const uint8_t code = ring_[(start + i) & mask_];
+        ++i;
+        if (code == 0) return Result::BadEncoding;
+
+        const size_t n = code - 1u;
+        if (i + n > encodedLen || o + n > L) return Result::BadEncoding;
+        copyOut_(start + i, out + o, n);
+        i += n;
+        o += n;
+
+        if (code < 0xFF && i < encodedLen) {
+            if (o >= L) return Result::BadEncoding;
+            out[o++] = 0;
+        }
+    }
+    if (o < minLen_) return Result::BadEncoding;
+    len_ = o;
+    return Result::Frame;
+}
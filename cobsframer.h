@@ -0,0 +1,95 @@
+#ifndef COBSFRAMER_H
+#define COBSFRAMER_H
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * Allocation-free COBS frame extractor for fixed- or bounded-length payloads.
+ *
+ * Usage:
+ *   CobsFramer framer(rx_len);
+ *   size_t room; uint8_t* p = framer.writePtr(room);   // read the port straight into the ring
+ *   framer.commit(serial.read(p, room));
+ *   for (CobsFramer::Result r; (r = framer.next()) != CobsFramer::Result::None;) {
+ *       if (r == CobsFramer::Result::Frame) use(framer.payload());
+ *   }
+ *
+ * - Bytes live in a fixed power-of-two ring; nothing is moved when frames are consumed.
+ * - The 0x00 delimiter is searched with memchr over contiguous spans (SIMD in the CRT),
+ *   and bytes already scanned are never scanned again.
+ * - Each frame is decoded straight out of the ring into one preallocated payload slot,
+ *   which stays valid until the next call to next().
+ * - CobsFramer(minLen, maxLen) accepts any payload length in that range; payloadLen()
+ *   then reports the length of the current frame.
+ */
+class CobsFramer
+{
+public:
+    enum class Result {
+        None = 0,      // no complete frame buffered
+        Frame,         // payload() holds a decoded frame
+        BadLength,     // encoded length cannot produce an accepted payload length
+        BadEncoding,   // malformed COBS (zero code / overrun / wrong decoded length)
+        Overflow,      // ring filled up without a delimiter; buffer was discarded
+    };
+
+    struct Stats {
+        uint64_t bytes     = 0;
+        uint64_t frames    = 0;
+        uint64_t badFrames = 0;
+        uint64_t overflows = 0;
+    };
+
+    explicit CobsFramer(size_t payloadLen, size_t capacity = 4096);
+    CobsFramer(size_t minPayloadLen, size_t maxPayloadLen, size_t capacity);
+
+    // ---- Producer ----
+    uint8_t* writePtr(size_t& contiguous);     // free space at the tail (may be 0)
+    void     commit(size_t n);                 // n bytes were written at writePtr()
+    size_t   write(const uint8_t* data, size_t n); // copying convenience; returns bytes accepted
+
+    // ---- Consumer ----
+    Result next();
+
+    const uint8_t* payload()    const { return payload_.data(); }
+    size_t         payloadLen() const { return len_; }
+    size_t         lastEncodedLen() const { return lastEncodedLen_; }
+
+    size_t buffered() const { return tail_ - head_; }
+    size_t capacity() const { return mask_ + 1; }
+    const Stats& stats() const { return stats_; }
+    void clear();
+
+    // Encodes `in` into `out` (capacity >= maxEncodedLength(n)) WITHOUT the trailing 0x00.
+    // Returns the encoded length.
+    static size_t encode(const uint8_t* in, size_t n, uint8_t* out);
+
+    // Encoded length bounds (without the delimiter) for a raw payload of rawLen bytes
+    static size_t minEncodedLength(size_t rawLen);
+    static size_t maxEncodedLength(size_t rawLen);
+
+private:
+    Result decode_(size_t start, size_t encodedLen);
+    void   copyOut_(size_t from, uint8_t* dst, size_t n) const;
+
+private:
+    std::vector<uint8_t> ring_;
+    std::vector<uint8_t> payload_;   // sized for maxLen_
+    size_t minLen_ = 0;
+    size_t maxLen_ = 0;
+    size_t len_    = 0;              // decoded length of the current frame
+    size_t mask_ = 0;
+
+    // Monotonic byte positions; index into ring_ with (pos & mask_)
+    size_t head_ = 0;   // first byte of the current (incomplete) frame
+    size_t scan_ = 0;   // bytes before this are known to hold no delimiter
+    size_t tail_ = 0;   // one past the last written byte
+
+    size_t lastEncodedLen_ = 0;
+    Stats  stats_;
+};
+
+#endif // COBSFRAMER_H
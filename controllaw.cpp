@@ -0,0 +1,105 @@
+#include "controllaw.h"
+
+#include <algorithm>
+#include <cmath>
+
+ControlLaw::ControlLaw(AutoBending& controller)
+    : controller_(controller)
+{
+}
+
+void ControlLaw::setLimits(AxisIndex index, double min, double max)
+{
+    limits_[size_t(index)] = {min, max};
+}
+
+void ControlLaw::setTracking(bool on, const TargetTracker::Options& options)
+{
+    tracking_ = on;
+    tracker_.setOptions(options);
+}
+
+void ControlLaw::restart(int64_t now, const Targets& from)
+{
+    targets_ = from;
+    controller_.reset();
+    lastSampleNs_ = 0;
+    deltaX_ = deltaY_ = 0.0;
+    if (controller_.latencyCompensation()) controller_.noteCommand(now, targets_[Horizontal], targets_[Vertical]);
+}
+
+ControlLaw::Step ControlLaw::step(int64_t now, double dtSec, const Sample* s, bool applying)
+{
+    const bool compensate = controller_.latencyCompensation();
+    const int64_t holdNs = holdNs_.load(std::memory_order_relaxed);
+
+    Step out;
+    bool fresh = false;
+    out.changed = s != nullptr;
+
+    if (tracking_) {
+        // Step on the error predicted for this tick; stop once the track coasts too long.
+        // With latency compensation the track lives in the stabilized frame, so our own
+        // motion is not extrapolated as target velocity.
+        if (s) {
+            double x = s->dx, y = s->dy;
+            if (compensate) controller_.toStabilized(s->stampNs, s->dx, s->dy, x, y);
+            tracker_.update(s->stampNs, x, y);
+        }
+        TargetTracker::Estimate e;
+        fresh = tracker_.predict(now, e);
+        if (fresh) {
+            double ex = e.x, ey = e.y;
+            if (compensate) controller_.fromStabilized(e.x, e.y, ex, ey);
+            if (!controller_.stepAt(now, ex, ey, deltaX_, deltaY_)) deltaX_ = deltaY_ = 0.0;
+            out.output.tracked = true;
+            out.output.errorX = ex;
+            out.output.errorY = ey;
+            out.output.sigmaX = std::sqrt(e.varX);
+            out.output.sigmaY = std::sqrt(e.varY);
+            out.changed = true;
+        } else if (deltaX_ != 0.0 || deltaY_ != 0.0) {
+            deltaX_ = deltaY_ = 0.0;
+            out.changed = true;
+        }
+    } else if (compensate) {
+        // Re-step on the last sample every tick: the compensated error shrinks as commands go out
+        if (s) {
+            last_ = *s;
+            lastSampleNs_ = now;
+        }
+        fresh = lastSampleNs_ != 0 && now - lastSampleNs_ <= holdNs;
+        if (fresh) {
+            if (!controller_.stepDelayed(last_.stampNs, now, last_.dx, last_.dy, deltaX_, deltaY_)) deltaX_ = deltaY_ = 0.0;
+            out.changed = true;
+        } else if (deltaX_ != 0.0 || deltaY_ != 0.0) {
+            deltaX_ = deltaY_ = 0.0;
+            out.changed = true;
+        }
+    } else {
+        // Keep moving at the last commanded rate while the sample is fresh
+        if (s) {
+            lastSampleNs_ = now;
+            if (!controller_.stepAt(now, s->dx, s->dy, deltaX_, deltaY_)) deltaX_ = deltaY_ = 0.0;
+        }
+        fresh = lastSampleNs_ != 0 && now - lastSampleNs_ <= holdNs;
+    }
+
+    if (applying && fresh) {
+        const double k = dtSec / 0.1;   // outputs are per 100 ms
+        Targets next = targets_;
+        next[Horizontal] = std::clamp(next[Horizontal] + deltaX_ * k, limits_[Horizontal][0], limits_[Horizontal][1]);
+        next[Vertical]   = std::clamp(next[Vertical]   + deltaY_ * k, limits_[Vertical][0],   limits_[Vertical][1]);
+        if (next != targets_) {
+            targets_ = next;
+            if (compensate) controller_.noteCommand(now, targets_[Horizontal], targets_[Vertical]);
+            out.moved = true;
+            out.changed = true;
+        }
+    }
+
+    out.output.deltaX = deltaX_;
+    out.output.deltaY = deltaY_;
+    out.output.targets = targets_;
+    return out;
+}
@@ -0,0 +1,97 @@
+#ifndef CONTROLLAW_H
+#define CONTROLLAW_H
+
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+#include "autobending.h"
+#include "targettracker.h"
+
+/**
+ * @brief One control tick without a clock: error sample -> AutoBending -> motor targets.
+ *
+ * Usage:
+ *   ControlLaw law(autoBend);
+ *   law.setLimits(ControlLaw::Vertical, 0.0, 270.0);
+ *   law.restart(nowNs, {135.0, 135.0});          // starting targets (vertical, horizontal)
+ *   const ControlLaw::Step s = law.step(nowNs, dtSec, sample, applying);   // sample may be nullptr
+ *   if (s.moved) write(law.targets());
+ *
+ * ControlLoop calls it from its fixed-rate thread and ControlSim (PlantSimulator) from its
+ * simulated clock, so the simulator sweeps exactly the controller that ships.
+ * Times are std::chrono::steady_clock ns in the loop and simulated ns in ControlSim.
+ *
+ * Control:
+ *   Each new error sample runs one AutoBending::step (its dt is the time between samples).
+ *   The step output is an increment per 100 ms, the period of the GUI timer that used to
+ *   apply it, so each step adds output * dtSec / 100 ms to the targets until the next sample.
+ *   A sample older than the hold time stops the motion. Targets are clamped to the axis limits.
+ *
+ * Tracking (setTracking):
+ *   Samples feed a TargetTracker at their frame timestamps instead, and every step drives the
+ *   controller on the error predicted for "now". Motion stops when the track coasts longer
+ *   than the tracker's maxCoastSec.
+ *
+ * Latency compensation (AutoBending::setLatencyCompensation):
+ *   Every target change is reported to the controller's servo model (noteCommand), and the
+ *   error of a frame is corrected for the motion since its capture and for the commands
+ *   still in flight. Untracked, the last sample is re-stepped every tick so the corrected
+ *   error shrinks as commands go out instead of repeating the last output.
+ */
+class ControlLaw
+{
+public:
+    // Vertical = motor 0 (AutoBending Y), horizontal = motor 1 (AutoBending X)
+    enum AxisIndex { Vertical = 0, Horizontal = 1 };
+    using Targets = std::array<double, 2>;
+
+    struct Sample {
+        double  dx = 0.0, dy = 0.0;
+        int64_t stampNs = 0;   // frame capture
+    };
+
+    struct Output {
+        double  deltaX = 0.0, deltaY = 0.0;   // last AutoBending::step output
+        Targets targets{};
+        bool    tracked = false;              // the fields below are valid
+        double  errorX = 0.0, errorY = 0.0;   // predicted error, px
+        double  sigmaX = 0.0, sigmaY = 0.0;   // its standard deviation, px
+    };
+
+    struct Step {
+        bool   changed = false;   // output differs from the previous step
+        bool   moved   = false;   // targets changed (write them out)
+        Output output;
+    };
+
+    explicit ControlLaw(AutoBending& controller);
+
+    // Before the first step
+    void setLimits(AxisIndex index, double min, double max);
+    void setTracking(bool on, const TargetTracker::Options& options = {});
+
+    // Any thread
+    void setHoldNs(int64_t ns) { holdNs_.store(ns, std::memory_order_relaxed); }
+
+    // Starts over from the given targets (resets the controller state)
+    void restart(int64_t nowNs, const Targets& from);
+    Step step(int64_t nowNs, double dtSec, const Sample* sample, bool applying);
+
+    const Targets& targets() const { return targets_; }
+
+private:
+    AutoBending&  controller_;
+    TargetTracker tracker_;
+    bool          tracking_ = false;
+    std::array<std::array<double, 2>, 2> limits_{{ {0.0, 270.0}, {0.0, 270.0} }};
+    std::atomic<int64_t> holdNs_{250000000};
+
+    Targets targets_{};
+    int64_t lastSampleNs_ = 0;   // arrival of the last sample (untracked hold)
+    Sample  last_;               // last sample (untracked, latency compensated)
+    double  deltaX_ = 0.0, deltaY_ = 0.0;
+};
+
+#endif // CONTROLLAW_H
@@ -0,0 +1,245 @@
+#include "controlloop.h"
+
+#include <QDebug>
+#include <QMutexLocker>
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#elif defined(_WIN32)
+#include <windows.h>
+#include <timeapi.h>
+#endif
+
+#include "SerialInterface.h"
+
+namespace {
+
+// Coarse sleep ends this far before the deadline; the rest is spun
+#if defined(_WIN32)
+constexpr int64_t kSpinNs = 1500000;   // 1 ms timer resolution at best
+#else
+constexpr int64_t kSpinNs = 200000;
+#endif
+
+} // namespace
+
+ControlLoop::ControlLoop(AutoBending& controller)
+    : law_(controller)
+{
+}
+
+ControlLoop::~ControlLoop()
+{
+    stop();
+}
+
+int64_t ControlLoop::clockNs()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void ControlLoop::setAxis(AxisIndex index, const Axis& axis)
+{
+    axes_[size_t(index)] = axis;
+    law_.setLimits(index, axis.min, axis.max);
+}
+
+void ControlLoop::setTracking(bool on, const TargetTracker::Options& options)
+{
+    law_.setTracking(on, options);
+}
+
+bool ControlLoop::start(const Options& options)
+{
+    if (running_.load(std::memory_order_acquire) || options.rateHz <= 0) return false;
+
+    options_ = options;
+    resetStats();
+    stopRequested_.store(false, std::memory_order_release);
+    running_.store(true, std::memory_order_release);
+    thread_ = std::thread([this](){ run_(); });
+    return true;
+}
+
+void ControlLoop::stop()
+{
+    stopRequested_.store(true, std::memory_order_release);
+    if (thread_.joinable()) thread_.join();
+    running_.store(false, std::memory_order_release);
+}
+
+void ControlLoop::setApplying(bool on, const Targets& from)
+{
+    if (on) restart_.publish(from);
+    applying_.store(on, std::memory_order_release);
+}
+
+void ControlLoop::setSerialInterface(SerialInterface* serial)
+{
+    QMutexLocker lock(&serialMutex_);
+    serial_ = serial;
+}
+
+void ControlLoop::submitError(double differenceX_px, double differenceY_px, int64_t stampNs)
+{
+    samples_.publish({differenceX_px, differenceY_px, stampNs > 0 ? stampNs : clockNs()});
+}
+
+ControlLoop::Stats ControlLoop::stats() const
+{
+    QMutexLocker lock(&statsMutex_);
+    Stats s = stats_;
+    if (s.ticks > 0) {
+        s.meanJitterUs = jitterSumUs_ / double(s.ticks);
+        s.meanWorkUs   = workSumUs_ / double(s.ticks);
+
+        const uint64_t rank = (s.ticks * 99 + 99) / 100;
+        uint64_t seen = 0;
+        for (int i = 0; i < kJitterBuckets; ++i) {
+            seen += jitterHist_[size_t(i)];
+            if (seen >= rank) { s.p99JitterUs = double((i + 1) * kJitterBucketUs); break; }
+        }
+    }
+    return s;
+}
+
+void ControlLoop::resetStats()
+{
+    QMutexLocker lock(&statsMutex_);
+    stats_ = Stats();
+    jitterSumUs_ = workSumUs_ = 0.0;
+    jitterHist_.fill(0);
+}
+
+// ======================= Control thread =======================
+
+void ControlLoop::configureThread_()
+{
+#if defined(__linux__)
+    if (options_.realtime) {
+        sched_param sp{};
+        sp.sched_priority = std::min(80, sched_get_priority_max(SCHED_FIFO));
+        if (const int err = pthread_setschedparam(pthread_self(), SCHED_FIFO, &sp)) {
+            qWarning() << "[Control] SCHED_FIFO not available:" << std::strerror(err);
+        }
+    }
+    if (options_.cpu >= 0) {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(options_.cpu, &set);
+        if (const int err = pthread_setaffinity_np(pthread_self(), sizeof(set), &set)) {
+            qWarning() << "[Control] Pinning to CPU" << options_.cpu << "failed:" << std::strerror(err);
+        }
+    }
+#elif defined(_WIN32)
+    if (options_.realtime) SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_TIME_CRITICAL);
+    if (options_.cpu >= 0) qWarning() << "[Control] CPU pinning is only supported on Linux.";
+#else
+    if (options_.realtime || options_.cpu >= 0) qWarning() << "[Control] Thread priority / pinning not supported here.";
+#endif
+}
+
+void ControlLoop::run_()
+{
+#if defined(_WIN32)
+    timeBeginPeriod(1);
+#endif
+    configureThread_();
+
+    const int64_t periodNs = 1000000000LL / options_.rateHz;
+    int64_t deadline = clockNs() + periodNs;
+    int64_t previous = deadline - periodNs;
+
+    while (!stopRequested_.load(std::memory_order_acquire)) {
+        // Coarse sleep, then spin the last stretch
+        const int64_t spinFrom = deadline - kSpinNs;
+        if (clockNs() < spinFrom) std::this_thread::sleep_for(std::chrono::nanoseconds(spinFrom - clockNs()));
+        while (clockNs() < deadline) std::this_thread::yield();
+
+        const int64_t woke = clockNs();
+        tick_(woke, double(std::min(woke - previous, 5 * periodNs)) / 1e9);
+        const int64_t done = clockNs();
+        record_(woke - deadline, done - woke);
+        previous = woke;
+
+        // Skip deadlines that already passed instead of bursting to catch up
+        deadline += periodNs;
+        if (done >= deadline) {
+            const int64_t missed = (done - deadline) / periodNs + 1;
+            deadline += missed * periodNs;
+
+            QMutexLocker lock(&statsMutex_);
+            stats_.overruns += uint64_t(missed);
+        }
+    }
+
+#if defined(_WIN32)
+    timeEndPeriod(1);
+#endif
+    running_.store(false, std::memory_order_release);
+}
+
+void ControlLoop::tick_(int64_t now, double dtSec)
+{
+    if (auto from = restart_.take()) {
+        samples_.clear();
+        hasWritten_ = false;
+        law_.restart(now, *from);
+    }
+
+    const std::unique_ptr<Sample> s = samples_.take();
+    if (s) {
+        QMutexLocker lock(&statsMutex_);
+        ++stats_.samples;
+        stats_.pipelineDelayMs = double(now - s->stampNs) / 1e6;
+    }
+
+    const ControlLaw::Step step = law_.step(now, dtSec, s.get(), applying_.load(std::memory_order_acquire));
+    if (step.moved) write_(law_.targets());
+    if (step.changed) output_.publish(step.output);
+}
+
+void ControlLoop::write_(const Targets& targets)
+{
+    QMutexLocker lock(&serialMutex_);
+    if (!serial_ || !serial_->isOpen()) return;
+
+    // Same encoding as IntegratedValueController::valueAsBytes(); only changed values are sent
+    bool any = false;
+    for (size_t i = 0; i < targets.size(); ++i) {
+        const qint16 v = qint16(targets[i] * 10);
+        if (hasWritten_ && v == written_[i]) continue;
+
+        const char bytes[2] = { char(quint16(v) >> 8), char(quint16(v) & 0xFF) };
+        if (serial_->SetMessage(axes_[i].txPosition, QByteArray::fromRawData(bytes, 2))) {
+            written_[i] = v;
+            any = true;
+        }
+    }
+    if (!any) return;
+    hasWritten_ = true;
+
+    serial_->Send();
+    QMutexLocker statsLock(&statsMutex_);
+    ++stats_.writes;
+}
+
+void ControlLoop::record_(int64_t jitterNs, int64_t workNs)
+{
+    const double jitterUs = double(std::max<int64_t>(0, jitterNs)) / 1000.0;
+    const double workUs   = double(std::max<int64_t>(0, workNs)) / 1000.0;
+
+    QMutexLocker lock(&statsMutex_);
+    ++stats_.ticks;
+    jitterSumUs_ += jitterUs;
+    workSumUs_   += workUs;
+    stats_.maxJitterUs = std::max(stats_.maxJitterUs, jitterUs);
+    stats_.maxWorkUs   = std::max(stats_.maxWorkUs, workUs);
+    jitterHist_[size_t(std::min(kJitterBuckets - 1, int(jitterUs / kJitterBucketUs)))]++;
+}
@@ -0,0 +1,147 @@
+#ifndef CONTROLLOOP_H
+#define CONTROLLOOP_H
+
+#pragma once
+#include <QMutex>
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <thread>
+
+#include "autobending.h"
+#include "controllaw.h"
+#include "latestslot.h"
+#include "targettracker.h"
+
+class SerialInterface;
+
+/**
+ * @brief Fixed-rate control thread: latest detection error -> AutoBending -> motor targets -> serial TX.
+ *
+ * Usage:
+ *   ControlLoop loop(autoBend);
+ *   loop.setSerialInterface(serial);              // nullptr while detached
+ *   loop.start({200, true, 2});                   // 200 Hz, RT priority, pinned to CPU 2
+ *   loop.setApplying(true, {135.0, 135.0});       // starting targets (vertical, horizontal)
+ *   loop.submitError(dx, dy, frameStampNs);       // any thread, latest sample wins
+ *   if (auto out = loop.takeOutput()) ...         // GUI: what the loop did since the last look
+ *
+ * Timing:
+ *   Ticks run on absolute deadlines (no drift): sleep until shortly before the deadline,
+ *   then spin. Jitter = wake-up - deadline. A tick that wakes after the following deadline
+ *   is an overrun; missed deadlines are skipped rather than caught up.
+ *   Real-time priority (SCHED_FIFO) and CPU pinning are Linux only and best effort
+ *   (they need CAP_SYS_NICE); on Windows the thread gets time-critical priority and a
+ *   1 ms timer resolution.
+ *
+ * Control:
+ *   Each tick runs ControlLaw::step (hold, tracking and latency compensation are described
+ *   there) with the latest sample and the measured tick interval, capped at 5 periods.
+ *   Changed targets are written straight into the SerialInterface TX image; Send() is
+ *   coalesced by its frame clock. Nothing here touches widgets, so the loop runs the same
+ *   with or without the GUI. Timestamps are std::chrono::steady_clock ns (clockNs()).
+ */
+class ControlLoop
+{
+public:
+    struct Options {
+        int  rateHz   = 200;
+        bool realtime = false;   // SCHED_FIFO (Linux) / time-critical (Windows)
+        int  cpu      = -1;      // pin to this CPU (Linux), -1 = any
+    };
+
+    struct Axis {
+        int    txPosition = 0;   // 2 bytes (angle * 10, big endian) in the TX image
+        double min        = 0.0;
+        double max        = 270.0;
+    };
+
+    // Vertical = motor 0 (AutoBending Y), horizontal = motor 1 (AutoBending X)
+    using AxisIndex = ControlLaw::AxisIndex;
+    static constexpr AxisIndex Vertical   = ControlLaw::Vertical;
+    static constexpr AxisIndex Horizontal = ControlLaw::Horizontal;
+    using Targets = ControlLaw::Targets;
+    using Output  = ControlLaw::Output;
+
+    struct Stats {
+        uint64_t ticks     = 0;
+        uint64_t overruns  = 0;     // deadlines missed
+        uint64_t samples   = 0;     // error samples consumed
+        uint64_t writes    = 0;     // target updates sent
+        double   meanJitterUs = 0.0;
+        double   p99JitterUs  = 0.0;
+        double   maxJitterUs  = 0.0;
+        double   meanWorkUs   = 0.0;   // tick body, excluding the wait
+        double   maxWorkUs    = 0.0;
+        double   pipelineDelayMs = 0.0;    // frame capture -> control thread, last sample
+    };
+
+    explicit ControlLoop(AutoBending& controller);
+    ~ControlLoop();
+
+    ControlLoop(const ControlLoop&) = delete;
+    ControlLoop& operator=(const ControlLoop&) = delete;
+
+    void setAxis(AxisIndex index, const Axis& axis);   // before start()
+    void setHoldMs(int ms) { law_.setHoldNs(int64_t(ms) * 1000000); }
+    void setTracking(bool on, const TargetTracker::Options& options = {});   // before start()
+
+    bool start(const Options& options);
+    void stop();
+    bool isRunning() const { return running_.load(std::memory_order_acquire); }
+
+    // The loop only moves the motors while applying; enabling resets the controller state.
+    void setApplying(bool on, const Targets& from);
+
+    void setSerialInterface(SerialInterface* serial);
+
+    // stampNs: when the frame behind the error was captured (clockNs()), 0 = now
+    void submitError(double differenceX_px, double differenceY_px, int64_t stampNs = 0);
+    static int64_t clockNs();
+
+    std::unique_ptr<Output> takeOutput() { return output_.take(); }
+    Stats stats() const;
+    void  resetStats();
+
+private:
+    using Sample = ControlLaw::Sample;
+
+    static constexpr int kJitterBucketUs = 10;
+    static constexpr int kJitterBuckets  = 1000;   // up to 10 ms, overflow in the last bucket
+
+    void run_();
+    void configureThread_();
+    void tick_(int64_t nowNs, double dtSec);
+    void write_(const Targets& targets);
+    void record_(int64_t jitterNs, int64_t workNs);
+
+    ControlLaw    law_;
+    Options       options_;
+    std::array<Axis, 2> axes_{{ {0, 0.0, 270.0}, {2, 0.0, 270.0} }};
+
+    std::thread       thread_;
+    std::atomic<bool> running_{false};
+    std::atomic<bool> stopRequested_{false};
+
+    LatestSlot<Sample>  samples_;
+    LatestSlot<Output>  output_;
+    LatestSlot<Targets> restart_;          // setApplying(true) -> control thread
+    std::atomic<bool>    applying_{false};
+
+    QMutex           serialMutex_;         // held while the loop writes
+    SerialInterface* serial_ = nullptr;
+
+    // Control thread only
+    std::array<int16_t, 2> written_{};   // last values handed to SetMessage (angle * 10)
+    bool    hasWritten_ = false;
+
+    mutable QMutex statsMutex_;
+    Stats          stats_;
+    double         jitterSumUs_ = 0.0;
+    double         workSumUs_   = 0.0;
+    std::array<uint32_t, kJitterBuckets> jitterHist_{};
+};
+
+#endif // CONTROLLOOP_H
@@ -1,81 +1,197 @@
 #include "DarknessDetector.h"
+#include "striplabeler.h"
 #include <QMetaObject>
 #include <QDebug>
+#include <QElapsedTimer>
+#include <QLoggingCategory>
 
 // OpenCV
 #include <opencv2/imgproc.hpp>
 #include <opencv2/core.hpp>
 
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+// Pyramid, adaptive threshold and tracking window reports; off unless enabled, e.g.
+//   QT_LOGGING_RULES="bendemo.stats.detector.debug=true"
+Q_LOGGING_CATEGORY(lcDetectorStats, "bendemo.stats.detector", QtInfoMsg)
+
 // ======================== Helpers (private static) ========================
 
-static cv::Mat toGray(const cv::Mat& bgrOrGray) {
-    if (bgrOrGray.channels() == 1) return bgrOrGray.clone();
-    cv::Mat gray;
-    cv::cvtColor(bgrOrGray, gray, cv::COLOR_BGR2GRAY);
-    return gray;
+namespace {
+
+struct Blob {
+    cv::Rect box;
+    int    area  = 0;
+    int    label = -1;
+    double cx = 0.0, cy = 0.0;  // centroid from first-order moments (m10/m00, m01/m00)
+    double rank = 0.0;
+};
+
+// Area, optionally weighted by how well the blob fills its box (0 = area only).
+double rankOf(const Blob& b, float shapeWeight)
+{
+    const double fill = b.box.area() > 0 ? double(b.area) / b.box.area() : 0.0;
+    return b.area * (1.0 - shapeWeight + shapeWeight * fill);
 }
 
-cv::Mat DarknessDetector::qimageToCvBgrOrGray(const QImage& image)
+// Top-k connected components of a binary mask (background label 0 excluded), best first.
+// strips > 0 uses the parallel strip labeler instead of OpenCV (same result).
+void topComponents(const cv::Mat& mask, int k, float shapeWeight, int strips, std::vector<Blob>& out)
 {
-    switch (image.format()) {
-    case QImage::Format_RGB888: {
-        cv::Mat rgb(image.height(), image.width(), CV_8UC3,
-                    const_cast<uchar*>(image.bits()),
-                    image.bytesPerLine());
-        cv::Mat bgr;
-        cv::cvtColor(rgb, bgr, cv::COLOR_RGB2BGR);
-        return bgr;
+    out.clear();
+
+    if (strips > 0) {
+        // The strip labeler ranks by area; keep a few extra candidates for shape re-ranking.
+        std::vector<StripLabeler::Component> comps;
+        StripLabeler(shapeWeight > 0.f ? k * 4 : k, strips).label(mask, comps);
+        for (const StripLabeler::Component& c : comps) {
+            Blob b;
+            b.box   = cv::Rect(c.left, c.top, c.width, c.height);
+            b.area  = c.area;
+            b.label = int(out.size()) + 1;
+            b.cx = c.cx; b.cy = c.cy;
+            out.push_back(b);
+        }
+    } else {
+        cv::Mat labels, stats, centroids;
+        const int num = cv::connectedComponentsWithStats(mask, labels, stats, centroids);
+        for (int i = 1; i < num; ++i) {
+            Blob b;
+            b.box = cv::Rect(stats.at<int>(i, cv::CC_STAT_LEFT),
+                             stats.at<int>(i, cv::CC_STAT_TOP),
+                             stats.at<int>(i, cv::CC_STAT_WIDTH),
+                             stats.at<int>(i, cv::CC_STAT_HEIGHT));
+            b.area  = stats.at<int>(i, cv::CC_STAT_AREA);
+            b.label = i;
+            b.cx = centroids.at<double>(i, 0);
+            b.cy = centroids.at<double>(i, 1);
+            out.push_back(b);
+        }
     }
+
+    for (Blob& b : out) b.rank = rankOf(b, shapeWeight);
+
+    // Ties go to the lower label, i.e. the region that starts first in raster order
+    const int n = std::min<int>(k, int(out.size()));
+    std::partial_sort(out.begin(), out.begin() + n, out.end(), [](const Blob& a, const Blob& b) {
+        if (a.rank != b.rank) return a.rank > b.rank;
+        return a.label < b.label;
+    });
+    out.resize(n);
+}
+
+// Coarse-to-fine: rank components on a 1/scale mask, then re-label only the winner's
+// (padded) bounding box at full resolution to recover exact edges, area and centroid.
+// The other results keep their coarse geometry, mapped back to full resolution.
+void topComponentsPyramid(const cv::Mat& gray, int blackThreshold, int scale,
+                          int k, float shapeWeight, int strips, std::vector<Blob>& out)
+{
+    cv::Mat small, smallMask;
+    cv::resize(gray, small, cv::Size(), 1.0 / scale, 1.0 / scale, cv::INTER_AREA);
+    cv::threshold(small, smallMask, blackThreshold, 255, cv::THRESH_BINARY_INV);
+
+    topComponents(smallMask, k, shapeWeight, strips, out);
+    if (out.empty()) return;
+
+    // One coarse cell of padding: area averaging can move a blob edge by up to one cell.
+    const cv::Rect coarseBox = out[0].box;
+    const cv::Rect roi = cv::Rect((coarseBox.x - 1) * scale,
+                                  (coarseBox.y - 1) * scale,
+                                  (coarseBox.width  + 2) * scale,
+                                  (coarseBox.height + 2) * scale)
+                         & cv::Rect(0, 0, gray.cols, gray.rows);
+
+    // Coarse cell i covers full-resolution pixels [i * scale, (i + 1) * scale)
+    const double half = 0.5 * (scale - 1);
+    for (Blob& b : out) {
+        b.box  = cv::Rect(b.box.x * scale, b.box.y * scale, b.box.width * scale, b.box.height * scale)
+                 & cv::Rect(0, 0, gray.cols, gray.rows);
+        b.area *= scale * scale;
+        b.cx = b.cx * scale + half;
+        b.cy = b.cy * scale + half;
+    }
+    if (roi.empty()) return;
+
+    cv::Mat roiMask;
+    cv::threshold(gray(roi), roiMask, blackThreshold, 255, cv::THRESH_BINARY_INV);
+
+    std::vector<Blob> fine;
+    topComponents(roiMask, 1, shapeWeight, 0, fine);
+    if (fine.empty()) return;
+
+    Blob winner = fine[0];
+    winner.box.x += roi.x;
+    winner.box.y += roi.y;
+    winner.cx += roi.x;
+    winner.cy += roi.y;
+    winner.label = out[0].label;
+    out[0] = winner;
+}
+
+double iou(const Detector::DetectedObject& a, const Detector::DetectedObject& b)
+{
+    const int ix = std::max(0, std::min(a.x2, b.x2) - std::max(a.x1, b.x1));
+    const int iy = std::max(0, std::min(a.y2, b.y2) - std::max(a.y1, b.y1));
+    const double inter = double(ix) * iy;
+    const double uni = double(a.x2 - a.x1) * (a.y2 - a.y1)
+                     + double(b.x2 - b.x1) * (b.y2 - b.y1) - inter;
+    return uni > 0.0 ? inter / uni : 0.0;
+}
+
+} // namespace
+
+cv::Mat DarknessDetector::qimageToGray(const QImage& image, const QRect& roi)
+{
+    int type = -1, code = -1;
+    switch (image.format()) {
+    case QImage::Format_RGB888:
+        type = CV_8UC3; code = cv::COLOR_RGB2GRAY;
+        break;
     case QImage::Format_ARGB32:
     case QImage::Format_ARGB32_Premultiplied:
     case QImage::Format_RGBA8888:
-    case QImage::Format_RGBA8888_Premultiplied: {
-        cv::Mat rgba(image.height(), image.width(), CV_8UC4,
-                     const_cast<uchar*>(image.bits()),
-                     image.bytesPerLine());
-        cv::Mat bgr;
-        cv::cvtColor(rgba, bgr, cv::COLOR_RGBA2BGR);
-        return bgr;
-    }
-    case QImage::Format_RGB32: {
-        cv::Mat bgra(image.height(), image.width(), CV_8UC4,
-                     const_cast<uchar*>(image.bits()),
-                     image.bytesPerLine());
-        cv::Mat bgr;
-        cv::cvtColor(bgra, bgr, cv::COLOR_BGRA2BGR);
-        return bgr;
-    }
-    case QImage::Format_Grayscale8: {
-        cv::Mat gray(image.height(), image.width(), CV_8UC1,
-                     const_cast<uchar*>(image.bits()),
-                     image.bytesPerLine());
-        return gray.clone();
-    }
+    case QImage::Format_RGBA8888_Premultiplied:
+        type = CV_8UC4; code = cv::COLOR_RGBA2GRAY;
+        break;
+    case QImage::Format_RGB32:
+        type = CV_8UC4; code = cv::COLOR_BGRA2GRAY;
+        break;
+    case QImage::Format_Grayscale8:
+        type = CV_8UC1;
+        break;
     default:
         qWarning() << "[DarknessDetector] Unsupported QImage::Format =" << image.format();
         return cv::Mat();
     }
-}
 
-void DarknessDetector::coverWithWhiteMask(cv::Mat& img, int topPct, int rightLeftPct)
-{
-    if (img.empty()) return;
-    const int h = img.rows, w = img.cols;
-    const int top    = std::max(0, (h * topPct) / 100);
-    const int bottom = h - top;
-    const int left   = std::max(0, (w * rightLeftPct) / 100);
-    const int right  = w - left;
+    // Wrap without copying and convert only the requested region.
+    const cv::Mat whole(image.height(), image.width(), type,
+                        const_cast<uchar*>(image.constBits()),
+                        image.bytesPerLine());
+    const cv::Mat view = whole(cv::Rect(roi.x(), roi.y(), roi.width(), roi.height()));
 
-    const cv::Scalar white = (img.channels() == 1) ? cv::Scalar(255) : cv::Scalar(255,255,255);
+    if (code < 0) return view.clone();
+    cv::Mat gray;
+    cv::cvtColor(view, gray, code);
+    return gray;
+}
 
-    if (top > 0) {
-        cv::rectangle(img, {0,0}, {w, top}, white, cv::FILLED);
-        cv::rectangle(img, {0,bottom}, {w, h}, white, cv::FILLED);
-    }
-    if (left > 0) {
-        cv::rectangle(img, {0,0}, {left, h}, white, cv::FILLED);
-        cv::rectangle(img, {right,0}, {w, h}, white, cv::FILLED);
-    }
+QRect DarknessDetector::unmaskedArea(const QSize& size, int topPct, int rightLeftPct)
+{
+    // The white mask paints rows [0, top] and [h - top, h) (likewise for columns).
+    // Nothing under it can be dark, so detection only has to look at the rest.
+    const int h = size.height(), w = size.width();
+    const int top  = std::max(0, (h * topPct) / 100);
+    const int left = std::max(0, (w * rightLeftPct) / 100);
+
+    const int y1 = (top  > 0) ? top  + 1 : 0;
+    const int y2 = (top  > 0) ? h - top  : h;
+    const int x1 = (left > 0) ? left + 1 : 0;
+    const int x2 = (left > 0) ? w - left : w;
+    if (x2 <= x1 || y2 <= y1) return QRect();
+    return QRect(x1, y1, x2 - x1, y2 - y1);
 }
 
 // ======================== Public: ctor / dtor ========================
@@ -103,52 +219,207 @@ QVector<Detector::DetectedObject> DarknessDetector::detect(const QImage& image,
                                                  int blackThreshold,
                                                  int whiteMaskTopPct,
                                                  int whiteMaskRightLeftPct) const
+{
+    Options options;
+    options.minAreaRatio = minAreaRatio;
+    options.blackThreshold = blackThreshold;
+    options.whiteMaskTopPct = whiteMaskTopPct;
+    options.whiteMaskRightLeftPct = whiteMaskRightLeftPct;
+    return detect(image, options);
+}
+
+QVector<Detector::DetectedObject> DarknessDetector::detect(const QImage& image, const Options& options) const
+{
+    return detect(image, options, QRect(), nullptr);
+}
+
+QVector<Detector::DetectedObject> DarknessDetector::detect(const QImage& image,
+                                                 const Options& options,
+                                                 const QRect& searchWindow,
+                                                 bool* touchesWindowEdge) const
 {
     QVector<Detector::DetectedObject> out;
+    if (touchesWindowEdge) *touchesWindowEdge = false;
+
     if (image.isNull() || image.width() <= 0 || image.height() <= 0) {
         qWarning() << "[DarknessDetector] Invalid image.";
         return out;
     }
 
-    cv::Mat src = qimageToCvBgrOrGray(image);
-    if (src.empty()) {
+    const QRect unmasked = unmaskedArea(image.size(), options.whiteMaskTopPct, options.whiteMaskRightLeftPct);
+    const QRect area = searchWindow.isValid() ? (unmasked & searchWindow) : unmasked;
+    if (area.isEmpty()) return out;
+
+    cv::Mat gray = qimageToGray(image, area);
+    if (gray.empty()) {
         qWarning() << "[DarknessDetector] Unsupported format.";
         return out;
     }
 
-    if (whiteMaskTopPct > 0 || whiteMaskRightLeftPct > 0) {
-        coverWithWhiteMask(src, whiteMaskTopPct, whiteMaskRightLeftPct);
+    const int k = std::max(1, options.maxResults);
+    std::vector<Blob> blobs;
+    if (options.pyramidScale > 1) {
+        topComponentsPyramid(gray, options.blackThreshold, options.pyramidScale,
+                             k, options.shapeWeight, options.labelerStrips, blobs);
+    } else {
+        cv::Mat mask;
+        cv::threshold(gray, mask, options.blackThreshold, 255, cv::THRESH_BINARY_INV);
+        topComponents(mask, k, options.shapeWeight, options.labelerStrips, blobs);
+    }
+    if (blobs.empty()) return out;
+
+    const double imgArea = double(image.width()) * image.height();
+    for (const Blob& blob : blobs) {
+        const float sizeRatio = float(blob.area / imgArea);
+        if (sizeRatio < options.minAreaRatio) continue;
+
+        // For the blob that becomes out[0] (the one the tracker follows): only edges the window
+        // introduced count; image borders and the white mask bound the blob anyway.
+        if (touchesWindowEdge && out.isEmpty()) {
+            const cv::Rect& box = blob.box;
+            *touchesWindowEdge =
+                (box.x == 0                  && area.left()   > unmasked.left())   ||
+                (box.y == 0                  && area.top()    > unmasked.top())    ||
+                (box.br().x == area.width()  && area.right()  < unmasked.right())  ||
+                (box.br().y == area.height() && area.bottom() < unmasked.bottom());
+        }
+
+        DetectedObject obj;
+        obj.x1 = area.x() + blob.box.x; obj.y1 = area.y() + blob.box.y;
+        obj.x2 = obj.x1 + blob.box.width; obj.y2 = obj.y1 + blob.box.height;
+        obj.cx = float(area.x() + blob.cx); obj.cy = float(area.y() + blob.cy);
+        obj.index = int(out.size()); obj.classifySize = 1; obj.name = "Path"; obj.score = sizeRatio;
+
+        out.push_back(obj);
     }
+    return out;
+}
 
-    cv::Mat gray = toGray(src);
-    cv::Mat mask;
-    cv::threshold(gray, mask, blackThreshold, 255, cv::THRESH_BINARY_INV);
+void DarknessDetector::lumaHistogram(const QImage& image, const QRect& area, int step, int hist[256])
+{
+    std::fill(hist, hist + 256, 0);
+    step = std::max(1, step);
 
-    cv::Mat labels, stats, centroids;
-    int num = cv::connectedComponentsWithStats(mask, labels, stats, centroids);
-    if (num <= 1) return out; // background only
+    // Byte offsets of R, G, B inside one pixel, consistent with qimageToGray()
+    int bpp = 0, r = 0, g = 1, b = 2;
+    switch (image.format()) {
+    case QImage::Format_RGB888:
+        bpp = 3;
+        break;
+    case QImage::Format_ARGB32:
+    case QImage::Format_ARGB32_Premultiplied:
+    case QImage::Format_RGBA8888:
+    case QImage::Format_RGBA8888_Premultiplied:
+        bpp = 4;
+        break;
+    case QImage::Format_RGB32:
+        bpp = 4; r = 2; b = 0;
+        break;
+    case QImage::Format_Grayscale8:
+        bpp = 1; r = g = b = 0;
+        break;
+    default:
+        return;
+    }
 
-    int maxLabel = -1, maxArea = 0;
-    for (int i = 1; i < num; ++i) {
-        int area = stats.at<int>(i, cv::CC_STAT_AREA);
-        if (area > maxArea) { maxArea = area; maxLabel = i; }
+    const QRect roi = area & image.rect();
+    for (int y = roi.top(); y <= roi.bottom(); y += step) {
+        const uchar* line = image.constScanLine(y);
+        for (int x = roi.left(); x <= roi.right(); x += step) {
+            const uchar* px = line + x * bpp;
+            // BT.601 luma in fixed point, as used by cv::cvtColor
+            ++hist[(px[r] * 4899 + px[g] * 9617 + px[b] * 1868 + 8192) >> 14];
+        }
     }
-    if (maxLabel < 0) return out;
+}
 
-    const double imgArea = double(image.width()) * image.height();
-    const float sizeRatio = float(maxArea / imgArea);
-    if (sizeRatio < minAreaRatio) return out;
-
-    DetectedObject obj;
-    const int left   = stats.at<int>(maxLabel, cv::CC_STAT_LEFT);
-    const int top    = stats.at<int>(maxLabel, cv::CC_STAT_TOP);
-    const int width  = stats.at<int>(maxLabel, cv::CC_STAT_WIDTH);
-    const int height = stats.at<int>(maxLabel, cv::CC_STAT_HEIGHT);
-    obj.x1 = left; obj.y1 = top; obj.x2 = left + width; obj.y2 = top + height;
-    obj.index = maxLabel; obj.classifySize = 1; obj.name = "Path"; obj.score = sizeRatio;
-
-    out.push_back(obj);
-    return out;
+int DarknessDetector::thresholdFromHistogram(const int hist[256], ThresholdMode mode, float percentile,
+                                             int minSeparation)
+{
+    qint64 total = 0;
+    for (int i = 0; i < 256; ++i) total += hist[i];
+    if (total == 0) return -1;
+
+    // Mean luma of [0, t] against (t, 255]; a missing class counts as no separation
+    auto separated = [&](int t) {
+        if (minSeparation <= 0) return true;
+        double sumBelow = 0.0, sumAbove = 0.0;
+        qint64 nBelow = 0;
+        for (int i = 0; i < 256; ++i) {
+            if (i <= t) { sumBelow += double(i) * hist[i]; nBelow += hist[i]; }
+            else        { sumAbove += double(i) * hist[i]; }
+        }
+        const qint64 nAbove = total - nBelow;
+        if (nBelow == 0 || nAbove == 0) return false;
+        return sumAbove / nAbove - sumBelow / nBelow >= minSeparation;
+    };
+
+    if (mode == ThresholdMode::Percentile) {
+        const qint64 target = qint64(double(total) * std::clamp(percentile, 0.f, 100.f) / 100.0);
+        qint64 cum = 0;
+        int t = 255;
+        for (int i = 0; i < 256; ++i) {
+            cum += hist[i];
+            if (cum >= target) { t = i; break; }
+        }
+        return separated(t) ? t : kNoDarkRegion;
+    }
+
+    if (mode == ThresholdMode::Otsu) {
+        double sumAll = 0.0;
+        for (int i = 0; i < 256; ++i) sumAll += double(i) * hist[i];
+
+        double sumBack = 0.0, bestVar = -1.0;
+        qint64 wBack = 0;
+        int best = 0;
+        for (int t = 0; t < 256; ++t) {
+            wBack += hist[t];
+            if (wBack == 0) continue;
+            const qint64 wFore = total - wBack;
+            if (wFore == 0) break;
+
+            sumBack += double(t) * hist[t];
+            const double mBack = sumBack / wBack;
+            const double mFore = (sumAll - sumBack) / wFore;
+            const double var = double(wBack) * double(wFore) * (mBack - mFore) * (mBack - mFore);
+            if (var > bestVar) { bestVar = var; best = t; }
+        }
+        return separated(best) ? best : kNoDarkRegion;
+    }
+
+    return -1;
+}
+
+void DarknessDetector::comparePyramid(const QImage& image, const Options& options, PyramidReport& report) const
+{
+    Options full = options;
+    full.pyramidScale = 1;
+
+    QElapsedTimer t;
+    t.start();
+    const QVector<DetectedObject> coarse = detect(image, options);
+    const double pyramidMs = t.nsecsElapsed() / 1e6;
+
+    t.restart();
+    const QVector<DetectedObject> exact = detect(image, full);
+    const double fullMs = t.nsecsElapsed() / 1e6;
+
+    const int n = ++report.validatedFrames;
+    report.meanPyramidMs += (pyramidMs - report.meanPyramidMs) / n;
+    report.meanFullMs    += (fullMs    - report.meanFullMs)    / n;
+
+    // Both empty counts as a perfect match, one-sided as no overlap at all.
+    double frameIoU = 1.0;
+    if (coarse.isEmpty() != exact.isEmpty()) {
+        ++report.disagreements;
+        frameIoU = 0.0;
+    } else if (!coarse.isEmpty()) {
+        frameIoU = iou(coarse[0], exact[0]);
+        const double dx = 0.5 * ((coarse[0].x1 + coarse[0].x2) - (exact[0].x1 + exact[0].x2));
+        const double dy = 0.5 * ((coarse[0].y1 + coarse[0].y2) - (exact[0].y1 + exact[0].y2));
+        report.maxCenterErrPx = std::max(report.maxCenterErrPx, std::hypot(dx, dy));
+    }
+    report.meanIoU += (frameIoU - report.meanIoU) / n;
 }
 
 // ======================== Asynchronous API (public) ========================
@@ -160,13 +431,26 @@ void DarknessDetector::start()
 
 void DarknessDetector::stop()
 {
+    // Blocking on our own thread would dead-lock (e.g. destruction from the
+    // owning thread, or a detector that was never started in a headless tool).
+    if (QThread::currentThread() == thread()) {
+        stopImpl();
+        return;
+    }
     QMetaObject::invokeMethod(this, "stopImpl", Qt::BlockingQueuedConnection);
 }
 
 void DarknessDetector::submitFrame(const QImage& image, float scaleX, float scaleY)
 {
-    QMetaObject::invokeMethod(this, "submitFrameImpl", Qt::QueuedConnection,
-                              Q_ARG(QImage, image), Q_ARG(float, scaleX), Q_ARG(float, scaleY));
+    if (!enabled_.load(std::memory_order_relaxed) || !running_.load(std::memory_order_acquire)) return;
+    if (image.isNull()) return;
+
+    // Only the empty -> full transition needs a wakeup; a newer frame simply replaces the old one.
+    const qint64 stampNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                               std::chrono::steady_clock::now().time_since_epoch()).count();
+    if (mailbox_.publish({image, scaleX, scaleY, stampNs})) {
+        QMetaObject::invokeMethod(this, "processPending_", Qt::QueuedConnection);
+    }
 }
 
 void DarknessDetector::setMinAreaRatio(float r)
@@ -185,6 +469,40 @@ void DarknessDetector::setWhiteMask(int topPct, int rightLeftPct)
                               Q_ARG(int, topPct), Q_ARG(int, rightLeftPct));
 }
 
+void DarknessDetector::setPyramidScale(int scale)
+{
+    QMetaObject::invokeMethod(this, "setPyramidScaleImpl", Qt::QueuedConnection, Q_ARG(int, scale));
+}
+
+void DarknessDetector::setPyramidValidationInterval(int frames)
+{
+    QMetaObject::invokeMethod(this, "setPyramidValidationIntervalImpl", Qt::QueuedConnection, Q_ARG(int, frames));
+}
+
+void DarknessDetector::setParallelLabeling(int strips)
+{
+    QMetaObject::invokeMethod(this, "setParallelLabelingImpl", Qt::QueuedConnection, Q_ARG(int, strips));
+}
+
+void DarknessDetector::setAdaptiveThreshold(ThresholdMode mode, float percentile, float smoothing, int minSeparation)
+{
+    QMetaObject::invokeMethod(this, "setAdaptiveThresholdImpl", Qt::QueuedConnection,
+                              Q_ARG(int, int(mode)), Q_ARG(float, percentile), Q_ARG(float, smoothing),
+                              Q_ARG(int, minSeparation));
+}
+
+void DarknessDetector::setMaxResults(int k, float shapeWeight)
+{
+    QMetaObject::invokeMethod(this, "setMaxResultsImpl", Qt::QueuedConnection,
+                              Q_ARG(int, k), Q_ARG(float, shapeWeight));
+}
+
+void DarknessDetector::setTracking(bool on, int reacquireEveryNFrames)
+{
+    QMetaObject::invokeMethod(this, "setTrackingImpl", Qt::QueuedConnection,
+                              Q_ARG(bool, on), Q_ARG(int, reacquireEveryNFrames));
+}
+
 // ======================== Worker-thread impl ========================
 
 void DarknessDetector::startImpl()
@@ -198,17 +516,16 @@ void DarknessDetector::startImpl()
     if (thread() != &worker_) {
         moveToThread(&worker_);
     }
-    running_ = true;
-    busy_    = false;
-    pending_ = false;
+    mailbox_.clear();
+    running_.store(true, std::memory_order_release);
 }
 
 void DarknessDetector::stopImpl()
 {
-    running_ = false;
-    busy_    = false;
-    pending_ = false;
+    running_.store(false, std::memory_order_release);
+    mailbox_.clear();
     latest_  = QImage();
+    hasTrack_ = false;
 }
 
 void DarknessDetector::setMinAreaRatioImpl(float r)
@@ -223,6 +540,7 @@ void DarknessDetector::setBlackThresholdImpl(int t)
     if (t < 0) t = 0;
     if (t > 255) t = 255;
     blackThreshold_ = t;
+    if (thresholdMode_ == ThresholdMode::Fixed) currentThreshold_.store(t, std::memory_order_relaxed);
 }
 
 void DarknessDetector::setWhiteMaskImpl(int topPct, int rlPct)
@@ -231,32 +549,173 @@ void DarknessDetector::setWhiteMaskImpl(int topPct, int rlPct)
     whiteRlPct_  = rlPct;
 }
 
-void DarknessDetector::submitFrameImpl(const QImage& img, float sx, float sy)
+void DarknessDetector::setPyramidScaleImpl(int scale)
 {
-    latest_ = img;
-    scaleX_ = sx;
-    scaleY_ = sy;
-    pending_ = true;
-    tryProcess_();
+    if (scale < 1) scale = 1;
+    if (scale > 8) scale = 8;
+    pyramidScale_ = scale;
+    pyramidReport_ = PyramidReport();
 }
 
-void DarknessDetector::tryProcess_()
+void DarknessDetector::setPyramidValidationIntervalImpl(int frames)
 {
-    if (!running_ || busy_ || !pending_ || latest_.isNull()) return;
+    pyramidValidationInterval_ = std::max(0, frames);
+    framesSinceValidation_ = 0;
+}
+
+void DarknessDetector::setParallelLabelingImpl(int strips)
+{
+    labelerStrips_ = std::max(0, strips);
+}
+
+void DarknessDetector::setAdaptiveThresholdImpl(int mode, float percentile, float smoothing, int minSeparation)
+{
+    thresholdMode_ = static_cast<ThresholdMode>(std::clamp(mode, 0, 2));
+    thresholdPercentile_ = std::clamp(percentile, 0.f, 100.f);
+    thresholdSmoothing_ = std::clamp(smoothing, 0.01f, 1.f);
+    thresholdMinSeparation_ = std::clamp(minSeparation, 0, 255);
+    smoothedThreshold_ = -1.0;
+    histogramMs_ = detectMs_ = 0.0;
+    adaptiveFrames_ = 0;
+}
+
+void DarknessDetector::setMaxResultsImpl(int k, float shapeWeight)
+{
+    maxResults_ = std::clamp(k, 1, 16);
+    shapeWeight_ = std::clamp(shapeWeight, 0.f, 1.f);
+}
+
+void DarknessDetector::setTrackingImpl(bool on, int reacquireEveryNFrames)
+{
+    trackingEnabled_ = on;
+    reacquireInterval_ = std::max(1, reacquireEveryNFrames);
+    hasTrack_ = false;
+    windowFrames_ = globalFrames_ = 0;
+}
+
+void DarknessDetector::processPending_()
+{
+    if (!running_.load(std::memory_order_acquire)) return;
+
+    const std::unique_ptr<PendingFrame> frame = mailbox_.take();
+    if (!frame) return;   // already consumed by an earlier wakeup
+
+    latest_ = frame->image;
+    scaleX_ = frame->scaleX;
+    scaleY_ = frame->scaleY;
+    stampNs_ = frame->stampNs;
+
+    Options options;
+    options.minAreaRatio = minAreaRatio_;
+    options.blackThreshold = blackThreshold_;
+    options.whiteMaskTopPct = whiteTopPct_;
+    options.whiteMaskRightLeftPct = whiteRlPct_;
+    options.pyramidScale = pyramidScale_;
+    options.labelerStrips = labelerStrips_;
+    options.maxResults = maxResults_;
+    options.shapeWeight = shapeWeight_;
+
+    QElapsedTimer cost;
+    bool noDarkRegion = false;
+    if (thresholdMode_ != ThresholdMode::Fixed) {
+        cost.start();
+
+        int hist[256];
+        lumaHistogram(latest_, unmaskedArea(latest_.size(), whiteTopPct_, whiteRlPct_), kHistogramStep, hist);
+        const int raw = thresholdFromHistogram(hist, thresholdMode_, thresholdPercentile_, thresholdMinSeparation_);
+        noDarkRegion = raw == kNoDarkRegion;
+        if (raw >= 0) {
+            const double clamped = std::clamp(raw, kAdaptiveMinThreshold, kAdaptiveMaxThreshold);
+            smoothedThreshold_ = (smoothedThreshold_ < 0.0)
+                                     ? clamped
+                                     : smoothedThreshold_ + thresholdSmoothing_ * (clamped - smoothedThreshold_);
+        }
+        if (smoothedThreshold_ >= 0.0) options.blackThreshold = int(std::lround(smoothedThreshold_));
+
+        histogramMs_ += cost.nsecsElapsed() / 1e6;
+        cost.restart();
+    }
+    currentThreshold_.store(options.blackThreshold, std::memory_order_relaxed);
+
+    // Periodically check the pyramid result against full resolution
+    if (pyramidScale_ > 1 && pyramidValidationInterval_ > 0 &&
+        ++framesSinceValidation_ >= pyramidValidationInterval_)
+    {
+        framesSinceValidation_ = 0;
+        comparePyramid(latest_, options, pyramidReport_);
+        if (pyramidReport_.validatedFrames % 50 == 0) {
+            qCDebug(lcDetectorStats).nospace() << "[DarknessDetector] Pyramid 1/" << pyramidScale_
+                                               << " : IoU " << pyramidReport_.meanIoU
+                                               << ", max center err " << pyramidReport_.maxCenterErrPx << " px"
+                                               << ", disagreements " << pyramidReport_.disagreements
+                                               << "/" << pyramidReport_.validatedFrames
+                                               << ", " << pyramidReport_.meanPyramidMs << " ms vs "
+                                               << pyramidReport_.meanFullMs << " ms";
+        }
+    }
 
-    busy_ = true;
-    pending_ = false;
+    // Run sync detection on the worker thread; with no dark region there is nothing to label
+    // and the next hit is searched in the whole frame.
+    QVector<Detector::DetectedObject> res;
+    if (noDarkRegion) hasTrack_ = false;
+    else res = trackingEnabled_ ? detectTracked_(options) : detect(latest_, options);
+
+    if (cost.isValid()) {
+        detectMs_ += cost.nsecsElapsed() / 1e6;
+        if (++adaptiveFrames_ % 300 == 0) {
+            qCDebug(lcDetectorStats).nospace() << "[DarknessDetector] Adaptive threshold " << options.blackThreshold
+                                               << " : histogram " << histogramMs_ / adaptiveFrames_ << " ms/frame ("
+                                               << 100.0 * histogramMs_ / std::max(1e-9, detectMs_) << " % of detection)";
+        }
+    }
 
-    // Run sync detection on the worker thread
-    QVector<Detector::DetectedObject> res = detect(latest_, minAreaRatio_, blackThreshold_, whiteTopPct_, whiteRlPct_);
+    const int chosen = noDarkRegion ? kNoDarkRegion : options.blackThreshold;
+    if (chosen != emittedThreshold_) {
+        emittedThreshold_ = chosen;
+        emit thresholdChosen(chosen);
+    }
 
     // Emit to whoever connected (likely UI thread via queued connection)
-    emit detectionReady(res, latest_, scaleX_, scaleY_);
+    emit detectionReady(res, latest_, scaleX_, scaleY_, stampNs_);
+}
+
+QVector<Detector::DetectedObject> DarknessDetector::detectTracked_(const Options& options)
+{
+    const quint64 total = windowFrames_ + globalFrames_;
+    if (total > 0 && total % 300 == 0) {
+        qCDebug(lcDetectorStats).nospace() << "[DarknessDetector] Tracking window served "
+                                           << windowFrames_ << "/" << total << " frames ("
+                                           << (100.0 * windowFrames_ / total) << " %)";
+    }
+
+    // Try the window around the last result first
+    if (hasTrack_ && framesSinceGlobal_ < reacquireInterval_) {
+        ++framesSinceGlobal_;
+
+        const int marginX = std::max(kTrackingMinMarginPx, trackBox_.width()  / 2);
+        const int marginY = std::max(kTrackingMinMarginPx, trackBox_.height() / 2);
+        const QRect window = trackBox_.adjusted(-marginX, -marginY, marginX, marginY)
+                             & latest_.rect();
+
+        bool touchesEdge = false;
+        QVector<Detector::DetectedObject> res = detect(latest_, options, window, &touchesEdge);
+
+        // An empty result also covers "shrunk below minAreaRatio_"
+        if (!res.isEmpty() && !touchesEdge) {
+            ++windowFrames_;
+            trackBox_ = QRect(QPoint(res[0].x1, res[0].y1), QPoint(res[0].x2 - 1, res[0].y2 - 1));
+            return res;
+        }
+    }
 
-    busy_ = false;
+    // Global re-acquisition
+    ++globalFrames_;
+    framesSinceGlobal_ = 0;
 
-    // If a newer frame arrived while we were busy, process immediately again
-    if (pending_) {
-        QMetaObject::invokeMethod(this, "tryProcess_", Qt::QueuedConnection);
+    QVector<Detector::DetectedObject> res = detect(latest_, options);
+    hasTrack_ = !res.isEmpty();
+    if (hasTrack_) {
+        trackBox_ = QRect(QPoint(res[0].x1, res[0].y1), QPoint(res[0].x2 - 1, res[0].y2 - 1));
     }
+    return res;
 }
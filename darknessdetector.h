@@ -4,10 +4,15 @@
 #pragma once
 #include <QObject>
 #include <QImage>
+#include <QRect>
 #include <QVector>
 #include <QThread>
 #include <QString>
 
+#include <atomic>
+
+#include "latestslot.h"
+
 // ---- OpenCV forward decl to keep the header light ----
 namespace cv { class Mat; }
 
@@ -16,6 +21,7 @@ class Detector
     public :
     struct DetectedObject {
         int x1 = 0, y1 = 0, x2 = 0, y2 = 0;
+        float cx = 0.f, cy = 0.f;   // sub-pixel center (region centroid, or box center)
         int index = 0;
         int classifySize = 0;
         std::string name = "Path";
@@ -25,11 +31,14 @@ class Detector
 
 /**
  * Darkness detector:
- * - Synchronous: detect(QImage) -> largest black region
+ * - Synchronous: detect(QImage) -> largest black region(s) with sub-pixel centroids
  * - Asynchronous: start() / submitFrame() / detectionReady(...) on a private QThread
  *
  * Threading:
- *   - Asynchronous methods hop to the worker thread via invokeMethod.
+ *   - submitFrame() is a lock-free single-slot handoff (latest frame wins) that can be
+ *     called directly from the camera callback; the worker is woken only when the slot
+ *     goes from empty to full.
+ *   - Tunables hop to the worker thread via invokeMethod.
  *   - Do not touch Qt Widgets from detection callbacks; handle results on UI thread.
  */
 class DarknessDetector : public QObject, Detector
@@ -39,32 +48,125 @@ public:
     explicit DarknessDetector(QObject* parent = nullptr);
     ~DarknessDetector() override;
 
+    // How the async path picks blackThreshold for each frame.
+    enum class ThresholdMode : int {
+        Fixed = 0,      // setBlackThreshold()
+        Percentile = 1, // luma value below which `percentile` % of the pixels lie
+        Otsu = 2,       // Otsu's split of the luma histogram
+    };
+
+    // thresholdFromHistogram(): the darker class is not separated from the rest by
+    // minSeparation luma levels, i.e. the frame has no dark region (lumen out of view).
+    static constexpr int kNoDarkRegion = -2;
+
+    // Parameters of one synchronous detection.
+    struct Options {
+        float minAreaRatio = 0.01f;
+        int   blackThreshold = 30;
+        int   whiteMaskTopPct = 0;
+        int   whiteMaskRightLeftPct = 0;
+
+        // 1 = label the full-resolution mask.
+        // 2..8 = coarse-to-fine: label a 1/pyramidScale mask, then refine the
+        //        winning blob's bounding box at full resolution inside a small ROI.
+        int   pyramidScale = 1;
+
+        // 0 = cv::connectedComponentsWithStats.
+        // N = StripLabeler with N strips labeled in parallel (for large frames).
+        int   labelerStrips = 0;
+
+        // Up to maxResults regions, ranked by area * (1 - shapeWeight + shapeWeight * fill),
+        // where fill = area / bounding-box area. shapeWeight = 0 ranks by area only.
+        int   maxResults = 1;
+        float shapeWeight = 0.f;
+    };
+
+    // Accuracy/speed of the pyramid mode against full-resolution detection.
+    struct PyramidReport {
+        int    validatedFrames = 0;
+        int    disagreements   = 0;    // one side found a region, the other did not (IoU 0)
+        double meanIoU         = 0.0;
+        double maxCenterErrPx  = 0.0;
+        double meanPyramidMs   = 0.0;
+        double meanFullMs      = 0.0;
+    };
+
     // ---------- Synchronous API ----------
     QVector<DetectedObject> detect(const QImage& image,
                                    float minAreaRatio = 0.01f,
                                    int blackThreshold = 30,
                                    int whiteMaskTopPct = 0,
                                    int whiteMaskRightLeftPct = 0) const;
+    QVector<DetectedObject> detect(const QImage& image, const Options& options) const;
+
+    // Same, but only looks inside searchWindow (image coordinates).
+    // touchesWindowEdge reports whether the region was cut off by the window.
+    QVector<DetectedObject> detect(const QImage& image, const Options& options,
+                                   const QRect& searchWindow, bool* touchesWindowEdge) const;
+
+    // Luma histogram (256 bins) of every step-th pixel of every step-th row inside area.
+    // Channel order follows the conversion used for the mask.
+    static void lumaHistogram(const QImage& image, const QRect& area, int step, int hist[256]);
+    // -1 for an empty histogram, kNoDarkRegion when the split fails the separation check.
+    // Percentile always puts `percentile` % of the pixels below the threshold, so without the
+    // check it would report a "dark region" in every frame.
+    static int  thresholdFromHistogram(const int hist[256], ThresholdMode mode, float percentile,
+                                       int minSeparation = 0);
+
+    // Runs the pyramid and the full-resolution path on the same frame and accumulates into report.
+    void comparePyramid(const QImage& image, const Options& options, PyramidReport& report) const;
 
     // ---------- Asynchronous API ----------
     void start();  // start worker loop (idle until a frame is submitted)
     void stop();   // stop/pause worker loop
     void submitFrame(const QImage& image, float scaleX = 1.f, float scaleY = 1.f);
 
+    // Frames submitted while disabled are ignored (e.g. another detector is selected).
+    void setEnabled(bool on) { enabled_.store(on, std::memory_order_relaxed); }
+    bool isEnabled() const   { return enabled_.load(std::memory_order_relaxed); }
+
+    // Frames replaced in the slot before the worker picked them up.
+    quint64 droppedFrames() const { return mailbox_.dropped(); }
+
     // Tunables (effective for both sync/async; async updates are thread-safe via invoke)
     void setMinAreaRatio(float r);
     void setBlackThreshold(int t);
     void setWhiteMask(int topPct, int rightLeftPct);
+    void setPyramidScale(int scale);                 // 1 = off, typically 4 or 8
+    void setPyramidValidationInterval(int frames);   // 0 = off; every N frames also run full resolution
+    void setParallelLabeling(int strips);            // 0 = OpenCV (single-threaded), N = N parallel strips
+    void setMaxResults(int k, float shapeWeight = 0.f);
+
+    // Adaptive threshold: derived per frame from a subsampled luma histogram and
+    // smoothed over time (EMA, 0 < smoothing <= 1; 1 = no smoothing).
+    // Frames whose dark and bright classes lie less than minSeparation luma levels apart
+    // report no results (see kNoDarkRegion).
+    void setAdaptiveThreshold(ThresholdMode mode, float percentile = 5.f, float smoothing = 0.2f,
+                              int minSeparation = 40);
+    int  currentThreshold() const { return currentThreshold_.load(std::memory_order_relaxed); }
+
+    // Tracking: label only an expanded window around the previous result.
+    // Falls back to a full-frame search when the region touches the window edge,
+    // drops below the minimum area, or after reacquireEveryNFrames window frames.
+    void setTracking(bool on, int reacquireEveryNFrames = 30);
 
 signals:
     // Emitted on the UI thread side because we use QueuedConnection by default.
-    // results[0] is the black area with the largest area.
-    void detectionReady(QVector<DetectedObject> results, QImage source, float scaleX, float scaleY);
+    // results[0] is the best-ranked black area (the largest one unless a shape weight is set);
+    // cx/cy hold its moment-based sub-pixel centroid.
+    // frameStampNs: std::chrono::steady_clock time (ns) at which the frame was submitted.
+    void detectionReady(QVector<DetectedObject> results, QImage source, float scaleX, float scaleY, qint64 frameStampNs);
+
+    // The threshold in use changed (emitted before the detectionReady of that frame);
+    // kNoDarkRegion while the adaptive threshold finds no dark region.
+    void thresholdChosen(int threshold);
 
 private:
     // ---- Internal helpers (implemented in .cpp) ----
-    static cv::Mat qimageToCvBgrOrGray(const QImage& image);
-    static void coverWithWhiteMask(cv::Mat& img, int topPct, int rightLeftPct);
+    static cv::Mat qimageToGray(const QImage& image, const QRect& roi);
+    static QRect unmaskedArea(const QSize& size, int topPct, int rightLeftPct);
+
+    QVector<DetectedObject> detectTracked_(const Options& options); // worker thread
 
 private slots:
     // ---- Worker-thread slots ----
@@ -73,25 +175,72 @@ private slots:
     void setMinAreaRatioImpl(float r);
     void setBlackThresholdImpl(int t);
     void setWhiteMaskImpl(int topPct, int rlPct);
-    void submitFrameImpl(const QImage& img, float sx, float sy);
-    void tryProcess_();
+    void setPyramidScaleImpl(int scale);
+    void setPyramidValidationIntervalImpl(int frames);
+    void setParallelLabelingImpl(int strips);
+    void setMaxResultsImpl(int k, float shapeWeight);
+    void setAdaptiveThresholdImpl(int mode, float percentile, float smoothing, int minSeparation);
+    void setTrackingImpl(bool on, int reacquireEveryNFrames);
+    void processPending_();
 
 private:
     // ---- Worker-thread state ----
     QThread worker_;
-    bool running_ = false;
-    bool busy_    = false;
-    bool pending_ = false;
+    std::atomic<bool> running_{false};
+    std::atomic<bool> enabled_{true};
+
+    struct PendingFrame {
+        QImage image;
+        float  scaleX = 1.f;
+        float  scaleY = 1.f;
+        qint64 stampNs = 0;
+    };
+    LatestSlot<PendingFrame> mailbox_;
 
-    QImage latest_;
+    QImage latest_;   // frame being processed
     float  scaleX_ = 1.f;
     float  scaleY_ = 1.f;
+    qint64 stampNs_ = 0;
 
     // Tunables
     float minAreaRatio_ = 0.01f;
     int   blackThreshold_ = 30;
     int   whiteTopPct_ = 0;
     int   whiteRlPct_  = 0;
+    int   pyramidScale_ = 1;
+    int   labelerStrips_ = 0;
+    int   maxResults_ = 1;
+    float shapeWeight_ = 0.f;
+
+    // Pyramid validation (worker thread only)
+    int           pyramidValidationInterval_ = 0;
+    int           framesSinceValidation_ = 0;
+    PyramidReport pyramidReport_;
+
+    // Adaptive threshold (worker thread only, except currentThreshold_)
+    static constexpr int kAdaptiveMinThreshold = 5;
+    static constexpr int kAdaptiveMaxThreshold = 160;
+    static constexpr int kHistogramStep = 8;
+    ThresholdMode    thresholdMode_ = ThresholdMode::Fixed;
+    float            thresholdPercentile_ = 5.f;
+    float            thresholdSmoothing_ = 0.2f;
+    int              thresholdMinSeparation_ = 40;
+    int              emittedThreshold_ = -1;   // last thresholdChosen value
+    double           smoothedThreshold_ = -1.0;
+    std::atomic<int> currentThreshold_{30};
+    double           histogramMs_ = 0.0;   // accumulated, for the cost report
+    double           detectMs_ = 0.0;
+    quint64          adaptiveFrames_ = 0;
+
+    // Tracking (worker thread only)
+    static constexpr int kTrackingMinMarginPx = 16;
+    bool    trackingEnabled_ = false;
+    int     reacquireInterval_ = 30;
+    bool    hasTrack_ = false;
+    QRect   trackBox_;
+    int     framesSinceGlobal_ = 0;
+    quint64 windowFrames_ = 0;
+    quint64 globalFrames_ = 0;
 };
 
 #endif // DARKNESSDETECTOR_H
@@ -0,0 +1,500 @@
+#include "glvideoview.h"
+
+#include <QDebug>
+#include <QLoggingCategory>
+#include <QMutexLocker>
+#include <QOpenGLContext>
+#include <QOpenGLExtraFunctions>
+#include <QPainter>
+#include <QSurfaceFormat>
+#include <QVector2D>
+
+#include <algorithm>
+#include <cstring>
+
+#ifndef GL_PIXEL_UNPACK_BUFFER
+#define GL_PIXEL_UNPACK_BUFFER 0x88EC
+#endif
+#ifndef GL_MAP_WRITE_BIT
+#define GL_MAP_WRITE_BIT 0x0002
+#endif
+#ifndef GL_MAP_INVALIDATE_BUFFER_BIT
+#define GL_MAP_INVALIDATE_BUFFER_BIT 0x0008
+#endif
+
+// Frame timing report every kStatsWindow paints; off unless enabled, e.g.
+//   QT_LOGGING_RULES="bendemo.stats.video.debug=true"
+Q_LOGGING_CATEGORY(lcVideoStats, "bendemo.stats.video", QtInfoMsg)
+
+// ======================== Shaders ========================
+
+namespace {
+
+const char* kVideoVs = R"(
+attribute vec2 pos;
+attribute vec2 uv;
+varying vec2 vUv;
+void main() {
+    vUv = uv;
+    gl_Position = vec4(pos, 0.0, 1.0);
+}
+)";
+
+const char* kVideoFs = R"(
+#ifdef GL_ES
+precision mediump float;
+#endif
+uniform sampler2D tex;
+uniform bool swapRB;
+varying vec2 vUv;
+void main() {
+    vec4 c = texture2D(tex, vUv);
+    gl_FragColor = vec4(swapRB ? c.bgr : c.rgb, 1.0);
+}
+)";
+
+const char* kSolidVs = R"(
+attribute vec2 pos;
+uniform vec2 viewport;
+void main() {
+    gl_Position = vec4(pos.x / viewport.x * 2.0 - 1.0, 1.0 - pos.y / viewport.y * 2.0, 0.0, 1.0);
+}
+)";
+
+const char* kSolidFs = R"(
+#ifdef GL_ES
+precision mediump float;
+#endif
+uniform vec4 color;
+void main() {
+    gl_FragColor = color;
+}
+)";
+
+// Byte order of a 4-byte-per-pixel QImage, or -1 when it has to be converted.
+int byteOrderOf(QImage::Format f)
+{
+    switch (f) {
+    case QImage::Format_RGB32:
+    case QImage::Format_ARGB32:
+    case QImage::Format_ARGB32_Premultiplied:
+        return 1;   // B,G,R,A in memory (little endian)
+    case QImage::Format_RGBX8888:
+    case QImage::Format_RGBA8888:
+    case QImage::Format_RGBA8888_Premultiplied:
+        return 0;   // R,G,B,A
+    default:
+        return -1;
+    }
+}
+
+} // namespace
+
+// ======================== Public ========================
+
+GLVideoView::GLVideoView(QWidget* parent)
+    : QOpenGLWidget(parent)
+{
+    QSurfaceFormat fmt = format();
+    fmt.setSwapInterval(1);   // vsync
+    setFormat(fmt);
+    setUpdateBehavior(QOpenGLWidget::NoPartialUpdate);
+
+    font_ = QFont("Arial Black", 20, QFont::Bold);
+}
+
+GLVideoView::~GLVideoView()
+{
+    makeCurrent();
+    if (texture_) glDeleteTextures(1, &texture_);
+    if (extra_) {
+        QMutexLocker lock(&frameMutex_);
+        for (Staging& st : staging_) {
+            unmapStaging_(st);
+            glDeleteBuffers(1, &st.buffer);
+        }
+    }
+    doneCurrent();
+}
+
+bool GLVideoView::uploadsAsIs(const QImage& image)
+{
+    return byteOrderOf(image.format()) >= 0 && image.bytesPerLine() == image.width() * 4;
+}
+
+void GLVideoView::setFrame(const QImage& image)
+{
+    if (image.isNull()) return;
+
+    Staging* slot = nullptr;
+    {
+        QMutexLocker lock(&frameMutex_);
+        if (image.size() == stagingSize_ && uploadsAsIs(image)) {
+            for (Staging& st : staging_) {
+                if (st.state == Staging::Mapped && st.size == image.size()) { slot = &st; break; }
+            }
+            if (!slot) {
+                droppedFrames_.fetch_add(1, std::memory_order_relaxed);   // every buffer in flight
+                return;
+            }
+            slot->state = Staging::Writing;
+        } else {
+            // Plain upload during paint (first frame, size change, no streaming)
+            for (Staging& st : staging_) {
+                if (st.state == Staging::Ready) st.state = Staging::Mapped;   // superseded
+            }
+            pendingFrame_ = image;   // shallow; replaced frames are never uploaded
+            frameDirty_ = true;
+        }
+    }
+
+    if (slot) {
+        // The only per-pixel work, on the caller's thread
+        std::memcpy(slot->mapped, image.constBits(), size_t(image.sizeInBytes()));
+
+        QMutexLocker lock(&frameMutex_);
+        for (Staging& st : staging_) {
+            if (st.state == Staging::Ready) st.state = Staging::Mapped;   // superseded, never uploaded
+        }
+        slot->state  = Staging::Ready;
+        slot->swapRB = byteOrderOf(image.format()) == 1;
+        pendingFrame_ = QImage();
+        frameDirty_ = false;
+    }
+    requestUpdate_();
+}
+
+GLVideoView::FrameStats GLVideoView::stats() const
+{
+    FrameStats s = stats_;
+    s.dropped = droppedFrames_.load(std::memory_order_relaxed);
+    return s;
+}
+
+void GLVideoView::setBoxes(const QVector<Box>& boxes)
+{
+    if (boxes.isEmpty() && boxes_.isEmpty()) return;
+
+    // Keep prepared glyph layouts for captions that did not change
+    captions_.resize(boxes.size());
+    for (int i = 0; i < boxes.size(); ++i) {
+        if (i >= boxes_.size() || boxes_[i].caption != boxes[i].caption) {
+            captions_[i].setText(boxes[i].caption);
+            captions_[i].prepare(QTransform(), font_);
+        }
+    }
+    boxes_ = boxes;
+    update();
+}
+
+void GLVideoView::setCrosshairVisible(bool on)
+{
+    if (crosshair_ == on) return;
+    crosshair_ = on;
+    update();
+}
+
+void GLVideoView::setFontPoint(int pt)
+{
+    if (font_.pointSize() == pt) return;
+    font_.setPointSize(pt);
+    for (QStaticText& t : captions_) t.prepare(QTransform(), font_);
+    update();
+}
+
+// ======================== GL ========================
+
+void GLVideoView::initializeGL()
+{
+    initializeOpenGLFunctions();
+
+    videoProgram_.addShaderFromSourceCode(QOpenGLShader::Vertex, kVideoVs);
+    videoProgram_.addShaderFromSourceCode(QOpenGLShader::Fragment, kVideoFs);
+    videoProgram_.bindAttributeLocation("pos", 0);
+    videoProgram_.bindAttributeLocation("uv", 1);
+    if (!videoProgram_.link()) qWarning() << "[GLVideoView] video shader:" << videoProgram_.log();
+
+    solidProgram_.addShaderFromSourceCode(QOpenGLShader::Vertex, kSolidVs);
+    solidProgram_.addShaderFromSourceCode(QOpenGLShader::Fragment, kSolidFs);
+    solidProgram_.bindAttributeLocation("pos", 0);
+    if (!solidProgram_.link()) qWarning() << "[GLVideoView] solid shader:" << solidProgram_.log();
+
+    glGenTextures(1, &texture_);
+    glBindTexture(GL_TEXTURE_2D, texture_);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+    // Streaming needs glMapBufferRange (GL 3.0 / ARB_map_buffer_range / ES 3.0)
+    QOpenGLContext* ctx = context();
+    const QSurfaceFormat f = ctx->format();
+    streaming_ = ctx->isOpenGLES() ? f.majorVersion() >= 3
+                                   : (f.version() >= qMakePair(3, 0) || ctx->hasExtension("GL_ARB_map_buffer_range"));
+    if (streaming_) {
+        extra_ = ctx->extraFunctions();
+        for (Staging& st : staging_) glGenBuffers(1, &st.buffer);
+    } else {
+        qWarning() << "[GLVideoView] No glMapBufferRange, frames are uploaded from the GUI thread";
+    }
+
+    frameClock_.start();
+}
+
+void GLVideoView::requestUpdate_()
+{
+    // At most one queued update() per paint, whichever thread delivers the frames
+    if (updateQueued_.exchange(true, std::memory_order_acq_rel)) return;
+    QMetaObject::invokeMethod(this, [this]{
+        updateQueued_.store(false, std::memory_order_release);
+        update();
+    }, Qt::QueuedConnection);
+}
+
+void GLVideoView::unmapStaging_(Staging& st)
+{
+    // GUI thread with the context current and frameMutex_ held
+    if (!st.mapped) return;
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, st.buffer);
+    extra_->glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    st.mapped = nullptr;
+    st.state  = Staging::Idle;
+}
+
+void GLVideoView::mapStaging_()
+{
+    // Hand every idle buffer back to the producer, mapped at the current frame size
+    if (!streaming_ || !stagingSize_.isValid()) return;
+    const GLsizeiptr bytes = GLsizeiptr(stagingSize_.width()) * stagingSize_.height() * 4;
+
+    QMutexLocker lock(&frameMutex_);
+    for (Staging& st : staging_) {
+        if (st.state == Staging::Mapped && st.size != stagingSize_) unmapStaging_(st);   // left from a size change
+        if (st.state != Staging::Idle) continue;
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, st.buffer);
+        // Orphan: a texture upload still reading the old storage is not waited for
+        glBufferData(GL_PIXEL_UNPACK_BUFFER, bytes, nullptr, GL_STREAM_DRAW);
+        st.mapped = extra_->glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, bytes,
+                                             GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+        if (!st.mapped) {
+            qWarning() << "[GLVideoView] glMapBufferRange failed, streaming off";
+            stagingSize_ = QSize();
+            streaming_ = false;
+            break;
+        }
+        st.size  = stagingSize_;
+        st.state = Staging::Mapped;
+    }
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+}
+
+bool GLVideoView::uploadFrame_()
+{
+    QImage   img;
+    Staging* ready = nullptr;
+    {
+        QMutexLocker lock(&frameMutex_);
+        if (frameDirty_) {
+            img = pendingFrame_;
+            pendingFrame_ = QImage();
+            frameDirty_ = false;
+        }
+        for (Staging& st : staging_) {
+            if (st.state == Staging::Ready) { ready = &st; break; }
+        }
+        if (ready && ready->size != stagingSize_) {
+            unmapStaging_(*ready);   // filled at the previous size
+            ready = nullptr;
+        }
+        if (ready) ready->state = Staging::Idle;   // ours until it is mapped again
+    }
+
+    glBindTexture(GL_TEXTURE_2D, texture_);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+    if (ready) {
+        // Unmap and let the driver copy from the buffer; no pixels pass through this thread
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, ready->buffer);
+        extra_->glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+        ready->mapped = nullptr;
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, ready->size.width(), ready->size.height(),
+                        GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        swapRB_ = ready->swapRB;
+        frameSize_ = ready->size;
+        ++stats_.streamed;
+    } else if (!img.isNull()) {
+        if (!uploadsAsIs(img)) {
+            img = img.convertToFormat(QImage::Format_RGBA8888);   // fallback, costs GUI time
+        }
+        swapRB_ = (byteOrderOf(img.format()) == 1);
+        frameSize_ = img.size();
+
+        if (textureSize_ != img.size()) {
+            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, img.width(), img.height(), 0,
+                         GL_RGBA, GL_UNSIGNED_BYTE, img.constBits());
+            textureSize_ = img.size();
+        } else {
+            glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, img.width(), img.height(),
+                            GL_RGBA, GL_UNSIGNED_BYTE, img.constBits());
+        }
+
+        // Stream the following frames of this size
+        if (streaming_ && stagingSize_ != img.size()) {
+            QMutexLocker lock(&frameMutex_);
+            stagingSize_ = img.size();
+            for (Staging& st : staging_) {
+                if (st.state != Staging::Writing) unmapStaging_(st);   // remapped below at the new size
+            }
+        }
+    }
+
+    mapStaging_();
+    return ready || !img.isNull();
+}
+
+void GLVideoView::paintGL()
+{
+    QElapsedTimer paintTimer;
+    paintTimer.start();
+
+    const double frameMs = frameClock_.nsecsElapsed() / 1e6;
+    frameClock_.restart();
+
+    const qreal dpr = devicePixelRatioF();
+    const int W = width();
+    const int H = height();
+    glViewport(0, 0, int(W * dpr), int(H * dpr));
+    glDisable(GL_DEPTH_TEST);
+    glClearColor(1.f, 1.f, 1.f, 1.f);
+    glClear(GL_COLOR_BUFFER_BIT);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);   // QPainter may leave its VBO bound
+
+    // ---- Video ----
+    {
+        QElapsedTimer t;
+        t.start();
+        if (uploadFrame_()) {
+            windowUploadMs_ += t.nsecsElapsed() / 1e6;
+            ++windowUploads_;
+        }
+    }
+
+    if (textureSize_.isValid() && frameSize_.width() > 0 && frameSize_.height() > 0) {
+        // Letterbox: fit the frame into the canvas, centred
+        const float scale = std::min(float(W) / frameSize_.width(), float(H) / frameSize_.height());
+        const float hw = frameSize_.width()  * scale / W;   // half extent in NDC
+        const float hh = frameSize_.height() * scale / H;
+
+        const GLfloat quad[] = {
+            -hw, -hh, 0.f, 1.f,
+             hw, -hh, 1.f, 1.f,
+            -hw,  hh, 0.f, 0.f,
+             hw,  hh, 1.f, 0.f,
+        };
+
+        videoProgram_.bind();
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, texture_);
+        videoProgram_.setUniformValue("tex", 0);
+        videoProgram_.setUniformValue("swapRB", GLint(swapRB_ ? 1 : 0));
+        videoProgram_.enableAttributeArray(0);
+        videoProgram_.enableAttributeArray(1);
+        videoProgram_.setAttributeArray(0, GL_FLOAT, quad,     2, 4 * sizeof(GLfloat));
+        videoProgram_.setAttributeArray(1, GL_FLOAT, quad + 2, 2, 4 * sizeof(GLfloat));
+        glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+        videoProgram_.disableAttributeArray(0);
+        videoProgram_.disableAttributeArray(1);
+        videoProgram_.release();
+    }
+
+    // ---- Overlay primitives ----
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+    for (const Box& b : boxes_) {
+        QVector<float> outline;
+        appendOutline_(outline, b.rect, b.thickness);
+        drawTriangles_(outline, b.color);
+
+        QVector<float> plate;
+        appendRect_(plate, b.labelRect);
+        drawTriangles_(plate, b.color);
+    }
+
+    if (crosshair_) {
+        const float cx = W * 0.5f, cy = H * 0.5f, arm = 12.f, t = 1.f;
+        QVector<float> cross;
+        appendRect_(cross, QRectF(cx - arm, cy - t, 2 * arm, 2 * t));
+        appendRect_(cross, QRectF(cx - t, cy - arm, 2 * t, 2 * arm));
+        drawTriangles_(cross, QColor(255, 0, 0, 200));
+    }
+
+    // ---- Label text (QPainter glyph cache, same frame) ----
+    if (!boxes_.isEmpty()) {
+        QPainter p(this);
+        p.setFont(font_);
+        p.setPen(Qt::white);
+        for (int i = 0; i < boxes_.size() && i < captions_.size(); ++i) {
+            p.drawStaticText(boxes_[i].labelRect.topLeft() + QPointF(4, 2), captions_[i]);
+        }
+    }
+
+    // ---- Stats ----
+    const double paintMs = paintTimer.nsecsElapsed() / 1e6;
+    ++stats_.frames;
+    windowFrameMs_ += frameMs;
+    windowPaintMs_ += paintMs;
+    windowMaxMs_ = std::max(windowMaxMs_, frameMs);
+
+    if (++windowFrames_ >= kStatsWindow) {
+        stats_.uploads     += quint64(windowUploads_);
+        stats_.meanFrameMs  = windowFrameMs_ / windowFrames_;
+        stats_.maxFrameMs   = windowMaxMs_;
+        stats_.meanPaintMs  = windowPaintMs_ / windowFrames_;
+        stats_.meanUploadMs = windowUploads_ > 0 ? windowUploadMs_ / windowUploads_ : 0.0;
+
+        qCDebug(lcVideoStats) << "[GLVideoView] frame" << stats_.meanFrameMs << "ms (max" << stats_.maxFrameMs
+                              << "), paint" << stats_.meanPaintMs << "ms, upload" << stats_.meanUploadMs
+                              << "ms," << windowUploads_ << "uploads /" << windowFrames_ << "frames,"
+                              << frameSize_.width() << "x" << frameSize_.height() << "," << stats_.streamed
+                              << "streamed," << droppedFrames_.load(std::memory_order_relaxed) << "dropped";
+
+        windowFrameMs_ = windowPaintMs_ = windowUploadMs_ = windowMaxMs_ = 0.0;
+        windowFrames_ = windowUploads_ = 0;
+    }
+}
+
+// ======================== Helpers ========================
+
+void GLVideoView::drawTriangles_(const QVector<float>& xy, const QColor& color)
+{
+    if (xy.isEmpty()) return;
+    solidProgram_.bind();
+    solidProgram_.setUniformValue("viewport", QVector2D(float(width()), float(height())));
+    solidProgram_.setUniformValue("color", color);
+    solidProgram_.enableAttributeArray(0);
+    solidProgram_.setAttributeArray(0, GL_FLOAT, xy.constData(), 2);
+    glDrawArrays(GL_TRIANGLES, 0, GLsizei(xy.size() / 2));
+    solidProgram_.disableAttributeArray(0);
+    solidProgram_.release();
+}
+
+void GLVideoView::appendRect_(QVector<float>& xy, const QRectF& r)
+{
+    const float l = float(r.left()), t = float(r.top());
+    const float rr = float(r.right()), b = float(r.bottom());
+    xy << l << t  << rr << t << l << b
+       << rr << t << rr << b << l << b;
+}
+
+void GLVideoView::appendOutline_(QVector<float>& xy, const QRectF& r, float thickness)
+{
+    // Four bands centred on the edges, like a QPen of the same width
+    const qreal h = thickness * 0.5;
+    appendRect_(xy, QRectF(r.left() - h,  r.top() - h,    r.width() + 2 * h, 2 * h));  // top
+    appendRect_(xy, QRectF(r.left() - h,  r.bottom() - h, r.width() + 2 * h, 2 * h));  // bottom
+    appendRect_(xy, QRectF(r.left() - h,  r.top() + h,    2 * h, r.height() - 2 * h)); // left
+    appendRect_(xy, QRectF(r.right() - h, r.top() + h,    2 * h, r.height() - 2 * h)); // right
+}
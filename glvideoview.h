@@ -0,0 +1,142 @@
+#ifndef GLVIDEOVIEW_H
+#define GLVIDEOVIEW_H
+
+#pragma once
+#include <QColor>
+#include <QElapsedTimer>
+#include <QFont>
+#include <QImage>
+#include <QMutex>
+#include <QOpenGLFunctions>
+#include <QOpenGLShaderProgram>
+#include <QOpenGLWidget>
+#include <QRectF>
+#include <QStaticText>
+#include <QVector>
+
+#include <array>
+#include <atomic>
+
+class QOpenGLExtraFunctions;
+
+/**
+ * OpenGL video canvas: camera frame + detection overlay in one paint pass.
+ *
+ * - setFrame() may be called from any thread. The caller copies the frame into
+ *   one of a few mapped pixel unpack buffers (PBO) itself; paint only unmaps the
+ *   newest one and starts a glTexSubImage2D from it, so no pixel passes through the
+ *   GUI thread. Frames replaced before a paint are never uploaded.
+ * - The first frame, a size change, or a context without glMapBufferRange (GL < 3.0
+ *   without ARB_map_buffer_range, ES 2) falls back to a plain upload from the QImage
+ *   during paint. A frame that arrives while every buffer is busy is dropped.
+ * - 32-bit frames (RGB32 / ARGB32 / RGBA8888) are uploaded as-is; the shader
+ *   swizzles BGRA, so there is no CPU colour conversion or QPixmap.
+ *   Producers convert other formats themselves (see uploadsAsIs()), off the GUI thread.
+ * - Boxes, label plates and the centre crosshair are solid triangles; label
+ *   text is drawn by QPainter (glyph-cache atlas) on top in the same frame.
+ * - Repaints are requested with update(), so any number of frames arriving
+ *   between two window frames collapse into a single vsync-paced paint.
+ *
+ * Box coordinates are canvas pixels (0..width, 0..height).
+ * Timing is kept in stats() (refreshed every 300 paints) and logged only when the
+ * "bendemo.stats.video" logging category is enabled.
+ */
+class GLVideoView : public QOpenGLWidget, protected QOpenGLFunctions
+{
+    Q_OBJECT
+public:
+    struct Box {
+        QRectF  rect;
+        QRectF  labelRect;
+        QColor  color;
+        float   thickness = 1.0f;
+        QString caption;
+    };
+
+    struct FrameStats {
+        quint64 frames       = 0;
+        quint64 uploads      = 0;
+        quint64 streamed     = 0;     // uploads from a PBO filled by the producer
+        quint64 dropped      = 0;     // frames that found no free PBO
+        double  meanFrameMs  = 0.0;   // paint-to-paint interval
+        double  maxFrameMs   = 0.0;
+        double  meanPaintMs  = 0.0;   // CPU time inside paintGL (upload included)
+        double  meanUploadMs = 0.0;
+    };
+
+    explicit GLVideoView(QWidget* parent = nullptr);
+    ~GLVideoView() override;
+
+    // True when setFrame() can upload image without converting it on the GUI thread.
+    static bool uploadsAsIs(const QImage& image);
+
+    // Any thread; the copy into the PBO runs on the calling thread.
+    void setFrame(const QImage& image);
+    void setBoxes(const QVector<Box>& boxes);
+    void setCrosshairVisible(bool on);
+    void setFontPoint(int pt);
+
+    FrameStats stats() const;
+
+protected:
+    void initializeGL() override;
+    void paintGL() override;
+
+private:
+    // Pixel unpack buffer, handed between the producer and the GUI thread under frameMutex_
+    struct Staging {
+        enum State { Idle, Mapped, Writing, Ready };
+        State   state  = Idle;     // Idle: GUI owns it; Mapped: free for the producer
+        GLuint  buffer = 0;
+        void*   mapped = nullptr;
+        QSize   size;              // frame size the storage was mapped for
+        bool    swapRB = false;
+    };
+    static constexpr int kStagingBuffers = 3;
+
+    bool uploadFrame_();           // true if a frame was uploaded
+    void mapStaging_();
+    void unmapStaging_(Staging& s);
+    void requestUpdate_();
+    void drawTriangles_(const QVector<float>& xy, const QColor& color);
+    static void appendRect_(QVector<float>& xy, const QRectF& r);
+    static void appendOutline_(QVector<float>& xy, const QRectF& r, float thickness);
+
+private:
+    QOpenGLShaderProgram videoProgram_;
+    QOpenGLShaderProgram solidProgram_;
+    QOpenGLExtraFunctions* extra_ = nullptr;   // glMapBufferRange / glUnmapBuffer
+    GLuint texture_ = 0;
+    QSize  textureSize_;
+
+    // Guarded by frameMutex_ (producer thread and GUI)
+    mutable QMutex frameMutex_;
+    QImage pendingFrame_;          // newest frame for the plain upload path
+    bool   frameDirty_   = false;
+    std::array<Staging, kStagingBuffers> staging_;
+    QSize  stagingSize_;           // invalid = streaming off
+
+    std::atomic<bool>    updateQueued_{false};
+    std::atomic<quint64> droppedFrames_{0};
+    bool   streaming_    = false;  // context supports mapped PBOs (GUI thread)
+    bool   swapRB_       = false;  // texture holds BGRA bytes
+    QSize  frameSize_;
+
+    QVector<Box>         boxes_;
+    QVector<QStaticText> captions_;
+    QFont                font_;
+    bool                 crosshair_ = true;
+
+    // ---- Stats ----
+    FrameStats    stats_;
+    QElapsedTimer frameClock_;
+    double        windowFrameMs_  = 0.0;
+    double        windowPaintMs_  = 0.0;
+    double        windowUploadMs_ = 0.0;
+    double        windowMaxMs_    = 0.0;
+    int           windowFrames_   = 0;
+    int           windowUploads_  = 0;
+    static constexpr int kStatsWindow = 300;
+};
+
+#endif // GLVIDEOVIEW_H
@@ -1,6 +1,7 @@
 // ---------------------------------------- シリアル通信 ----------------------------------------
 
 #include "SerialComm.h"
+#include "TelemetrySchema.h"
 
 // シリアル通信用インスタンス
 SerialComm serialComm(Serial, 115200);
@@ -9,9 +10,24 @@ SerialComm serialComm(Serial, 115200);
 const size_t INPUT_BUFFER_SIZE{ 30 };
 uint8_t readDataBuffer_[INPUT_BUFFER_SIZE];
 
-const size_t OUTPUT_BUFFER_SIZE{ 22 };
+const size_t OUTPUT_BUFFER_SIZE{ TelemetryImage::LENGTH };
 uint8_t writeDataBuffer_[OUTPUT_BUFFER_SIZE];
 
+// 受信フレーム（v1: 30バイト固定 / v2: ヘッダ + 可変長ペイロード + CRC）
+uint8_t rxFrame_[64];
+
+// v2 テレメトリ: 受信直後に即応答、それ以外は一定周期
+const unsigned long TELEMETRY_INTERVAL_MS{ 20 };
+unsigned long lastTelemetryMs_{ 0 };
+bool replyPending_{ false };
+
+// ---------------------------------------- 機器識別 ----------------------------------------
+
+// 複数台を同時につなぐ場合は基板ごとに DEVICE_ID を変えて書き込む（0: 外管, 1: 内管）
+const uint8_t DEVICE_ID{ 0 };
+const uint8_t FIRMWARE_VERSION{ 3 };
+const char DEVICE_NAME[]{ "EquipmentController" };
+
 // ----------------------------------------  サーボモーター ----------------------------------------
 
 #include <Servo.h>
@@ -73,11 +89,12 @@ void setupMotors()
 void loop() 
 {
   guard.tick();  // Always call to monitor timeout
+  serialComm.tick();  // ボーレート切り替えのタイムアウト監視
 
   if (serialComm.isAvailable()) 
   {
-    size_t recievedLength = serialComm.receive(readDataBuffer_, INPUT_BUFFER_SIZE);
-    guard.ping();   // Notify the guard of communication
+    size_t recievedLength = serialComm.receive(rxFrame_, sizeof(rxFrame_));
+    if (recievedLength > 0) HandleFrame(rxFrame_, recievedLength);
   }
 
   /*
@@ -92,31 +109,125 @@ void loop()
   SerialWrite();
 }
 
+// v2 ならメッセージ種別ごとに処理、そうでなければ 30 バイト固定の v1 フレーム
+void HandleFrame(const uint8_t *frame, size_t length)
+{
+  SerialComm::Message msg;
+  if (serialComm.parseMessage(frame, length, msg))
+  {
+    if (msg.type == LinkV2::MSG_SET_MOTORS && msg.length >= 1)
+    {
+      // v1 と同じ位置に書き込む（OperateMotors はそのまま使える）
+      const uint8_t mask = msg.payload[0];
+      uint8_t index = 1;
+      for (int motorIndex = 0; motorIndex < kMotors; motorIndex++)
+      {
+        if (!(mask & (1 << motorIndex))) continue;
+        if (index + 2 > msg.length) break;
+        readDataBuffer_[motorIndex * 2]     = msg.payload[index];
+        readDataBuffer_[motorIndex * 2 + 1] = msg.payload[index + 1];
+        index += 2;
+      }
+    }
+    else if (msg.type == LinkV2::MSG_PING)
+    {
+      // 回線ベンチマーク用: すぐに同じ内容を返す
+      serialComm.sendMessage(LinkV2::MSG_PONG, msg.payload, msg.length);
+    }
+    else if (msg.type == LinkV2::MSG_IDENTIFY)
+    {
+      // ホストの機器検出用
+      uint8_t info[2 + sizeof(DEVICE_NAME) - 1];
+      info[0] = DEVICE_ID;
+      info[1] = FIRMWARE_VERSION;
+      memcpy(info + 2, DEVICE_NAME, sizeof(DEVICE_NAME) - 1);
+      serialComm.sendMessage(LinkV2::MSG_INFO, info, sizeof(info));
+    }
+    else if ((msg.type == LinkV2::MSG_BAUD_PROPOSE || msg.type == LinkV2::MSG_BAUD_COMMIT) && msg.length >= 4)
+    {
+      const unsigned long baud = ((unsigned long)msg.payload[0] << 24) | ((unsigned long)msg.payload[1] << 16)
+                               | ((unsigned long)msg.payload[2] << 8)  |  (unsigned long)msg.payload[3];
+      uint8_t ack[5] = { msg.payload[0], msg.payload[1], msg.payload[2], msg.payload[3], 0 };
+
+      if (msg.type == LinkV2::MSG_BAUD_PROPOSE)
+      {
+        ack[4] = SerialComm::isSupportedBaud(baud) ? 1 : 0;
+        serialComm.sendMessage(LinkV2::MSG_BAUD_ACK, ack, sizeof(ack));
+        if (ack[4] == 1) serialComm.beginBaudSwitch(baud);
+      }
+      else
+      {
+        ack[4] = serialComm.commitBaud(baud) ? 2 : 0;
+        serialComm.sendMessage(LinkV2::MSG_BAUD_ACK, ack, sizeof(ack));
+      }
+    }
+
+    // シーケンス番号は v1 と同じ位置に保存してエコーする
+    readDataBuffer_[28] = (uint8_t)(msg.seq >> 8);
+    readDataBuffer_[29] = (uint8_t)(msg.seq & 0xFF);
+
+    serialComm.countFrame();
+    // PING / IDENTIFY はそれぞれ PONG / INFO が応答
+    if (msg.type != LinkV2::MSG_PING && msg.type != LinkV2::MSG_IDENTIFY) replyPending_ = true;
+    guard.ping();   // Notify the guard of communication
+  }
+  else if (length == INPUT_BUFFER_SIZE)
+  {
+    memcpy(readDataBuffer_, frame, INPUT_BUFFER_SIZE);
+    serialComm.countFrame();
+    guard.ping();   // Notify the guard of communication
+  }
+  else
+  {
+    serialComm.countError();
+  }
+}
+
+void SerialWriteV2()
+{
+  if(subcounter_++ == 255) counter_++;
+
+  const unsigned long now = millis();
+  if (!replyPending_ && now - lastTelemetryMs_ < TELEMETRY_INTERVAL_MS) return;
+  replyPending_ = false;
+  lastTelemetryMs_ = now;
+
+  // 配置は TelemetrySchema.h
+  uint8_t telemetry[TelemetryV2::LENGTH];
+  telemetry[TelemetryV2::counter]      = (counter_ % 256);
+  telemetry[TelemetryV2::echoSeq]      = readDataBuffer_[28];
+  telemetry[TelemetryV2::echoSeq + 1]  = readDataBuffer_[29];
+  for (int i = 0; i < 6; i++) telemetry[TelemetryV2::roll + i] = rpyBytes[i];
+  telemetry[TelemetryV2::rxFrames]     = (uint8_t)(serialComm.rxFrames() >> 8);
+  telemetry[TelemetryV2::rxFrames + 1] = (uint8_t)(serialComm.rxFrames() & 0xFF);
+  telemetry[TelemetryV2::rxErrors]     = (uint8_t)(serialComm.rxErrors() >> 8);
+  telemetry[TelemetryV2::rxErrors + 1] = (uint8_t)(serialComm.rxErrors() & 0xFF);
+
+  serialComm.sendMessage(LinkV2::MSG_TELEMETRY, telemetry, sizeof(telemetry));
+}
+
 void SerialWrite() 
 {
-  // 値の割当て
-  writeDataBuffer_[0] = (counter_ % 256);
-  writeDataBuffer_[1] = readDataBuffer_[0];
-  writeDataBuffer_[2] = readDataBuffer_[1];
-  writeDataBuffer_[3] = readDataBuffer_[2];
-  writeDataBuffer_[4] = readDataBuffer_[3];
-  writeDataBuffer_[5] = rpyBytes[0];
-  writeDataBuffer_[6] = rpyBytes[1];
-  writeDataBuffer_[7] = rpyBytes[2];
-  writeDataBuffer_[8] = rpyBytes[3];
-  writeDataBuffer_[9] = rpyBytes[4];
-  writeDataBuffer_[10] = rpyBytes[5];
-  writeDataBuffer_[11] = 0x00;
-  writeDataBuffer_[12] = 0x00;
-  writeDataBuffer_[13] = 0x00;
-  writeDataBuffer_[14] = 0x00;
-  writeDataBuffer_[15] = 0x00;
-  writeDataBuffer_[16] = 0x00;
-  writeDataBuffer_[17] = 0x00;
-  writeDataBuffer_[18] = 0x00;
-  writeDataBuffer_[19] = 0x00;
-  writeDataBuffer_[20] = 0x00;
-  writeDataBuffer_[21] = 0x00;
+  if (serialComm.useV2())
+  {
+    SerialWriteV2();
+    return;
+  }
+
+  // 値の割当て（配置は TelemetrySchema.h）
+  memset(writeDataBuffer_, 0, OUTPUT_BUFFER_SIZE);
+  writeDataBuffer_[TelemetryImage::counter]        = (counter_ % 256);
+  writeDataBuffer_[TelemetryImage::motor0Echo]     = readDataBuffer_[0];
+  writeDataBuffer_[TelemetryImage::motor0Echo + 1] = readDataBuffer_[1];
+  writeDataBuffer_[TelemetryImage::motor1Echo]     = readDataBuffer_[2];
+  writeDataBuffer_[TelemetryImage::motor1Echo + 1] = readDataBuffer_[3];
+  for (int i = 0; i < 6; i++) writeDataBuffer_[TelemetryImage::roll + i] = rpyBytes[i];
+  writeDataBuffer_[TelemetryImage::echoSeq]        = readDataBuffer_[28];  // シーケンス番号のエコー（往復遅延の計測用）
+  writeDataBuffer_[TelemetryImage::echoSeq + 1]    = readDataBuffer_[29];
+  writeDataBuffer_[TelemetryImage::fwRxFrames]     = (uint8_t)(serialComm.rxFrames() >> 8);
+  writeDataBuffer_[TelemetryImage::fwRxFrames + 1] = (uint8_t)(serialComm.rxFrames() & 0xFF);
+  writeDataBuffer_[TelemetryImage::fwRxErrors]     = (uint8_t)(serialComm.rxErrors() >> 8);
+  writeDataBuffer_[TelemetryImage::fwRxErrors + 1] = (uint8_t)(serialComm.rxErrors() & 0xFF);
   
   if(subcounter_++ == 255) counter_++;
 
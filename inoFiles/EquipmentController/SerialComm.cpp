@@ -21,6 +21,7 @@ size_t SerialComm::receive(uint8_t *buffer, size_t length)
 {
     static uint8_t receiveBuffer[64]; // 受信データの一時保存用
     static size_t bufferIndex = 0;   // 現在のバッファ位置
+    static bool overflowed = false;  // 終端前にバッファが溢れた
 
     // シリアルからデータを読み込む
     while (serial.available())
@@ -30,14 +31,22 @@ size_t SerialComm::receive(uint8_t *buffer, size_t length)
         if (byte == 0x00)
         {
             // COBSパケットの終端に到達
-            // デコードしたデータを返す
-            decode(receiveBuffer, bufferIndex, buffer);
+            const size_t encodedLength = bufferIndex;
+            const bool   broken = overflowed || encodedLength < 2 || encodedLength - 1 > length;
 
             // バッファをリセット
             bufferIndex = 0;
+            overflowed = false;
 
-            // デコード結果の長さを返す
-            return bufferIndex;
+            if (broken)
+            {
+                if (encodedLength > 0) rxErrors_++;
+                continue;
+            }
+
+            // デコードしたデータを返す（デコード後の長さ = エンコード長 - 1）
+            decode(receiveBuffer, encodedLength, buffer);
+            return encodedLength - 1;
         }
         else
         {
@@ -46,6 +55,10 @@ size_t SerialComm::receive(uint8_t *buffer, size_t length)
             {
                 receiveBuffer[bufferIndex++] = byte;
             }
+            else
+            {
+                overflowed = true;
+            }
         }
     }
 
@@ -53,6 +66,107 @@ size_t SerialComm::receive(uint8_t *buffer, size_t length)
     return 0;
 }
 
+// ---------------------------------------- v2 ----------------------------------------
+
+bool SerialComm::parseMessage(const uint8_t *frame, size_t length, Message &out)
+{
+    using namespace LinkV2;
+    if (length < HEADER_LEN + CRC_LEN || frame[0] != VERSION) return false;
+
+    const uint8_t payloadLength = frame[4];
+    if (payloadLength > MAX_PAYLOAD || (size_t)(HEADER_LEN + payloadLength + CRC_LEN) != length) return false;
+
+    const uint16_t crc = ((uint16_t)frame[HEADER_LEN + payloadLength] << 8) | frame[HEADER_LEN + payloadLength + 1];
+    if (crc16(frame, HEADER_LEN + payloadLength) != crc) return false;
+
+    out.type    = frame[1];
+    out.seq     = ((uint16_t)frame[2] << 8) | frame[3];
+    out.payload = frame + HEADER_LEN;
+    out.length  = payloadLength;
+
+    useV2_ = true;
+    return true;
+}
+
+size_t SerialComm::sendMessage(uint8_t type, const uint8_t *payload, uint8_t length)
+{
+    using namespace LinkV2;
+    if (length > MAX_PAYLOAD) return 0;
+
+    uint8_t frame[HEADER_LEN + MAX_PAYLOAD + CRC_LEN];
+
+    if (++txSeq_ == 0) ++txSeq_;   // 0 は「未送信」を意味するので使わない
+    frame[0] = VERSION;
+    frame[1] = type;
+    frame[2] = (uint8_t)(txSeq_ >> 8);
+    frame[3] = (uint8_t)(txSeq_ & 0xFF);
+    frame[4] = length;
+    for (uint8_t i = 0; i < length; i++) frame[HEADER_LEN + i] = payload[i];
+
+    const uint16_t crc = crc16(frame, HEADER_LEN + length);
+    frame[HEADER_LEN + length]     = (uint8_t)(crc >> 8);
+    frame[HEADER_LEN + length + 1] = (uint8_t)(crc & 0xFF);
+
+    return send(frame, HEADER_LEN + length + CRC_LEN);
+}
+
+// ---------------------------------------- ボーレート ----------------------------------------
+
+// 16MHz の AVR で誤差の小さいレートのみ
+bool SerialComm::isSupportedBaud(unsigned long baud)
+{
+    switch (baud)
+    {
+        case 115200: case 230400: case 250000: case 500000: case 1000000: case 2000000:
+            return true;
+        default:
+            return false;
+    }
+}
+
+void SerialComm::beginBaudSwitch(unsigned long baud)
+{
+    if (!baudPending_) previousBaud_ = baudRate;
+    serial.flush();   // ACK を旧レートで送り切る
+    serial.begin(baud);
+    baudRate = baud;
+    switchedAtMs_ = millis();
+    baudPending_ = true;
+}
+
+bool SerialComm::commitBaud(unsigned long baud)
+{
+    if (baud != baudRate) return false;
+    baudPending_ = false;
+    return true;
+}
+
+void SerialComm::tick()
+{
+    if (!baudPending_ || millis() - switchedAtMs_ < LinkV2::BAUD_REVERT_MS) return;
+
+    // 新しいレートで確定されなかった → 元に戻す
+    serial.flush();
+    serial.begin(previousBaud_);
+    baudRate = previousBaud_;
+    baudPending_ = false;
+}
+
+// CRC-16/CCITT-FALSE（多項式 0x1021, 初期値 0xFFFF）
+uint16_t SerialComm::crc16(const uint8_t *data, size_t length)
+{
+    uint16_t crc = 0xFFFF;
+    for (size_t i = 0; i < length; i++)
+    {
+        crc ^= (uint16_t)data[i] << 8;
+        for (uint8_t b = 0; b < 8; b++)
+        {
+            crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+        }
+    }
+    return crc;
+}
+
 // 受信可能か確認
 bool SerialComm::isAvailable() {
     return serial.available() > 0;
@@ -97,7 +211,7 @@ void SerialComm::decode(const uint8_t *encodedBuffer, size_t size, uint8_t *deco
     if (size == 0) return;
 
     int zeroIndex = encodedBuffer[0] - 1;
-    for (int i = 0; i < (int)size - 2; i++)
+    for (int i = 0; i < (int)size - 1; i++)  // デコード後の長さ = エンコード長 - 1
     {
         if (i == zeroIndex)
         {
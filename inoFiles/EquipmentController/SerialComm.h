@@ -3,22 +3,84 @@
 
 #include <Arduino.h>
 
+// プロトコル v2（COBSフレームの中身）
+//   [0] バージョン(0x02) [1] 種別 [2..3] シーケンス番号 [4] 長さN [5..5+N) ペイロード [5+N..5+N+2) CRC16
+// v1（固定長・ヘッダなし）のフレームも同じ回線でそのまま受け付ける。
+// ホスト側の定義は linkprotocol.h（値を変える場合は両方を合わせること）
+namespace LinkV2 {
+    const uint8_t VERSION     = 0x02;
+    const uint8_t HEADER_LEN  = 5;
+    const uint8_t CRC_LEN     = 2;
+    const uint8_t MAX_PAYLOAD = 32;
+
+    const uint8_t MSG_SET_MOTORS  = 0x01;   // [mask] + 角度x10 (2バイト) x ビット数
+    const uint8_t MSG_HEARTBEAT   = 0x02;   // ペイロードなし
+    const uint8_t MSG_BAUD_PROPOSE = 0x03;  // baud(4) → BAUD_ACK を返してから切り替え
+    const uint8_t MSG_BAUD_COMMIT = 0x04;   // baud(4) → 確定（来なければ元のレートに戻す）
+    const uint8_t MSG_PING        = 0x05;   // 任意 → 同じ内容を PONG で返す
+    const uint8_t MSG_IDENTIFY    = 0x06;   // ペイロードなし → INFO を返す
+    const uint8_t MSG_TELEMETRY   = 0x81;   // counter, echoSeq(2), rpy(6), rxFrames(2), rxErrors(2)
+    const uint8_t MSG_BAUD_ACK    = 0x82;   // baud(4), status(0:拒否 1:切替中 2:確定)
+    const uint8_t MSG_PONG        = 0x83;
+    const uint8_t MSG_INFO        = 0x84;   // deviceId, firmwareVersion, 名前(ASCII)
+
+    const unsigned long BAUD_REVERT_MS = 500;   // ホスト側 SerialInterface::kBaudRevertMs と合わせる
+}
+
 class SerialComm {
     public:
+        struct Message {
+            uint8_t        type;
+            uint16_t       seq;
+            const uint8_t *payload;
+            uint8_t        length;
+        };
+
         SerialComm(HardwareSerial &serial, unsigned long baudRate = 115200);
 
         void begin();
 
         size_t send(const uint8_t *data, size_t length);
 
+        // 1フレーム受信できたらデコード後の長さを返す（未完了・不正なら0）
         size_t receive(uint8_t *buffer, size_t length);
 
         bool isAvailable();
 
+        // v2
+        bool   parseMessage(const uint8_t *frame, size_t length, Message &out);
+        size_t sendMessage(uint8_t type, const uint8_t *payload, uint8_t length);
+        static uint16_t crc16(const uint8_t *data, size_t length);
+
+        // 受信統計（v1/v2 共通）
+        uint16_t rxFrames() const { return rxFrames_; }
+        uint16_t rxErrors() const { return rxErrors_; }
+        void     countFrame() { rxFrames_++; }
+        void     countError() { rxErrors_++; }
+
+        // 一度でも v2 を受信したら応答も v2 にする
+        bool     useV2() const { return useV2_; }
+
+        // ボーレート切り替え（送信済みデータを出し切ってから）
+        static bool isSupportedBaud(unsigned long baud);
+        void beginBaudSwitch(unsigned long baud);
+        bool commitBaud(unsigned long baud);
+        void tick();   // 確定されないまま BAUD_REVERT_MS 経過したら元のレートに戻す
+        unsigned long baud() const { return baudRate; }
+
     private:
         HardwareSerial &serial;
         unsigned long baudRate;
 
+        uint16_t txSeq_{ 0 };
+        uint16_t rxFrames_{ 0 };
+        uint16_t rxErrors_{ 0 };
+        bool     useV2_{ false };
+
+        unsigned long previousBaud_{ 0 };
+        unsigned long switchedAtMs_{ 0 };
+        bool          baudPending_{ false };
+
         // COBSエンコード
         void encode(const uint8_t *buffer, size_t size, uint8_t *encodedBuffer);
 
@@ -0,0 +1,52 @@
+#ifndef TELEMETRYSCHEMA_H
+#define TELEMETRYSCHEMA_H
+
+#include <stdint.h>
+
+// テレメトリのフィールド定義（ファームウェアとホストの唯一の定義元）
+//   ホスト側は telemetryview.h がこのファイルを取り込み、型付きビューを生成する。
+//   フィールドを追加・変更する場合はここだけを書き換えること。
+//
+// X(名前, オフセット, 型, 倍率, 単位)
+//   型: U8 / U16 / I16（2バイトはビッグエンディアン）  物理値 = 生値 * 倍率
+
+// 22 バイトの固定長イメージ（v1 の上りフレームそのもの。v2 はホスト側でこの形に戻す）
+#define TELEMETRY_IMAGE_FIELDS(X)                         \
+    X(counter,    0,  U8,  1.0,  "")    /* ループカウンタ */ \
+    X(motor0Echo, 1,  U16, 0.1,  "deg") /* v1 のみ */        \
+    X(motor1Echo, 3,  U16, 0.1,  "deg") /* v1 のみ */        \
+    X(roll,       5,  I16, 0.01, "deg")                      \
+    X(pitch,      7,  I16, 0.01, "deg")                      \
+    X(yaw,        9,  I16, 0.01, "deg")                      \
+    X(echoSeq,    11, U16, 1.0,  "")    /* 往復遅延の計測用 */ \
+    X(fwRxFrames, 13, U16, 1.0,  "")                         \
+    X(fwRxErrors, 15, U16, 1.0,  "")
+
+#define TELEMETRY_IMAGE_LENGTH 22
+
+// v2 TELEMETRY メッセージのペイロード
+#define TELEMETRY_V2_FIELDS(X)             \
+    X(counter,    0,  U8,  1.0,  "")       \
+    X(echoSeq,    1,  U16, 1.0,  "")       \
+    X(roll,       3,  I16, 0.01, "deg")    \
+    X(pitch,      5,  I16, 0.01, "deg")    \
+    X(yaw,        7,  I16, 0.01, "deg")    \
+    X(rxFrames,   9,  U16, 1.0,  "")       \
+    X(rxErrors,   11, U16, 1.0,  "")
+
+#define TELEMETRY_V2_LENGTH 13
+
+// オフセット定数（ファームウェアはこれで書き込む）
+#define TELEMETRY_OFFSET_ENUM(name, offset, type, scale, unit) name = offset,
+
+namespace TelemetryImage {
+    enum Offset : uint8_t { TELEMETRY_IMAGE_FIELDS(TELEMETRY_OFFSET_ENUM) LENGTH = TELEMETRY_IMAGE_LENGTH };
+}
+
+namespace TelemetryV2 {
+    enum Offset : uint8_t { TELEMETRY_V2_FIELDS(TELEMETRY_OFFSET_ENUM) LENGTH = TELEMETRY_V2_LENGTH };
+}
+
+#undef TELEMETRY_OFFSET_ENUM
+
+#endif // TELEMETRYSCHEMA_H
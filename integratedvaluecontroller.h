@@ -30,6 +30,8 @@ public:
     void   updateValue(bool isPositive = true);
     void   addValue(double addedValue);
     double value() const;
+    double minimum() const { return min_; }
+    double maximum() const { return max_; }
     QByteArray valueAsBytes();
 
     void setSingleStep(double step);     // sets spin step & adjusts slider scale
@@ -0,0 +1,65 @@
+#ifndef LATESTSLOT_H
+#define LATESTSLOT_H
+
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+/**
+ * Lock-free single-slot "latest value wins" handoff between threads.
+ *
+ * Usage:
+ *   LatestSlot<Frame> slot;
+ *   // producer
+ *   if (slot.publish(frame)) wakeConsumer();   // true = slot was empty
+ *   // consumer
+ *   if (auto f = slot.take()) process(*f);
+ *
+ * - publish() replaces an unconsumed value (counted in dropped()).
+ * - A wakeup only has to be posted when publish() returns true, so the
+ *   consumer's event queue never holds more than one pending wakeup.
+ */
+template <class T>
+class LatestSlot
+{
+public:
+    LatestSlot() = default;
+    ~LatestSlot() { delete slot_.exchange(nullptr, std::memory_order_acquire); }
+
+    LatestSlot(const LatestSlot&) = delete;
+    LatestSlot& operator=(const LatestSlot&) = delete;
+
+    bool publish(T value)
+    {
+        T* fresh = new T(std::move(value));
+        published_.fetch_add(1, std::memory_order_relaxed);
+
+        T* old = slot_.exchange(fresh, std::memory_order_acq_rel);
+        if (old) {
+            delete old;
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        return true;
+    }
+
+    std::unique_ptr<T> take()
+    {
+        return std::unique_ptr<T>(slot_.exchange(nullptr, std::memory_order_acq_rel));
+    }
+
+    void clear() { delete slot_.exchange(nullptr, std::memory_order_acq_rel); }
+
+    bool     hasValue()  const { return slot_.load(std::memory_order_acquire) != nullptr; }
+    uint64_t published() const { return published_.load(std::memory_order_relaxed); }
+    uint64_t dropped()   const { return dropped_.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<T*>       slot_{nullptr};
+    std::atomic<uint64_t> published_{0};
+    std::atomic<uint64_t> dropped_{0};
+};
+
+#endif // LATESTSLOT_H
@@ -0,0 +1,67 @@
+#include "linkprotocol.h"
+
+#include <cstring>
+
+namespace LinkProtocol
+{
+
+// Poly 0x1021, init 0xFFFF, no reflection, no final xor (same bitwise loop as the firmware)
+uint16_t crc16(const uint8_t* data, size_t n)
+{
+    uint16_t crc = 0xFFFF;
+    for (size_t i = 0; i < n; ++i) {
+        crc ^= uint16_t(data[i]) << 8;
+        for (int b = 0; b < 8; ++b) {
+            crc = (crc & 0x8000) ? uint16_t((crc << 1) ^ 0x1021) : uint16_t(crc << 1);
+        }
+    }
+    return crc;
+}
+
+size_t build(MsgType type, uint16_t seq, const uint8_t* payload, size_t len, uint8_t* out)
+{
+    if (len > kMaxPayload) return 0;
+
+    out[0] = kVersion2;
+    out[1] = uint8_t(type);
+    out[2] = uint8_t(seq >> 8);
+    out[3] = uint8_t(seq & 0xFF);
+    out[4] = uint8_t(len);
+    if (len > 0) std::memcpy(out + kHeaderLen, payload, len);
+
+    const uint16_t crc = crc16(out, kHeaderLen + len);
+    out[kHeaderLen + len]     = uint8_t(crc >> 8);
+    out[kHeaderLen + len + 1] = uint8_t(crc & 0xFF);
+    return kOverhead + len;
+}
+
+ParseResult parse(const uint8_t* frame, size_t n, Message& out)
+{
+    if (n < kOverhead || frame[0] != kVersion2) return ParseResult::NotV2;
+
+    const size_t len = frame[4];
+    if (len > kMaxPayload || kOverhead + len != n) return ParseResult::BadLength;
+
+    const uint16_t crc = uint16_t((frame[kHeaderLen + len] << 8) | frame[kHeaderLen + len + 1]);
+    if (crc16(frame, kHeaderLen + len) != crc) return ParseResult::BadCrc;
+
+    out.type    = MsgType(frame[1]);
+    out.seq     = uint16_t((frame[2] << 8) | frame[3]);
+    out.payload = frame + kHeaderLen;
+    out.len     = len;
+    return ParseResult::Ok;
+}
+
+size_t buildSetMotors(uint8_t mask, const uint8_t* image, uint8_t* out)
+{
+    size_t o = 0;
+    out[o++] = mask;
+    for (int i = 0; i < kMotorCount; ++i) {
+        if (!(mask & (1u << i))) continue;
+        out[o++] = image[2 * i];
+        out[o++] = image[2 * i + 1];
+    }
+    return o;
+}
+
+} // namespace LinkProtocol
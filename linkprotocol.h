@@ -0,0 +1,115 @@
+#ifndef LINKPROTOCOL_H
+#define LINKPROTOCOL_H
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+#include "inoFiles/EquipmentController/TelemetrySchema.h"
+
+/**
+ * Serial link protocol v2 (inside the COBS frame, before encoding):
+ *
+ *   [0] version (0x02)
+ *   [1] message type
+ *   [2] sequence number, high byte     (per direction, wraps, 0 is skipped)
+ *   [3] sequence number, low byte
+ *   [4] payload length N
+ *   [5 .. 5+N)   payload
+ *   [5+N, 5+N+2) CRC-16/CCITT-FALSE over bytes [0, 5+N), big endian
+ *
+ * v1 frames (fixed 30 bytes down / 22 up, no header) stay valid on the same link.
+ * A frame is v2 only if the version byte, the length field and the CRC all agree, so
+ * a v1 frame is taken for v2 with a probability of about 2^-16 / 256 per frame.
+ *
+ * Messages:
+ *   SetMotors  (host -> fw)  [mask] + 2 bytes (angle * 10, big endian) per set bit
+ *   Heartbeat  (host -> fw)  empty; keeps the PowerGuard fed
+ *   BaudPropose(host -> fw)  baud (u32); fw answers BaudAck, then switches its UART
+ *   BaudCommit (host -> fw)  baud (u32); keeps the new rate (fw reverts after 500 ms without it)
+ *   Ping       (host -> fw)  any payload; fw answers Pong with the same bytes
+ *   Identify   (host -> fw)  empty; fw answers Info
+ *   Telemetry  (fw -> host)  see TelemetryLayout
+ *   BaudAck    (fw -> host)  baud (u32) + BaudStatus
+ *   Pong       (fw -> host)  copy of the Ping payload
+ *   Info       (fw -> host)  see InfoLayout
+ *
+ * The firmware side lives in inoFiles/EquipmentController/SerialComm.
+ */
+namespace LinkProtocol
+{
+    constexpr uint8_t kVersion2   = 0x02;
+    constexpr size_t  kHeaderLen  = 5;
+    constexpr size_t  kCrcLen     = 2;
+    constexpr size_t  kOverhead   = kHeaderLen + kCrcLen;
+    constexpr size_t  kMaxPayload = 32;
+    constexpr size_t  kMaxFrame   = kOverhead + kMaxPayload;
+
+    constexpr int     kMotorCount = 6;   // 2 bytes each at the start of the v1 TX image
+
+    enum class MsgType : uint8_t {
+        SetMotors   = 0x01,
+        Heartbeat   = 0x02,
+        BaudPropose = 0x03,
+        BaudCommit  = 0x04,
+        Ping        = 0x05,
+        Identify    = 0x06,
+        Telemetry   = 0x81,
+        BaudAck     = 0x82,
+        Pong        = 0x83,
+        Info        = 0x84,
+    };
+
+    enum class BaudStatus : uint8_t {
+        Rejected  = 0,   // rate not supported; nothing changes
+        Switching = 1,   // fw switches after this frame; reverts unless committed
+        Committed = 2,
+    };
+
+    inline void     putU32(uint8_t* p, uint32_t v) { p[0] = uint8_t(v >> 24); p[1] = uint8_t(v >> 16); p[2] = uint8_t(v >> 8); p[3] = uint8_t(v); }
+    inline uint32_t getU32(const uint8_t* p)       { return (uint32_t(p[0]) << 24) | (uint32_t(p[1]) << 16) | (uint32_t(p[2]) << 8) | p[3]; }
+
+    // Telemetry payload offsets (generated from TELEMETRY_V2_FIELDS in TelemetrySchema.h)
+    namespace TelemetryLayout {
+        constexpr size_t Counter   = TelemetryV2::counter;    // 1 byte, loop counter
+        constexpr size_t EchoSeq   = TelemetryV2::echoSeq;    // 2 bytes, last host sequence number received
+        constexpr size_t Rpy       = TelemetryV2::roll;       // 6 bytes, roll/pitch/yaw
+        constexpr size_t RxFrames  = TelemetryV2::rxFrames;   // 2 bytes, valid frames received by the firmware
+        constexpr size_t RxErrors  = TelemetryV2::rxErrors;   // 2 bytes, frames the firmware rejected
+        constexpr size_t Length    = TelemetryV2::LENGTH;
+    }
+
+    // Info payload offsets
+    namespace InfoLayout {
+        constexpr size_t DeviceId  = 0;    // 1 byte, set per board in the sketch (0: outer tube, 1: inner tube)
+        constexpr size_t Firmware  = 1;    // 1 byte, firmware version
+        constexpr size_t Name      = 2;    // ASCII up to the end of the payload, not terminated
+    }
+
+    struct Message {
+        MsgType        type    = MsgType::Heartbeat;
+        uint16_t       seq     = 0;
+        const uint8_t* payload = nullptr;   // points into the parsed frame
+        size_t         len     = 0;
+    };
+
+    enum class ParseResult {
+        Ok,
+        NotV2,       // no v2 header (probably a v1 frame)
+        BadLength,   // length field does not match the frame
+        BadCrc,
+    };
+
+    uint16_t crc16(const uint8_t* data, size_t n);
+
+    // Writes a complete raw frame (header + payload + CRC) to `out` (>= kOverhead + len).
+    // Returns the frame length, or 0 if len > kMaxPayload.
+    size_t build(MsgType type, uint16_t seq, const uint8_t* payload, size_t len, uint8_t* out);
+
+    ParseResult parse(const uint8_t* frame, size_t n, Message& out);
+
+    // SetMotors payload from the v1 TX image (motor i at bytes 2i, 2i+1). Returns the length.
+    size_t buildSetMotors(uint8_t mask, const uint8_t* image, uint8_t* out);
+}
+
+#endif // LINKPROTOCOL_H
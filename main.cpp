@@ -2,15 +2,23 @@
 
 #include <QApplication>
 #include <QDebug>
+#include <QLoggingCategory>
 #include <QTimer>
 
 #include <c10/macros/Macros.h>
 
 #include "autobending.h"
+#include "controlloop.h"
 #include "darknessdetector.h"
 #include "SerialInterface.h"
+#include "serialdevicemanager.h"
+#include "serialreplayer.h"
 #include "yoloexecutor.h"
 
+// Control loop timing report every 10 s; off unless enabled, e.g.
+//   QT_LOGGING_RULES="bendemo.stats.control.debug=true"
+Q_LOGGING_CATEGORY(lcControlStats, "bendemo.stats.control", QtInfoMsg)
+
 int main(int argc, char *argv[])
 {
     qputenv("CUDA_LAUNCH_BLOCKING", "1");
@@ -20,63 +28,202 @@ int main(int argc, char *argv[])
     MainWindow mainWindow;
     mainWindow.show();
 
-    // =========================================== Serial Communication ===========================================
+    // Replay mode: --replay <file.bdsl> [--speed x]  (x = 0 replays as fast as possible)
+    // --port <name> adds a port that is not listed by the system (e.g. /tmp/ttyBENDEMO from tools/VirtualController)
+    // --max-baud <n> caps the negotiated rate (0 = stay at 115200)
+    // --control-hz <n> sets the control loop rate, --rt <0|1> requests real-time priority, --cpu <n> pins the loop (Linux)
+    // --track <cv|ca|off> selects the Kalman model that predicts the target between detections (default off)
+    // --latency-comp <0|1> compensates the detection latency with a servo model and raises the gains (default 0)
+    // --video <gl|scene> selects the video canvas (default gl; scene = QGraphicsView pixmap)
+    // --detect-window <n> labels only a window around the last darkness result, with a full-frame
+    //   search at least every n frames (default 0 = off)
+    QString replayPath, portOverride;
+    double replaySpeed = 1.0;
+    int maxBaud = 1000000;
+    ControlLoop::Options controlOptions;
+    QString trackModel = "off";
+    bool latencyComp = false;
+    int detectWindow = 0;
+    const QStringList args = app.arguments();
+    for (int i = 1; i + 1 < args.size(); ++i) {
+        if (args[i] == "--replay") replayPath  = args[i + 1];
+        if (args[i] == "--speed")  replaySpeed = args[i + 1].toDouble();
+        if (args[i] == "--port")   portOverride = args[i + 1];
+        if (args[i] == "--max-baud") maxBaud   = args[i + 1].toInt();
+        if (args[i] == "--control-hz") controlOptions.rateHz = args[i + 1].toInt();
+        if (args[i] == "--rt")         controlOptions.realtime = args[i + 1].toInt() != 0;
+        if (args[i] == "--cpu")        controlOptions.cpu = args[i + 1].toInt();
+        if (args[i] == "--track")      trackModel = args[i + 1];
+        if (args[i] == "--latency-comp") latencyComp = args[i + 1].toInt() != 0;
+        if (args[i] == "--video")        mainWindow.setGLVideo(args[i + 1] != "scene");
+        if (args[i] == "--detect-window") detectWindow = args[i + 1].toInt();
+    }
 
-    SerialInterface serialInterface(30, 22);
+    // ===========================================    Auto Bender    ===========================================
 
-    QObject::connect(&serialInterface, &SerialInterface::errorOccurred, [](const QString &msg){
-        qWarning() << msg;
-    });
+    AutoBending autoBend;
+    autoBend.setGains(1.0, 0.00, 0.01);
+    autoBend.setDeadband(50.0);
+    autoBend.setOutputSaturation(2.0);
+    autoBend.setDerivativeCutoffHz(5.0);
+    autoBend.setGeometry(25.0, 25.0);
 
-    const int Baudrate = 115200;
-    const QString PortName = serialInterface.port();
-    if (serialInterface.open(PortName, Baudrate))
-    {
-        mainWindow.setSerialInterface(&serialInterface);
+    // --latency-comp: errors are corrected for the motion since the frame was captured and for the
+    // commands still in flight, which keeps a higher gain and a small deadband stable in ControlSim
+    // (comp mode, 10 deg step, 15 Hz detections, 120 ms latency). Opt-in until tried on the device.
+    if (latencyComp) {
+        AutoBending::ServoModel servo;
+        servo.slewDegPerSec = 300.0;   // EquipmentController setupMotors()
+        servo.commandDelaySec = 0.5 / 50 + 0.005;   // half a frame slot + serial
+        autoBend.setLatencyCompensation(true, servo);
+        autoBend.setGains(2.0, 0.00, 0.01);
+        autoBend.setDeadband(10.0);
     }
-    else
-    {
-        qCritical() << "[Main] Failed to open port.";
+
+    // The controller runs on its own fixed-rate thread: detections only publish the latest error,
+    // and the loop writes the motor targets straight into the serial TX image.
+    ControlLoop controlLoop(autoBend);
+    controlLoop.setAxis(ControlLoop::Vertical,   {0, mainWindow.motorMinimum(0), mainWindow.motorMaximum(0)});
+    controlLoop.setAxis(ControlLoop::Horizontal, {2, mainWindow.motorMinimum(1), mainWindow.motorMaximum(1)});
+
+    // --track: detections (10-20 Hz, less with YOLO on CPU) are tracked at their frame time,
+    // so every tick steers on a prediction instead of repeating the last error.
+    // Off by default until BendemoBatch --track-eval shows a gain on recorded footage.
+    if (trackModel != "off") {
+        TargetTracker::Options track;
+        if (trackModel == "ca") {
+            track.model = TargetTracker::Model::ConstantAcceleration;
+            track.processNoise = 4.0e6;
+        }
+        controlLoop.setTracking(true, track);
+        if (latencyComp) qWarning() << "[Main] --track together with --latency-comp settles slower in ControlSim (track-comp mode)";
     }
+    if (!controlLoop.start(controlOptions)) qCritical() << "[Main] Control loop failed to start";
 
-    mainWindow.setArduinoLogLabel(QByteArray(), PortName, Baudrate);
+    QObject::connect(&mainWindow, &MainWindow::applyChanged, [&](bool applying)
+                     {
+                         controlLoop.setApplying(applying, {mainWindow.motorValue(0), mainWindow.motorValue(1)});
+                     });
 
-    QObject::connect(&serialInterface, &SerialInterface::dataReceived, [&](const QByteArray &data)
+    // The GUI only mirrors what the loop did
+    QTimer controlViewTimer;
+    QObject::connect(&controlViewTimer, &QTimer::timeout, [&]()
                      {
-                        mainWindow.setArduinoLogLabel(data, PortName, Baudrate);
+                         auto out = controlLoop.takeOutput();
+                         if (!out) return;
+                         mainWindow.setControllLabel(out->deltaX, out->deltaY);
+                         if (mainWindow.canApply()) {
+                             mainWindow.setMotorValue(0 /*  Vertical  */, out->targets[ControlLoop::Vertical]);
+                             mainWindow.setMotorValue(1 /* Horizontal */, out->targets[ControlLoop::Horizontal]);
+                         }
                      });
+    controlViewTimer.start(33);
 
-    // Send continuously at regular intervals.
-    // This allows the Arduino to confirm that communication with the Qt application has been established.
-    // If communication cannot be confirmed, the Arduino will physically disconnect the power circuit connected to the motor.
-    QTimer continuousSendTimer;
-    QObject::connect(&continuousSendTimer, &QTimer::timeout,
-                     [&serialInterface]()
+    QTimer controlStatsTimer;
+    QObject::connect(&controlStatsTimer, &QTimer::timeout, [&]()
                      {
-                        serialInterface.Send();
+                         if (!lcControlStats().isDebugEnabled()) return;
+                         const ControlLoop::Stats st = controlLoop.stats();
+                         qCDebug(lcControlStats).noquote() << QString("[Control] ticks %1  jitter mean %2 us / p99 %3 us / max %4 us  overruns %5  work %6 / %7 us  samples %8  writes %9  delay %10 ms")
+                                                                  .arg(st.ticks).arg(st.meanJitterUs, 0, 'f', 1).arg(st.p99JitterUs, 0, 'f', 0)
+                                                                  .arg(st.maxJitterUs, 0, 'f', 0).arg(st.overruns)
+                                                                  .arg(st.meanWorkUs, 0, 'f', 1).arg(st.maxWorkUs, 0, 'f', 1)
+                                                                  .arg(st.samples).arg(st.writes).arg(st.pipelineDelayMs, 0, 'f', 1);
+                         controlLoop.resetStats();
                      });
-    continuousSendTimer.start(500);
+    controlStatsTimer.start(10000);
 
-    // ===========================================    Auto Bender    ===========================================
+    // =========================================== Serial Communication ===========================================
 
-    AutoBending autoBend;
-    autoBend.setGains(1.0, 0.00, 0.01);
-    autoBend.setDeadband(50.0);
-    autoBend.setOutputSaturation(2.0);
-    autoBend.setDerivativeCutoffHz(5.0);
-    autoBend.setGeometry(25.0, 25.0);
+    const int Baudrate = 115200;
 
-    double addX_ = 0.0, addY_ = 0.0;
-    QTimer motorUpdateTimer;
-    QObject::connect(&motorUpdateTimer, &QTimer::timeout,
-                     [&mainWindow, &addX_, &addY_]()
-                     {
-                         if (!mainWindow.canApply()) return;
+    // Controllers are found and re-attached by the device manager; device #0 (outer tube) drives the UI.
+    SerialDeviceManager deviceManager(30, 22);
+    std::unique_ptr<SerialInterface> replayInterface;
+    SerialReplayer replayer;
 
-                         if (std::abs(addX_) > 0.0) mainWindow.addMotorValue(1 /* Horizontal */, addX_);
-                         if (std::abs(addY_) > 0.0) mainWindow.addMotorValue(0 /*  Vertical  */, addY_);
-                     });
-    motorUpdateTimer.start(100);
+    QObject::connect(&deviceManager, &SerialDeviceManager::errorOccurred, [](const QString &msg){
+        qWarning() << msg;
+    });
+
+    if (!replayPath.isEmpty())
+    {
+        // Recorded uplink frames are fed through the normal RX path; no port is opened.
+        replayInterface = std::make_unique<SerialInterface>(30, 22);
+        QObject::connect(replayInterface.get(), &SerialInterface::dataReceived, [&](const QByteArray &data)
+                         {
+                            mainWindow.setArduinoLogLabel(data, "replay", Baudrate);
+                         });
+        mainWindow.setArduinoLogLabel(QByteArray(), "replay", Baudrate);
+
+        QTimer::singleShot(0, &app, [&]()
+                           {
+                               QString error;
+                               if (!replayer.start(replayPath, replaySpeed,
+                                                   [&replayInterface](const uint8_t* p, int n)
+                                                   { return replayInterface->injectReceived(p, n); },
+                                                   &error))
+                               {
+                                   qCritical() << "[Main] Replay failed:" << error;
+                               }
+                           });
+    }
+    else
+    {
+        deviceManager.setBaudRate(Baudrate);
+        deviceManager.addPort(portOverride);
+
+        // Step up from 115200 right after the handshake.
+        // Each rate is benchmarked with echoed pings and kept only if the link stays clean.
+        QList<int> candidates;
+        for (int rate : {250000, 500000, 1000000, 2000000})
+            if (rate <= maxBaud) candidates << rate;
+        deviceManager.setBaudCandidates(candidates);
+
+        deviceManager.setSetup([](SerialInterface* serial)
+                               {
+                                   // Send continuously at regular intervals.
+                                   // This allows the Arduino to confirm that communication with the Qt application has been established.
+                                   // If communication cannot be confirmed, the Arduino will physically disconnect the power circuit connected to the motor.
+                                   // The heartbeat runs on the serial I/O thread, so a busy GUI thread cannot starve it.
+                                   // Heartbeats only go out when no other frame was sent within the interval.
+                                   serial->setHeartbeatInterval(500);
+
+                                   // Slider drags and control updates are merged into at most one frame per 20 ms.
+                                   serial->setFrameRate(50);
+
+                                   // Typed messages with CRC; the firmware answers in V2 once it has received a V2 frame.
+                                   serial->setProtocol(SerialInterface::Protocol::V2);
+                               });
+
+        QObject::connect(&deviceManager, &SerialDeviceManager::deviceConnected, &mainWindow,
+                         [&](int id, SerialInterface* serial)
+                         {
+                             if (id != 0) return;   // other controllers are reachable through deviceManager.device(id)
+
+                             const QString port = serial->portName();
+                             const int baud = serial->baudRate();
+                             mainWindow.setSerialInterface(serial);
+                             controlLoop.setSerialInterface(serial);
+                             mainWindow.setArduinoLogLabel(QByteArray(), port, baud);
+                             QObject::connect(serial, &SerialInterface::dataReceived, &mainWindow,
+                                              [&mainWindow, port, baud](const QByteArray &data)
+                                              {
+                                                  mainWindow.setArduinoLogLabel(data, port, baud);
+                                              });
+                         });
+        QObject::connect(&deviceManager, &SerialDeviceManager::deviceDisconnected, &mainWindow,
+                         [&](int id)
+                         {
+                             if (id != 0) return;
+                             controlLoop.setSerialInterface(nullptr);
+                             mainWindow.setSerialInterface(nullptr);
+                             mainWindow.setArduinoLogLabel(QByteArray(), "disconnected", 0);
+                         });
+
+        mainWindow.setArduinoLogLabel(QByteArray(), "searching", 0);
+        deviceManager.start();
+    }
 
 
     // =========================================== Center Difference Calculator ===========================================
@@ -95,8 +242,9 @@ int main(int argc, char *argv[])
             const double reduceRatioX = static_cast<double>(canvasSize) / src.width();
             const double reduceRatioY = static_cast<double>(canvasSize) / src.height();
 
-            const double centerPositionX = (results[detectedIndex].x1 + results[detectedIndex].x2) * 0.5 * reduceRatioX;
-            const double centerPositionY = (results[detectedIndex].y1 + results[detectedIndex].y2) * 0.5 * reduceRatioY;
+            // cx/cy: moment-based centroid for dark regions, box center for YOLO
+            const double centerPositionX = results[detectedIndex].cx * reduceRatioX;
+            const double centerPositionY = results[detectedIndex].cy * reduceRatioY;
 
             differenceX = centerPositionX - static_cast<double>(canvasSize) * 0.5;
             differenceY = static_cast<double>(canvasSize) * 0.5 - centerPositionY;
@@ -112,28 +260,68 @@ int main(int argc, char *argv[])
     auto darknessDetector = new DarknessDetector(nullptr);
 
     darknessDetector->setMinAreaRatio(0.02f);
-    darknessDetector->setBlackThreshold(40);
+    darknessDetector->setBlackThreshold(40);   // until the first histogram
+    darknessDetector->setAdaptiveThreshold(DarknessDetector::ThresholdMode::Otsu);
     darknessDetector->setWhiteMask(5, 3);
+    // Window tracking misses a larger region outside the window until the next full-frame search,
+    // and the top-K results only cover the window. Off until BendemoBatch shows it on recorded footage.
+    if (detectWindow > 0) darknessDetector->setTracking(true, detectWindow);
 
     darknessDetector->start();
 
     // Image Acquisition & Detection
-    QTimer ddUpdateTimer;
-    QObject::connect(&ddUpdateTimer, &QTimer::timeout,
-                    [&mainWindow, darknessDetector]()
+    // Every camera frame goes straight into the detector's single-slot mailbox (latest frame wins);
+    // the detector only runs while "OpenCV" is the selected detector.
+    darknessDetector->setEnabled(mainWindow.DetectorName().contains("OpenCV"));
+    QObject::connect(&mainWindow, &MainWindow::detectorChanged, darknessDetector,
+                    [darknessDetector](const QString& name)
                     {
-                        if(mainWindow.DetectorName().contains("OpenCV") == false) return;
-
-                        const QImage latest = mainWindow.LatestCameraImage();
-                        if (latest.isNull()) return;
+                        darknessDetector->setEnabled(name.contains("OpenCV"));
+                    },
+                    Qt::DirectConnection);
 
+    QObject::connect(&mainWindow, &MainWindow::cameraReady, darknessDetector,
+                    [darknessDetector](CameraDisplayer* cam)
+                    {
                         // submitFrame() contains the detect function
-                        darknessDetector->submitFrame(latest);
+                        QObject::connect(cam, &CameraDisplayer::frameReady, darknessDetector,
+                                        [darknessDetector](const QImage& img)
+                                        {
+                                            darknessDetector->submitFrame(img);
+                                        },
+                                        Qt::DirectConnection);
+                    },
+                    Qt::DirectConnection);
+
+    // Control input: no context object, so this runs on the detector thread and a busy GUI
+    // cannot delay the error on its way to the control loop.
+    const int canvasSize = mainWindow.CanvasSize();
+    QObject::connect(darknessDetector, &DarknessDetector::detectionReady,
+                    [&controlLoop, calculator, canvasSize](QVector<Detector::DetectedObject> results, QImage src, float, float, qint64 frameStampNs)
+                    {
+                        if (results.isEmpty()) return;
+
+                        // Calculate the difference in image center coordinates
+                        double differenceX, differenceY;
+                        calculator(results, src, 0, canvasSize, differenceX, differenceY);
+                        controlLoop.submitError(differenceX, differenceY, frameStampNs);
                     });
-    ddUpdateTimer.start(50);
 
+    // Log when the lumen leaves or re-enters the view, and larger threshold moves (lighting changes)
+    QObject::connect(darknessDetector, &DarknessDetector::thresholdChosen, &mainWindow,
+                    [logged = 0](int threshold) mutable
+                    {
+                        const bool none = threshold == DarknessDetector::kNoDarkRegion;
+                        const bool wasNone = logged == DarknessDetector::kNoDarkRegion;
+                        if (none == wasNone && std::abs(threshold - logged) < 10) return;
+                        logged = threshold;
+                        if (none) qDebug() << "[Main] No dark region in view";
+                        else      qDebug() << "[Main] Darkness threshold" << threshold;
+                    });
+
+    // Display only
     QObject::connect(darknessDetector, &DarknessDetector::detectionReady, &mainWindow,
-                    [&](QVector<Detector::DetectedObject> results, QImage src, float sx, float sy)
+                    [&](QVector<Detector::DetectedObject> results, QImage src, float sx, float sy, qint64 frameStampNs)
                     {
                         // Output of bounding boxes
                          mainWindow.DrawDetectedBox(results);
@@ -145,23 +333,16 @@ int main(int argc, char *argv[])
                             return;
                         }
 
-                        // Calculate the difference in image center coordinates
                         double differenceX, differenceY;
-                        calculator(results, src, 0, mainWindow.CanvasSize(), differenceX, differenceY);
-
+                        calculator(results, src, 0, canvasSize, differenceX, differenceY);
                         mainWindow.setDifferenceLabel(differenceX, differenceY);
-
-                        double dX = 0.0, dY = 0.0;
-                        if (autoBend.step(differenceX, differenceY, dX, dY))
-                        {
-                            mainWindow.setControllLabel(dX, dY);
-                            addX_ = dX;
-                            addY_ = dY;
-                        }
                     });
 
     QObject::connect(&app, &QCoreApplication::aboutToQuit, [&](){
+        controlLoop.stop();
         darknessDetector->stop();
+        replayer.stop();
+        deviceManager.stop();
     });
 
 
@@ -197,6 +378,7 @@ int main(int argc, char *argv[])
                                             tick.restart();
 
                                             busy = true;
+                                            const int64_t frameStampNs = ControlLoop::clockNs();
 
                                             auto qimgPtr = std::make_shared<QImage>(img);
                                             auto results = yolo->Detect(qimgPtr);
@@ -204,19 +386,19 @@ int main(int argc, char *argv[])
                                             mainWindow.DrawDetectedBox(results);
                                             busy = false;
 
+                                            if (results.isEmpty())
+                                            {
+                                                mainWindow.setDifferenceLabel(std::nan(""), std::nan(""));
+                                                mainWindow.setControllLabel(std::nan(""), std::nan(""));
+                                                return;
+                                            }
+
                                             // Calculate the difference in image center coordinates
                                             double differenceX, differenceY;
                                             calculator(results, img, 0, mainWindow.CanvasSize(), differenceX, differenceY);
 
                                             mainWindow.setDifferenceLabel(differenceX, differenceY);
-
-                                            double dX = 0.0, dY = 0.0;
-                                            if (autoBend.step(differenceX, differenceY, dX, dY))
-                                            {
-                                                mainWindow.setControllLabel(dX, dY);
-                                                addX_ = dX;
-                                                addY_ = dY;
-                                            }
+                                            controlLoop.submitError(differenceX, differenceY, frameStampNs);
                                         },
                                         Qt::QueuedConnection);
                     });
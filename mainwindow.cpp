@@ -1,6 +1,15 @@
 #include "mainwindow.h"
 #include "./ui_mainwindow.h"
 
+#include <QLoggingCategory>
+#include <QScreen>
+
+#include "telemetryview.h"
+
+// UI coalescing report every ~10 s; off unless enabled, e.g.
+//   QT_LOGGING_RULES="bendemo.stats.ui.debug=true"
+Q_LOGGING_CATEGORY(lcUiStats, "bendemo.stats.ui", QtInfoMsg)
+
 #ifdef Q_OS_WIN
 #include <Windows.h>
 
@@ -51,16 +60,16 @@ MainWindow::MainWindow(QWidget *parent) : QMainWindow(parent), ui(new Ui::MainWi
 
     connect(outerTubeVController, &IntegratedValueController::valueChanged, this, [&](double v)
     {
-        // [HACK] If the connection to Arduino is not established, some parts of the SerialInterface may not function correctly.
-        // Here, I am using the log text to verify that it is not connected.
-        if(ui->arduinoLogLabel->text().contains(QStringLiteral("COM")) == false) return;
+        // setSerialInterface() is only called once the port is open; ports are not always named COMx
+        // (e.g. /tmp/ttyBENDEMO from tools/VirtualController), so ask the interface itself.
+        if (mirroringMotors_ || !serialInterface || !serialInterface->isOpen()) return;
         serialInterface->SetMessage(0, outerTubeVController->valueAsBytes());
         serialInterface->Send();
     });
 
     connect(outerTubeHController, &IntegratedValueController::valueChanged, this, [&](double v)
     {
-        if(ui->arduinoLogLabel->text().contains(QStringLiteral("COM")) == false) return;
+        if (mirroringMotors_ || !serialInterface || !serialInterface->isOpen()) return;
         serialInterface->SetMessage(2, outerTubeHController->valueAsBytes());
         serialInterface->Send();
     });
@@ -85,6 +94,17 @@ MainWindow::MainWindow(QWidget *parent) : QMainWindow(parent), ui(new Ui::MainWi
     // BBox Renderer
     bboxRenderer_ = new BBoxRenderer(ui->graphicsView, ui->dbboxDispCheckBox, this);
 
+    // GL canvas by default; main() switches back to the graphics scene with --video scene
+    setGLVideo(true);
+
+    // UI refresh: paint the newest model values once per display frame
+    if (const QScreen* s = screen(); s && s->refreshRate() > 1.0) {
+        uiRefreshHz_ = qRound(s->refreshRate());
+    }
+    uiRefreshTimer_.setTimerType(Qt::PreciseTimer);
+    connect(&uiRefreshTimer_, &QTimer::timeout, this, &MainWindow::flushUi_);
+    uiRefreshTimer_.start(1000 / uiRefreshHz_);
+
     // Key Input
     auto* shot_numpad8 = new QShortcut(QKeySequence(QKeyCombination(Qt::KeypadModifier, Qt::Key_8)), this);
     connect(shot_numpad8, &QShortcut::activated, this, [&](){
@@ -106,21 +126,10 @@ MainWindow::MainWindow(QWidget *parent) : QMainWindow(parent), ui(new Ui::MainWi
         outerTubeHController->updateValue(false);
     });
 
-    // =========================================== Initialization ===========================================
-
-    QTimer::singleShot(0, this, [this](){
-        if (!serialInterface) return;
-        serialInterface->SetMessage(0, outerTubeVController->valueAsBytes());
-        serialInterface->SetMessage(2, outerTubeHController->valueAsBytes());
-
-        // Send the message twice since it's easy to fail the first time.
-        serialInterface->Send();
-        serialInterface->Send();
-    });
-
     // =========================================== Connections ===========================================
 
     connect(ui->recordButton, &QPushButton::clicked, this, [&](){
+        if (!serialInterface) return;
         serialInterface->changeRecordState();
 
         QString currentText = ui->recordButton->text();
@@ -134,6 +143,8 @@ MainWindow::MainWindow(QWidget *parent) : QMainWindow(parent), ui(new Ui::MainWi
         }
     });
 
+    connect(ui->detectorComboBox, &QComboBox::currentTextChanged, this, &MainWindow::detectorChanged);
+
     connect(ui->applyButton, &QPushButton::clicked, this, [&](){
 
         QString currentText = ui->applyButton->text();
@@ -147,65 +158,74 @@ MainWindow::MainWindow(QWidget *parent) : QMainWindow(parent), ui(new Ui::MainWi
             ui->applyButton->setText("Start Applying");
             canApply_ = false;
         }
+        emit applyChanged(canApply_);
     });
 }
 
 MainWindow::~MainWindow()
 {
+    // The GL view goes with the ui widgets; stop the camera's converter thread writing into it first
+    if (cameraDisplayer_) cameraDisplayer_->setGLView(nullptr);
     delete ui;
 }
 
 void MainWindow::DrawDetectedBox(QVector<Detector::DetectedObject> objects)
 {
-    const QSize camRes = cameraDisplayer_->OriginalResolution();
-    bboxRenderer_->UpdateBoundingBoxes(objects, camRes);
+    uiModel_.publishDetections(objects);
 }
 
-void MainWindow::setArduinoLogLabel(QByteArray log, QString portName, int baudrate)
+void MainWindow::setGLVideo(bool on)
 {
-    QString logText = "";
-    if(log.size() == 0)
+    if (on == (glVideoView_ != nullptr)) return;
+
+    if (on)
     {
-        logText = "No Byte Data Received!";
+        // GL canvas: video texture + boxes + crosshair in one pass, placed over the graphics view
+        glVideoView_ = new GLVideoView(ui->graphicsView->parentWidget());
+        glVideoView_->setGeometry(ui->graphicsView->geometry());
+        glVideoView_->show();
+        ui->graphicsView->hide();
     }
     else
     {
-        int counter = 0;
-        foreach (byte l, log)
-        {
-            logText += QString::number(l);
-            if (++counter >= 13)
-            {
-                break;
-            }
-            logText += " , ";
-        }
+        glVideoView_->deleteLater();
+        glVideoView_ = nullptr;
+        ui->graphicsView->show();
     }
 
-    QString text = "Port : " + portName + ", BaudRate : " + QString::number(baudrate) + "\n" + logText;
-    ui->arduinoLogLabel->setText(text);
+    cameraDisplayer_->setGLView(glVideoView_);
+    bboxRenderer_->setGLView(glVideoView_);
+}
+
+void MainWindow::setSerialInterface(SerialInterface* ptr)
+{
+    serialInterface = ptr;
+    ui->recordButton->setText("Record");   // a new interface starts without a log
+    if (!serialInterface || !serialInterface->isOpen()) return;
+
+    // A (re)attached controller starts from the current slider positions
+    serialInterface->SetMessage(0, outerTubeVController->valueAsBytes());
+    serialInterface->SetMessage(2, outerTubeHController->valueAsBytes());
+
+    // Send the message twice since it's easy to fail the first time.
+    // The retry goes out on the next frame slot.
+    serialInterface->SendUrgent();
+    serialInterface->Send();
+}
+
+void MainWindow::setArduinoLogLabel(QByteArray log, QString portName, int baudrate)
+{
+    uiModel_.publishTelemetry(log, portName, baudrate);
 }
 
 void MainWindow::setDifferenceLabel(double xDiff, double yDiff)
 {
-    if(std::isnan(xDiff) || std::isnan(yDiff))
-    {
-        ui->labelDiff->setText("Difference from the center : ---.- , ---.-");
-        return;
-    }
-    QString text = "Difference from the center x : " + QString::number(xDiff, 'f', 1) + " , y :  " + QString::number(yDiff, 'f', 1);
-    ui->labelDiff->setText(text);
+    uiModel_.publishDifference(xDiff, yDiff);
 }
 
 void MainWindow::setControllLabel(double x, double y)
 {
-    if(std::isnan(x) || std::isnan(y))
-    {
-        ui->labelControll->setText("Controll : ---.- , ---.-");
-        return;
-    }
-    QString text = "Controll : " + QString::number(x, 'f', 1) + " , " + QString::number(y, 'f', 1);
-    ui->labelControll->setText(text);
+    uiModel_.publishControl(x, y);
 }
 
 void MainWindow::setDetectorComboBox(QString yoloModelName, int defaultIndex)
@@ -217,19 +237,46 @@ void MainWindow::setDetectorComboBox(QString yoloModelName, int defaultIndex)
     ui->detectorComboBox->blockSignals(false);
 
     ui->detectorComboBox->setCurrentIndex(defaultIndex);
+
+    // setCurrentIndex() stays silent when the index does not change
+    emit detectorChanged(ui->detectorComboBox->currentText());
 }
 
-void MainWindow::addMotorValue(int motorIndex, double value)
+double MainWindow::motorValue(int motorIndex) const
 {
     switch(motorIndex)
     {
     case 0: /* Outer Tube (Vertical) */
-        outerTubeVController->addValue(value);
+        return outerTubeVController->value();
+    case 1: /* Outer Tube (Horizontal) */
+        return outerTubeHController->value();
+    }
+    return std::numeric_limits<double>::quiet_NaN();
+}
+
+double MainWindow::motorMinimum(int motorIndex) const
+{
+    return motorIndex == 0 ? outerTubeVController->minimum() : outerTubeHController->minimum();
+}
+
+double MainWindow::motorMaximum(int motorIndex) const
+{
+    return motorIndex == 0 ? outerTubeVController->maximum() : outerTubeHController->maximum();
+}
+
+void MainWindow::setMotorValue(int motorIndex, double value)
+{
+    mirroringMotors_ = true;
+    switch(motorIndex)
+    {
+    case 0: /* Outer Tube (Vertical) */
+        outerTubeVController->setValue(value);
         break;
     case 1: /* Outer Tube (Horizontal) */
-        outerTubeHController->addValue(value);
+        outerTubeHController->setValue(value);
         break;
     }
+    mirroringMotors_ = false;
 }
 
 QString MainWindow::DetectorName()
@@ -239,6 +286,93 @@ QString MainWindow::DetectorName()
 
 // ===================================== Private Methods =====================================
 
+void MainWindow::flushUi_()
+{
+    if (auto objects = uiModel_.takeDetections()) renderDetectedBox_(*objects);
+    if (auto diff = uiModel_.takeDifference())    renderDifferenceLabel_(diff->x, diff->y);
+    if (auto ctrl = uiModel_.takeControl())       renderControllLabel_(ctrl->x, ctrl->y);
+    if (auto tel = uiModel_.takeTelemetry())      renderArduinoLogLabel_(tel->log, tel->portName, tel->baudrate);
+
+    // Report how much was coalesced every ~10 s
+    if (++uiFlushCount_ % quint64(uiRefreshHz_ * 10) == 0 && lcUiStats().isDebugEnabled()) {
+        qCDebug(lcUiStats).noquote() << uiModel_.statsText();
+    }
+}
+
+void MainWindow::renderDetectedBox_(const QVector<Detector::DetectedObject>& objects)
+{
+    const QSize camRes = cameraDisplayer_->OriginalResolution();
+    bboxRenderer_->UpdateBoundingBoxes(objects, camRes);
+}
+
+void MainWindow::renderArduinoLogLabel_(const QByteArray& log, const QString& portName, int baudrate)
+{
+    QString logText = "";
+    const TelemetryView telemetry(log);   // decoded in place, see TelemetrySchema.h
+    if(!telemetry.valid())
+    {
+        logText = "No Byte Data Received!";
+    }
+    else
+    {
+        logText = QString("Counter : %1, RPY : %2 , %3 , %4 deg, Seq : %5")
+                      .arg(telemetry.counterRaw())
+                      .arg(telemetry.roll(), 0, 'f', 2)
+                      .arg(telemetry.pitch(), 0, 'f', 2)
+                      .arg(telemetry.yaw(), 0, 'f', 2)
+                      .arg(telemetry.echoSeqRaw());
+    }
+
+    QString text = "Port : " + portName + ", BaudRate : " + QString::number(baudrate) + "\n" + logText;
+
+    // Round trip (Send -> firmware echo), refreshed with the telemetry
+    if (serialInterface && serialInterface->hasRoundTrip())
+    {
+        const RoundTripTracker::Snapshot rt = serialInterface->roundTrip();
+        if (rt.samples > 0)
+        {
+            text += QString("\nRTT : p50 %1 ms, p95 %2 ms, max %3 ms  (lost %4, reordered %5)")
+                        .arg(rt.p50Us / 1000.0, 0, 'f', 2)
+                        .arg(rt.p95Us / 1000.0, 0, 'f', 2)
+                        .arg(rt.maxUs / 1000.0, 0, 'f', 2)
+                        .arg(rt.lost)
+                        .arg(rt.reordered);
+        }
+    }
+
+    if (serialInterface && serialInterface->isOpen())
+    {
+        const SerialInterface::LinkStats ls = serialInterface->stats();
+        text += QString("\nLink : TX %1 %, RX %2 %, errors %3 %")
+                    .arg(ls.txUtilization * 100.0, 0, 'f', 1)
+                    .arg(ls.rxUtilization * 100.0, 0, 'f', 1)
+                    .arg(ls.rxErrorRate * 100.0, 0, 'f', 2);
+    }
+    ui->arduinoLogLabel->setText(text);
+}
+
+void MainWindow::renderDifferenceLabel_(double xDiff, double yDiff)
+{
+    if(std::isnan(xDiff) || std::isnan(yDiff))
+    {
+        ui->labelDiff->setText("Difference from the center : ---.- , ---.-");
+        return;
+    }
+    QString text = "Difference from the center x : " + QString::number(xDiff, 'f', 1) + " , y :  " + QString::number(yDiff, 'f', 1);
+    ui->labelDiff->setText(text);
+}
+
+void MainWindow::renderControllLabel_(double x, double y)
+{
+    if(std::isnan(x) || std::isnan(y))
+    {
+        ui->labelControll->setText("Controll : ---.- , ---.-");
+        return;
+    }
+    QString text = "Controll : " + QString::number(x, 'f', 1) + " , " + QString::number(y, 'f', 1);
+    ui->labelControll->setText(text);
+}
+
 QByteArray MainWindow::ReadLatestSentSerialData()
 {
     auto latestCsvPath = []() -> QString {
@@ -8,8 +8,10 @@
 #include "bbox_renderer.h"
 #include "CameraDisplayer.h"
 #include "DarknessDetector.h"
+#include "glvideoview.h"
 #include "IntegratedValueController.h"
 #include "SerialInterface.h"
+#include "uimodel.h"
 
 QT_BEGIN_NAMESPACE
 namespace Ui {
@@ -25,38 +27,62 @@ public:
     MainWindow(QWidget *parent = nullptr);
     ~MainWindow();
 
-    void setSerialInterface(SerialInterface* ptr){serialInterface = ptr;}
+    void setSerialInterface(SerialInterface* ptr);   // nullptr while no controller is attached
+
+    // true = GLVideoView canvas (default), false = QGraphicsScene pixmap
+    void setGLVideo(bool on);
 
     QImage LatestCameraImage(){return cameraDisplayer_->LatestImage();}
     int CanvasSize(){return cameraDisplayer_->CanvasSize();}
     void DrawDetectedBox(QVector<Detector::DetectedObject> obj);
 
     // Set Label and ComboBox
+    // Box / label / log updates are stored in the UI model and painted once per display refresh.
     void setArduinoLogLabel(QByteArray log, QString portName, int baudrate = 115200);
     void setDifferenceLabel(double xDiff, double yDiff);
     void setControllLabel(double xDiff, double yDiff);
     void setDetectorComboBox(QString yoloModelName, int defaultIndex = 0);
 
     // Controll Equipment
+    // The control loop writes the motor targets itself; setMotorValue() only mirrors them on the sliders.
     bool canApply() noexcept {return canApply_;}
-    void addMotorValue(int motorIndex, double value);
+    double motorValue(int motorIndex) const;
+    double motorMinimum(int motorIndex) const;
+    double motorMaximum(int motorIndex) const;
+    void setMotorValue(int motorIndex, double value);
 
     QString DetectorName();
 
 signals:
     void channelChanged(int position, double value);
     void cameraReady(CameraDisplayer* cam);
+    void detectorChanged(const QString& detectorName);
+    void applyChanged(bool applying);
 
 private:
     Ui::MainWindow *ui;
     SerialInterface* serialInterface{nullptr};
     CameraDisplayer* cameraDisplayer_{nullptr};
     BBoxRenderer* bboxRenderer_{nullptr};
+    GLVideoView* glVideoView_{nullptr};
 
     IntegratedValueController* outerTubeVController{nullptr};
     IntegratedValueController* outerTubeHController{nullptr};
 
     bool canApply_{false};
+    bool mirroringMotors_{false};   // setMotorValue() in progress: the value is already on the wire
+
+    // Display-rate coalescing of detection / telemetry updates
+    UiModel uiModel_;
+    QTimer  uiRefreshTimer_;
+    int     uiRefreshHz_{60};
+    quint64 uiFlushCount_{0};
+
+    void flushUi_();
+    void renderDetectedBox_(const QVector<Detector::DetectedObject>& objects);
+    void renderArduinoLogLabel_(const QByteArray& log, const QString& portName, int baudrate);
+    void renderDifferenceLabel_(double xDiff, double yDiff);
+    void renderControllLabel_(double x, double y);
 
     QByteArray ReadLatestSentSerialData();
     inline double doubleFromBytes(const QByteArray& bytes, int idx)
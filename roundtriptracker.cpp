@@ -0,0 +1,114 @@
+#include "roundtriptracker.h"
+
+#include <algorithm>
+
+void RoundTripTracker::sent(uint16_t seq, int64_t tNs)
+{
+    if (resetRequested_.load(std::memory_order_acquire)) applyReset_();
+    if (seq == 0) return;
+
+    Pending& p = pending_[seq % kWindow];
+    p.seq      = seq;
+    p.answered = false;
+    p.sentNs   = tNs;
+}
+
+void RoundTripTracker::echoed(uint16_t seq, int64_t tNs)
+{
+    if (resetRequested_.load(std::memory_order_acquire)) applyReset_();
+    if (seq == 0 || seq == lastEcho_) return;
+    lastEcho_ = seq;
+
+    Pending& p = pending_[seq % kWindow];
+    if (p.seq != seq || p.answered) return;   // unknown / too old / already matched
+    p.answered = true;
+    record_((tNs - p.sentNs) / 1000);
+
+    if (!haveAcked_) {
+        haveAcked_   = true;
+        newestAcked_ = seq;
+        return;
+    }
+
+    const int16_t ahead = int16_t(uint16_t(seq - newestAcked_));
+    if (ahead > 0) {
+        // Everything skipped over and still unanswered is presumed lost
+        for (uint16_t s = uint16_t(newestAcked_ + 1); s != seq; ++s) {
+            if (s == 0) continue;
+            const Pending& q = pending_[s % kWindow];
+            if (q.seq == s && !q.answered) lost_.fetch_add(1, std::memory_order_relaxed);
+        }
+        newestAcked_ = seq;
+    } else {
+        // Arrived after a newer one: it was counted as lost when that one came in
+        reordered_.fetch_add(1, std::memory_order_relaxed);
+        if (lost_.load(std::memory_order_relaxed) > 0) lost_.fetch_sub(1, std::memory_order_relaxed);
+    }
+}
+
+void RoundTripTracker::record_(int64_t us)
+{
+    if (us < 0) us = 0;
+    const size_t b = std::min(size_t(us / kBucketUs), kBuckets - 1);
+    buckets_[b].fetch_add(1, std::memory_order_relaxed);
+    samples_.fetch_add(1, std::memory_order_relaxed);
+    sumUs_.fetch_add(uint64_t(us), std::memory_order_relaxed);
+
+    // Single writer, so plain load/store is enough for min/max
+    const int64_t lo = minUs_.load(std::memory_order_relaxed);
+    if (lo < 0 || us < lo) minUs_.store(us, std::memory_order_relaxed);
+    if (us > maxUs_.load(std::memory_order_relaxed)) maxUs_.store(us, std::memory_order_relaxed);
+}
+
+void RoundTripTracker::applyReset_()
+{
+    resetRequested_.store(false, std::memory_order_relaxed);
+    for (auto& b : buckets_) b.store(0, std::memory_order_relaxed);
+    samples_.store(0, std::memory_order_relaxed);
+    sumUs_.store(0, std::memory_order_relaxed);
+    lost_.store(0, std::memory_order_relaxed);
+    reordered_.store(0, std::memory_order_relaxed);
+    minUs_.store(-1, std::memory_order_relaxed);
+    maxUs_.store(0, std::memory_order_relaxed);
+    for (auto& p : pending_) p.answered = true;
+    haveAcked_ = false;
+}
+
+RoundTripTracker::Snapshot RoundTripTracker::snapshot() const
+{
+    Snapshot s;
+    s.histogram.resize(kBuckets);
+    uint64_t total = 0;
+    for (size_t i = 0; i < kBuckets; ++i) {
+        s.histogram[i] = buckets_[i].load(std::memory_order_relaxed);
+        total += s.histogram[i];
+    }
+
+    s.samples   = samples_.load(std::memory_order_relaxed);
+    s.lost      = lost_.load(std::memory_order_relaxed);
+    s.reordered = reordered_.load(std::memory_order_relaxed);
+    if (s.samples == 0) return s;
+
+    s.minUs  = double(std::max<int64_t>(0, minUs_.load(std::memory_order_relaxed)));
+    s.maxUs  = double(maxUs_.load(std::memory_order_relaxed));
+    s.meanUs = double(sumUs_.load(std::memory_order_relaxed)) / double(s.samples);
+
+    auto percentile = [&](double q) {
+        const uint64_t rank = uint64_t(q * double(total - 1)) + 1;
+        uint64_t seen = 0;
+        for (size_t i = 0; i < kBuckets; ++i) {
+            seen += s.histogram[i];
+            if (seen >= rank) {
+                // The overflow bucket has no upper edge; use the observed maximum
+                return i + 1 == kBuckets ? s.maxUs : std::min(s.maxUs, double((i + 1) * kBucketUs));
+            }
+        }
+        return s.maxUs;
+    };
+    if (total > 0) {
+        s.p50Us = percentile(0.50);
+        s.p95Us = percentile(0.95);
+        s.p99Us = percentile(0.99);
+    }
+    return s;
+}
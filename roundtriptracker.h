@@ -0,0 +1,76 @@
+#ifndef ROUNDTRIPTRACKER_H
+#define ROUNDTRIPTRACKER_H
+
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * Round-trip time of sequence-stamped frames that the peer echoes back.
+ *
+ * Usage (one thread feeds, any thread reads):
+ *   tracker.sent(seq, nowNs);      // frame stamped with `seq` handed to the port
+ *   tracker.echoed(echo, nowNs);   // sequence number found in a received frame
+ *   auto s = tracker.snapshot();   // histogram + percentiles + loss/reorder
+ *
+ * - Sequence numbers are 16-bit and wrap; 0 means "nothing received yet" and is ignored.
+ * - The peer repeats its last echo in every uplink frame, so only a change of the
+ *   echoed value counts as an answer.
+ * - A jump over unanswered numbers counts them as lost. If one of them turns up
+ *   later it is moved from lost to reordered.
+ * - sent()/echoed() must come from one thread. reset() may be called from any
+ *   thread and takes effect on the next sent()/echoed().
+ */
+class RoundTripTracker
+{
+public:
+    static constexpr int    kBucketUs = 250;            // histogram resolution
+    static constexpr size_t kBuckets  = 400;            // 0 .. 100 ms, last bucket = overflow
+    static constexpr size_t kWindow   = 256;            // outstanding sequence numbers remembered
+
+    struct Snapshot {
+        uint64_t samples   = 0;
+        uint64_t lost      = 0;
+        uint64_t reordered = 0;
+        double   minUs     = 0.0;
+        double   meanUs    = 0.0;
+        double   p50Us     = 0.0;   // percentiles are bucket upper edges
+        double   p95Us     = 0.0;
+        double   p99Us     = 0.0;
+        double   maxUs     = 0.0;
+        std::vector<uint32_t> histogram;   // kBuckets counts, kBucketUs wide
+    };
+
+    void sent(uint16_t seq, int64_t tNs);
+    void echoed(uint16_t seq, int64_t tNs);
+
+    Snapshot snapshot() const;
+    void reset() { resetRequested_.store(true, std::memory_order_release); }
+
+private:
+    struct Pending {
+        uint16_t seq      = 0;
+        bool     answered = true;
+        int64_t  sentNs   = 0;
+    };
+
+    void applyReset_();
+    void record_(int64_t us);
+
+    // Feeding thread only
+    std::array<Pending, kWindow> pending_{};
+    uint16_t lastEcho_     = 0;
+    uint16_t newestAcked_  = 0;
+    bool     haveAcked_    = false;
+
+    // Readable from any thread
+    std::array<std::atomic<uint32_t>, kBuckets> buckets_{};
+    std::atomic<uint64_t> samples_{0}, sumUs_{0}, lost_{0}, reordered_{0};
+    std::atomic<int64_t>  minUs_{-1}, maxUs_{0};
+    std::atomic<bool>     resetRequested_{false};
+};
+
+#endif // ROUNDTRIPTRACKER_H
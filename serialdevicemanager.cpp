@@ -0,0 +1,206 @@
+#include "serialdevicemanager.h"
+
+#include <QDebug>
+#include <QFileInfo>
+#include <QMetaObject>
+#include <QSerialPortInfo>
+
+#include <algorithm>
+
+SerialDeviceManager::SerialDeviceManager(int tx_payload_len, int rx_payload_len, QObject* parent)
+    : QObject(parent),
+    tx_len_(tx_payload_len),
+    rx_len_(rx_payload_len)
+{
+    scanPool_.setMaxThreadCount(1);
+    connect(&pollTimer_, &QTimer::timeout, this, &SerialDeviceManager::scan_);
+}
+
+SerialDeviceManager::~SerialDeviceManager()
+{
+    stop();
+}
+
+void SerialDeviceManager::addPort(const QString& port_name)
+{
+    if (!port_name.isEmpty() && !extraPorts_.contains(port_name)) extraPorts_ << port_name;
+}
+
+void SerialDeviceManager::start(int pollMs)
+{
+    pollTimer_.start(pollMs);
+    scan_();
+}
+
+void SerialDeviceManager::stop()
+{
+    pollTimer_.stop();
+    scanPool_.waitForDone();
+
+    // Interfaces still probing stop at their next wait (their destructor sets the abort flag)
+    qDeleteAll(probing_);
+    probing_.clear();
+    for (Device& d : devices_) {
+        if (!d.serial) continue;
+        emit deviceDisconnected(d.stats.id);
+        delete d.serial;
+        d.serial = nullptr;
+        d.stats.connected = false;
+    }
+}
+
+SerialInterface* SerialDeviceManager::device(int id) const
+{
+    const auto it = devices_.constFind(id);
+    return it == devices_.constEnd() ? nullptr : it->serial;
+}
+
+QVector<SerialDeviceManager::DeviceStats> SerialDeviceManager::devices() const
+{
+    QVector<DeviceStats> out;
+    for (const Device& d : devices_) out.push_back(d.stats);
+    std::sort(out.begin(), out.end(), [](const DeviceStats& a, const DeviceStats& b){ return a.id < b.id; });
+    return out;
+}
+
+// ======================= Discovery =======================
+
+void SerialDeviceManager::scan_()
+{
+    if (scanPending_) return;
+    scanPending_ = true;
+
+    // availablePorts() can take tens of milliseconds on Windows; keep it off the GUI thread
+    const QStringList extra = extraPorts_;
+    scanPool_.start([this, extra](){
+        QStringList present;
+        for (const QSerialPortInfo& info : QSerialPortInfo::availablePorts()) {
+            if (SerialInterface::isCandidatePort(info)) present << info.portName();
+        }
+        for (const QString& port : extra) {
+            if (!present.contains(port) && QFileInfo::exists(port)) present << port;
+        }
+        QMetaObject::invokeMethod(this, [this, present](){ onPorts_(present); }, Qt::QueuedConnection);
+    });
+}
+
+void SerialDeviceManager::onPorts_(const QStringList& present)
+{
+    scanPending_ = false;
+    if (!pollTimer_.isActive()) return;   // stopped meanwhile
+
+    // Unplugged while attached
+    for (Device& d : devices_) {
+        if (d.serial && !present.contains(d.stats.port)) drop_(d.stats.id, "port removed");
+    }
+
+    // Unplugged while probing: the probe fails on its own and is cleaned up in onProbeFinished_()
+    for (auto it = ignored_.begin(); it != ignored_.end();) {
+        if (present.contains(*it)) ++it;
+        else                       it = ignored_.erase(it);
+    }
+
+    for (const QString& port : present) {
+        if (probing_.contains(port) || ignored_.contains(port)) continue;
+        const bool attached = std::any_of(devices_.cbegin(), devices_.cend(), [&](const Device& d){
+            return d.serial && d.stats.port == port;
+        });
+        if (!attached) startProbe_(port);
+    }
+}
+
+void SerialDeviceManager::startProbe_(const QString& port)
+{
+    auto* serial = new SerialInterface(tx_len_, rx_len_);
+    probing_.insert(port, serial);
+
+    connect(serial, &SerialInterface::probeFinished, this, [this, port, serial](bool ok){
+        onProbeFinished_(port, serial, ok);
+    });
+    connect(serial, &SerialInterface::disconnected, this, [this, serial](){
+        const int id = idOf_(serial);
+        if (id >= 0) drop_(id, "port error");
+    });
+    // Probing foreign ports is noisy; only attached controllers report errors
+    connect(serial, &SerialInterface::errorOccurred, this, [this, serial](const QString& message){
+        if (idOf_(serial) >= 0) emit errorOccurred(message);
+    });
+
+    serial->probe(port, baud_, kIdentifyTimeoutMs, baudCandidates_);
+}
+
+void SerialDeviceManager::onProbeFinished_(const QString& port, SerialInterface* serial, bool ok)
+{
+    if (probing_.value(port) != serial) return;   // stop() already deleted it
+    probing_.remove(port);
+
+    const SerialInterface::DeviceInfo info = serial->deviceInfo();
+    if (!ok || info.id < 0) {
+        qDebug() << "[Devices]" << port << "did not identify as a controller";
+        ignored_.insert(port);
+        serial->deleteLater();
+        return;
+    }
+
+    Device& d = devices_[info.id];
+    if (d.serial) {
+        emit errorOccurred(QString("[Devices] %1: device id %2 is already attached on %3 — ignored.")
+                               .arg(port).arg(info.id).arg(d.stats.port));
+        ignored_.insert(port);
+        serial->deleteLater();
+        return;
+    }
+
+    d.serial          = serial;
+    d.stats.id        = info.id;
+    d.stats.name      = info.name;
+    d.stats.firmware  = info.firmware;
+    d.stats.port      = port;
+    d.stats.connected = true;
+    ++d.stats.connects;
+
+    QString how = "connected";
+    if (d.lostNs != 0) {
+        const double ms = double(SerialLog::monotonicNs() - d.lostNs) / 1e6;
+        ++d.stats.reconnects;
+        d.reconnectSumMs += ms;
+        d.stats.lastReconnectMs = ms;
+        d.stats.meanReconnectMs = d.reconnectSumMs / d.stats.reconnects;
+        d.stats.maxReconnectMs  = std::max(d.stats.maxReconnectMs, ms);
+        d.lostNs = 0;
+        how = QString("reconnected in %1 ms").arg(ms, 0, 'f', 0);
+    }
+    qDebug().noquote() << QString("[Devices] #%1 %2 (fw %3) on %4 at %5 baud, %6")
+                              .arg(info.id).arg(info.name).arg(info.firmware).arg(port)
+                              .arg(serial->baudRate()).arg(how);
+
+    if (setup_) setup_(serial);
+    emit deviceConnected(info.id, serial);
+}
+
+void SerialDeviceManager::drop_(int id, const char* reason)
+{
+    Device& d = devices_[id];
+    if (!d.serial) return;
+
+    qDebug() << "[Devices] #" << id << "lost on" << d.stats.port << "(" << reason << ")";
+
+    SerialInterface* serial = d.serial;
+    d.serial          = nullptr;
+    d.stats.connected = false;
+    d.lostNs          = SerialLog::monotonicNs();
+
+    emit deviceDisconnected(id);
+    serial->deleteLater();
+
+    // Look for it again right away rather than on the next poll
+    scan_();
+}
+
+int SerialDeviceManager::idOf_(const SerialInterface* serial) const
+{
+    for (const Device& d : devices_) {
+        if (d.serial == serial) return d.stats.id;
+    }
+    return -1;
+}
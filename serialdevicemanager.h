@@ -0,0 +1,118 @@
+#ifndef SERIALDEVICEMANAGER_H
+#define SERIALDEVICEMANAGER_H
+
+#pragma once
+#include <QHash>
+#include <QList>
+#include <QObject>
+#include <QSet>
+#include <QString>
+#include <QStringList>
+#include <QThreadPool>
+#include <QTimer>
+#include <QVector>
+
+#include <functional>
+
+#include "SerialInterface.h"
+
+/**
+ * @brief Finds EquipmentControllers on the serial ports and keeps them connected.
+ *
+ * Usage:
+ *   SerialDeviceManager devices(30, 22);
+ *   devices.setSetup([](SerialInterface* s){ s->setProtocol(SerialInterface::Protocol::V2); });
+ *   connect(&devices, &SerialDeviceManager::deviceConnected, ...);   // (id, interface)
+ *   devices.start();
+ *
+ * Discovery:
+ *   The port list is polled (QtSerialPort has no hot-plug notification) on a pool thread, so
+ *   enumeration never stalls the GUI. Every new candidate port gets its own SerialInterface,
+ *   which opens it and runs the Identify handshake on its own I/O thread: all ports are probed
+ *   at the same time. The firmware answers with its device id (set per board in the sketch),
+ *   so several controllers (e.g. outer and inner tube) can be attached at once.
+ *   Ports that do not answer are skipped until they disappear and come back.
+ *
+ * Hot-plug:
+ *   A controller whose port vanishes or reports a resource error is dropped (deviceDisconnected,
+ *   then its interface is deleted) and picked up again on the next poll after it reappears.
+ *   Reconnect time = loss detected -> handshake (and baud negotiation) done on the new interface.
+ *
+ * Interfaces belong to the manager; receivers must drop their pointer on deviceDisconnected.
+ */
+class SerialDeviceManager : public QObject
+{
+    Q_OBJECT
+public:
+    using Setup = std::function<void(SerialInterface*)>;
+
+    struct DeviceStats {
+        int     id        = -1;
+        QString name;
+        QString port;
+        int     firmware  = 0;
+        bool    connected = false;
+        int     connects  = 0;
+        int     reconnects = 0;
+        double  lastReconnectMs = 0.0;
+        double  meanReconnectMs = 0.0;
+        double  maxReconnectMs  = 0.0;
+    };
+
+    explicit SerialDeviceManager(int tx_payload_len, int rx_payload_len, QObject* parent = nullptr);
+    ~SerialDeviceManager() override;
+
+    // Applied to each interface right after its handshake, before deviceConnected
+    void setSetup(Setup setup) { setup_ = std::move(setup); }
+
+    // Probed whenever it exists, even if the system does not list it (e.g. /tmp/ttyBENDEMO)
+    void addPort(const QString& port_name);
+
+    void setBaudRate(int baud) { baud_ = baud; }
+    void setBaudCandidates(const QList<int>& rates) { baudCandidates_ = rates; }   // negotiated after the handshake
+
+    void start(int pollMs = 500);
+    void stop();
+
+    SerialInterface*     device(int id) const;
+    QVector<DeviceStats> devices() const;
+
+signals:
+    void deviceConnected(int id, SerialInterface* serial);
+    void deviceDisconnected(int id);   // the interface is deleted once control returns to the event loop
+    void errorOccurred(const QString& message);
+
+private:
+    static constexpr int kIdentifyTimeoutMs = 3000;   // covers the Uno's bootloader after open
+
+    struct Device {
+        DeviceStats      stats;
+        SerialInterface* serial = nullptr;
+        qint64           lostNs = 0;        // 0 = not waiting for a reconnect
+        double           reconnectSumMs = 0.0;
+    };
+
+    void scan_();
+    void onPorts_(const QStringList& present);
+    void startProbe_(const QString& port);
+    void onProbeFinished_(const QString& port, SerialInterface* serial, bool ok);
+    void drop_(int id, const char* reason);
+    int  idOf_(const SerialInterface* serial) const;
+
+    const int tx_len_;
+    const int rx_len_;
+    int        baud_ = 115200;
+    QList<int> baudCandidates_;
+    Setup      setup_;
+
+    QTimer      pollTimer_;
+    QThreadPool scanPool_;          // one thread: port enumeration
+    bool        scanPending_ = false;
+    QStringList extraPorts_;
+
+    QHash<QString, SerialInterface*> probing_;   // port -> interface running the handshake
+    QSet<QString>                    ignored_;   // present, but not a controller
+    QHash<int, Device>               devices_;   // by firmware device id
+};
+
+#endif // SERIALDEVICEMANAGER_H
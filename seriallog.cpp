@@ -0,0 +1,267 @@
+#include "seriallog.h"
+
+#include <QDateTime>
+#include <QTextStream>
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+#include "telemetryview.h"
+
+// ======================== SerialLog ========================
+
+int64_t SerialLog::monotonicNs()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+bool SerialLog::convertToCsv(const QString& binaryPath, const QString& csvPath,
+                             Direction dir, QString* error, bool decode)
+{
+    auto fail = [error](const QString& msg) {
+        if (error) *error = msg;
+        return false;
+    };
+
+    QFile in(binaryPath);
+    if (!in.open(QIODevice::ReadOnly)) return fail("Cannot open " + binaryPath);
+
+    FileHeader header;
+    if (in.read(reinterpret_cast<char*>(&header), sizeof(header)) != qint64(sizeof(header))
+        || std::memcmp(header.magic, "BDSL", 4) != 0) {
+        return fail("Not a BDSL log: " + binaryPath);
+    }
+    if (header.version != 1) return fail(QString("Unsupported BDSL version %1").arg(header.version));
+    in.seek(header.headerSize);
+
+    QFile out(csvPath);
+    if (!out.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text)) {
+        return fail("Cannot write " + csvPath);
+    }
+
+    QTextStream s(&out);
+#if QT_VERSION >= QT_VERSION_CHECK(6,0,0)
+    s.setEncoding(QStringConverter::Utf8);
+#endif
+
+    const int width = dir == Direction::Rx ? header.rxLen : header.txLen;
+    decode = decode && dir == Direction::Rx && size_t(width) >= TelemetrySchema::kImageLength;
+    s << "timestamp";
+    for (int i = 0; i < width; ++i) s << ",b" << i;
+    if (decode) {
+        for (const TelemetrySchema::Field& f : TelemetrySchema::kFields) {
+            s << ',' << f.name;
+            if (*f.unit) s << '[' << f.unit << ']';
+        }
+    }
+    s << '\n';
+
+    const QDateTime start = QDateTime::fromMSecsSinceEpoch(header.startUnixMs);
+    QByteArray payload;
+    RecordHeader rec;
+    while (in.read(reinterpret_cast<char*>(&rec), sizeof(rec)) == qint64(sizeof(rec))) {
+        payload = in.read(rec.len);
+        if (payload.size() != rec.len) break;   // truncated tail (recording was cut off)
+        if (rec.dir != uint8_t(dir)) continue;
+
+        const qint64 offsetMs = (rec.tNs - header.startNs) / 1000000;
+        s << start.addMSecs(offsetMs).toString("yyyy-MM-dd HH:mm:ss.zzz");
+        for (int i = 0; i < payload.size(); ++i) {
+            s << ',' << static_cast<unsigned char>(payload.at(i));
+        }
+        if (decode) {
+            const TelemetryView t(payload);
+            for (size_t i = 0; i < TelemetrySchema::kFieldCount; ++i) {
+                s << ',';
+                if (t.valid()) s << t.value(TelemetrySchema::Id(i));
+            }
+        }
+        s << '\n';
+    }
+    return true;
+}
+
+// ======================== SerialLogWriter ========================
+
+SerialLogWriter::SerialLogWriter()
+    : queue_(std::make_unique<SpscQueue<Record, kQueueDepth>>())
+{
+}
+
+SerialLogWriter::~SerialLogWriter()
+{
+    stop();
+}
+
+bool SerialLogWriter::start(const QString& path, int rxLen, int txLen, QString* error)
+{
+    stop();
+
+    file_.setFileName(path);
+    if (!file_.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        if (error) *error = file_.errorString();
+        return false;
+    }
+
+    SerialLog::FileHeader header;
+    header.rxLen = uint16_t(rxLen);
+    header.txLen = uint16_t(txLen);
+    header.startNs = SerialLog::monotonicNs();
+    header.startUnixMs = QDateTime::currentMSecsSinceEpoch();
+    file_.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    Record discard;
+    while (queue_->pop(discard)) {}
+
+    stopRequested_.store(false, std::memory_order_release);
+    running_.store(true, std::memory_order_release);
+    thread_ = std::thread([this] { run_(); });
+    return true;
+}
+
+void SerialLogWriter::stop()
+{
+    if (!thread_.joinable()) return;
+    running_.store(false, std::memory_order_release);
+    stopRequested_.store(true, std::memory_order_release);
+    thread_.join();
+    file_.close();
+}
+
+bool SerialLogWriter::append(SerialLog::Direction dir, const uint8_t* payload, int len, int64_t tNs)
+{
+    if (!running_.load(std::memory_order_acquire)) return false;
+    if (len < 0 || len > kMaxPayload) {
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    Record r;
+    r.header.tNs = tNs;
+    r.header.dir = uint8_t(dir);
+    r.header.len = uint16_t(len);
+    std::memcpy(r.payload, payload, size_t(len));
+
+    if (!queue_->push(r)) {
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    return true;
+}
+
+void SerialLogWriter::run_()
+{
+    constexpr int kChunk = 256 * 1024;
+    QByteArray buffer;
+    buffer.reserve(kChunk + int(sizeof(Record)));
+
+    auto lastFlush = std::chrono::steady_clock::now();
+    Record r;
+
+    for (;;) {
+        const bool stopping = stopRequested_.load(std::memory_order_acquire);
+
+        int drained = 0;
+        while (queue_->pop(r)) {
+            buffer.append(reinterpret_cast<const char*>(&r.header), sizeof(r.header));
+            buffer.append(reinterpret_cast<const char*>(r.payload), r.header.len);
+            ++drained;
+            if (buffer.size() >= kChunk) {
+                file_.write(buffer);
+                buffer.resize(0);
+            }
+        }
+        written_.fetch_add(uint64_t(drained), std::memory_order_relaxed);
+
+        const auto now = std::chrono::steady_clock::now();
+        if (stopping || now - lastFlush >= std::chrono::seconds(1)) {
+            if (!buffer.isEmpty()) {
+                file_.write(buffer);
+                buffer.resize(0);
+            }
+            file_.flush();
+            lastFlush = now;
+        }
+
+        if (stopping) break;   // queue was drained after the stop request was seen
+        if (drained == 0) std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+}
+
+// ======================== SerialLogReader ========================
+
+bool SerialLogReader::open(const QString& path, QString* error)
+{
+    auto fail = [this, error](const QString& msg) {
+        close();
+        if (error) *error = msg;
+        return false;
+    };
+
+    close();
+    file_.setFileName(path);
+    if (!file_.open(QIODevice::ReadOnly)) return fail("Cannot open " + path);
+
+    size_ = file_.size();
+    if (size_ < qint64(sizeof(SerialLog::FileHeader))) return fail("Too short for a BDSL log: " + path);
+
+    data_ = file_.map(0, size_);
+    if (!data_) return fail("Cannot map " + path + ": " + file_.errorString());
+
+    std::memcpy(&header_, data_, sizeof(header_));
+    if (std::memcmp(header_.magic, "BDSL", 4) != 0) return fail("Not a BDSL log: " + path);
+    if (header_.version != 1) return fail(QString("Unsupported BDSL version %1").arg(header_.version));
+
+    // ---- Index ----
+    uint64_t off = header_.headerSize;
+    bool sorted = true;
+    index_.reserve(size_t((size_ - off) / (sizeof(SerialLog::RecordHeader) + header_.rxLen)) + 1);
+    while (off + sizeof(SerialLog::RecordHeader) <= uint64_t(size_)) {
+        SerialLog::RecordHeader rec;
+        std::memcpy(&rec, data_ + off, sizeof(rec));
+        if (off + sizeof(rec) + rec.len > uint64_t(size_)) break;   // truncated tail
+
+        if (!index_.empty() && rec.tNs < index_.back().tNs) sorted = false;
+        index_.push_back({rec.tNs, off});
+        off += sizeof(rec) + rec.len;
+    }
+
+    // TX records are stamped when queued, so they can be slightly out of order
+    if (!sorted) {
+        std::stable_sort(index_.begin(), index_.end(),
+                         [](const Entry& a, const Entry& b) { return a.tNs < b.tNs; });
+    }
+    return true;
+}
+
+void SerialLogReader::close()
+{
+    if (data_) file_.unmap(const_cast<uchar*>(data_));
+    data_ = nullptr;
+    size_ = 0;
+    index_.clear();
+    if (file_.isOpen()) file_.close();
+}
+
+SerialLogReader::Record SerialLogReader::at(size_t i) const
+{
+    const Entry& e = index_[i];
+    SerialLog::RecordHeader rec;
+    std::memcpy(&rec, data_ + e.offset, sizeof(rec));
+
+    Record r;
+    r.tNs     = rec.tNs;
+    r.dir     = SerialLog::Direction(rec.dir);
+    r.payload = data_ + e.offset + sizeof(rec);
+    r.len     = rec.len;
+    return r;
+}
+
+size_t SerialLogReader::lowerBound(int64_t tNs) const
+{
+    const auto it = std::lower_bound(index_.begin(), index_.end(), tNs,
+                                     [](const Entry& e, int64_t t) { return e.tNs < t; });
+    return size_t(it - index_.begin());
+}
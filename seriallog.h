@@ -0,0 +1,175 @@
+#ifndef SERIALLOG_H
+#define SERIALLOG_H
+
+#pragma once
+#include <QByteArray>
+#include <QFile>
+#include <QString>
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "spscqueue.h"
+
+/**
+ * Binary append-only serial log ("BDSL").
+ *
+ * File layout (little endian):
+ *   Header (32 bytes)
+ *     char[4] magic        "BDSL"
+ *     u16     version      1
+ *     u16     headerSize   32
+ *     u16     rxLen        RX payload length (schema)
+ *     u16     txLen        TX payload length (schema)
+ *     i64     startNs      monotonic clock at start (same clock as record timestamps)
+ *     i64     startUnixMs  wall clock at start, to turn timestamps back into dates
+ *     u32     reserved
+ *   Records, back to back
+ *     i64     tNs          monotonic timestamp
+ *     u8      dir          0 = RX, 1 = TX
+ *     u8      reserved
+ *     u16     len          payload length
+ *     u8[len] payload      raw (decoded) payload
+ */
+namespace SerialLog {
+
+enum class Direction : uint8_t { Rx = 0, Tx = 1 };
+
+#pragma pack(push, 1)
+struct FileHeader {
+    char     magic[4]    = {'B', 'D', 'S', 'L'};
+    uint16_t version     = 1;
+    uint16_t headerSize  = sizeof(FileHeader);
+    uint16_t rxLen       = 0;
+    uint16_t txLen       = 0;
+    int64_t  startNs     = 0;
+    int64_t  startUnixMs = 0;
+    uint32_t reserved    = 0;
+};
+
+struct RecordHeader {
+    int64_t  tNs      = 0;
+    uint8_t  dir      = 0;
+    uint8_t  reserved = 0;
+    uint16_t len      = 0;
+};
+#pragma pack(pop)
+
+static_assert(sizeof(FileHeader) == 32, "BDSL header must stay 32 bytes");
+static_assert(sizeof(RecordHeader) == 12, "BDSL record header must stay 12 bytes");
+
+// Monotonic clock used for every timestamp in the log (steady_clock, ns)
+int64_t monotonicNs();
+
+// Writes the RX (or TX) records of a binary log in the CSV layout used by the
+// old recorder: "timestamp,b0,b1,..." with "yyyy-MM-dd HH:mm:ss.zzz" timestamps.
+// `decode` appends one column per telemetry schema field (RX only, scaled values).
+bool convertToCsv(const QString& binaryPath, const QString& csvPath,
+                  Direction dir = Direction::Rx, QString* error = nullptr, bool decode = false);
+
+} // namespace SerialLog
+
+/**
+ * Asynchronous writer for the binary serial log.
+ *
+ * - append() is called by ONE thread (the serial I/O thread): it copies the
+ *   payload into a lock-free SPSC slot and returns; no formatting, no I/O.
+ * - A background thread drains the queue into a large buffer and writes it
+ *   out in big chunks, flushing at least once per second.
+ */
+class SerialLogWriter
+{
+public:
+    SerialLogWriter();
+    ~SerialLogWriter();
+
+    SerialLogWriter(const SerialLogWriter&) = delete;
+    SerialLogWriter& operator=(const SerialLogWriter&) = delete;
+
+    bool start(const QString& path, int rxLen, int txLen, QString* error = nullptr);
+    void stop();
+    bool isRunning() const { return running_.load(std::memory_order_acquire); }
+
+    // Producer side. Returns false when the queue is full (record dropped).
+    bool append(SerialLog::Direction dir, const uint8_t* payload, int len, int64_t tNs);
+
+    uint64_t written() const { return written_.load(std::memory_order_relaxed); }
+    uint64_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+private:
+    static constexpr int    kMaxPayload = 256;
+    static constexpr size_t kQueueDepth = 4096;
+
+    struct Record {
+        SerialLog::RecordHeader header;
+        uint8_t payload[kMaxPayload];
+    };
+
+    void run_();
+
+    QFile       file_;
+    std::thread thread_;
+    std::atomic<bool> running_{false};
+    std::atomic<bool> stopRequested_{false};
+
+    std::unique_ptr<SpscQueue<Record, kQueueDepth>> queue_;   // ~1 MB, kept off the stack
+    std::atomic<uint64_t> written_{0};
+    std::atomic<uint64_t> dropped_{0};
+};
+
+/**
+ * Memory-mapped reader for binary serial logs.
+ *
+ * - The whole file is mapped once (QFile::map); records are returned as
+ *   pointers into the mapping, nothing is copied.
+ * - open() builds an index sorted by timestamp, so lowerBound() can seek to
+ *   any point of a recording in O(log n).
+ * - A truncated last record (recording cut off) is ignored.
+ */
+class SerialLogReader
+{
+public:
+    struct Record {
+        int64_t              tNs     = 0;
+        SerialLog::Direction dir     = SerialLog::Direction::Rx;
+        const uint8_t*       payload = nullptr;
+        int                  len     = 0;
+    };
+
+    SerialLogReader() = default;
+    ~SerialLogReader() { close(); }
+
+    SerialLogReader(const SerialLogReader&) = delete;
+    SerialLogReader& operator=(const SerialLogReader&) = delete;
+
+    bool open(const QString& path, QString* error = nullptr);
+    void close();
+    bool isOpen() const { return data_ != nullptr; }
+
+    const SerialLog::FileHeader& header() const { return header_; }
+
+    size_t size() const { return index_.size(); }
+    Record at(size_t i) const;
+
+    // First record with tNs >= t (size() if none)
+    size_t  lowerBound(int64_t tNs) const;
+    int64_t firstNs() const { return index_.empty() ? 0 : index_.front().tNs; }
+    int64_t lastNs()  const { return index_.empty() ? 0 : index_.back().tNs; }
+
+private:
+    struct Entry {
+        int64_t  tNs;
+        uint64_t offset;   // of the record header inside the mapping
+    };
+
+    QFile              file_;
+    const uint8_t*     data_ = nullptr;
+    qint64             size_ = 0;
+    SerialLog::FileHeader header_;
+    std::vector<Entry> index_;
+};
+
+#endif // SERIALLOG_H
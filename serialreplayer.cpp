@@ -0,0 +1,101 @@
+#include "serialreplayer.h"
+
+#include <QDebug>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+SerialReplayer::~SerialReplayer()
+{
+    stop();
+}
+
+bool SerialReplayer::start(const QString& path, double speed, Sink sink, QString* error)
+{
+    stop();
+    if (!reader_.open(path, error)) return false;
+
+    sink_  = std::move(sink);
+    speed_ = std::max(0.0, speed);
+    report_ = Report();
+    stopRequested_.store(false, std::memory_order_release);
+    running_.store(true, std::memory_order_release);
+    thread_ = std::thread([this] { run_(); });
+    return true;
+}
+
+void SerialReplayer::stop()
+{
+    stopRequested_.store(true, std::memory_order_release);
+    wait();
+}
+
+SerialReplayer::Report SerialReplayer::wait()
+{
+    if (thread_.joinable()) thread_.join();
+    reader_.close();
+    return report_;
+}
+
+void SerialReplayer::run_()
+{
+    using clock = std::chrono::steady_clock;
+
+    const int64_t firstNs = reader_.firstNs();
+    const auto t0 = clock::now();
+
+    uint64_t frames = 0;
+    double   sumErrUs = 0.0, maxErrUs = 0.0;
+    bool     completed = true;
+
+    for (size_t i = 0; i < reader_.size(); ++i) {
+        if (stopRequested_.load(std::memory_order_acquire)) { completed = false; break; }
+
+        const SerialLogReader::Record r = reader_.at(i);
+        if (r.dir != SerialLog::Direction::Rx) continue;
+
+        clock::time_point due = clock::now();
+        if (speed_ > 0.0) {
+            const auto offset = std::chrono::nanoseconds(int64_t(double(r.tNs - firstNs) / speed_));
+            due = t0 + std::chrono::duration_cast<clock::duration>(offset);
+
+            // Coarse sleep, then spin the last stretch for sub-millisecond accuracy
+            const auto spinFrom = due - std::chrono::microseconds(1500);
+            if (clock::now() < spinFrom) std::this_thread::sleep_until(spinFrom);
+            while (clock::now() < due) std::this_thread::yield();
+        }
+
+        while (!sink_(r.payload, r.len)) {
+            if (stopRequested_.load(std::memory_order_acquire)) { completed = false; break; }
+            std::this_thread::yield();
+        }
+        if (!completed) break;
+
+        const double errUs = std::abs(std::chrono::duration<double, std::micro>(clock::now() - due).count());
+        if (speed_ > 0.0) {
+            sumErrUs += errUs;
+            maxErrUs = std::max(maxErrUs, errUs);
+        }
+        ++frames;
+    }
+
+    Report rep;
+    rep.frames      = frames;
+    rep.speed       = speed_;
+    rep.wallSec     = std::chrono::duration<double>(clock::now() - t0).count();
+    rep.recordedSec = double(reader_.lastNs() - firstNs) / 1e9;
+    rep.fps         = rep.wallSec > 0.0 ? double(frames) / rep.wallSec : 0.0;
+    rep.meanErrUs   = frames ? sumErrUs / double(frames) : 0.0;
+    rep.maxErrUs    = maxErrUs;
+    rep.completed   = completed;
+    report_ = rep;
+
+    qDebug() << "[SerialReplayer]" << rep.frames << "frames in" << rep.wallSec << "s ("
+             << rep.fps << "fps, recorded" << rep.recordedSec << "s, speed"
+             << (rep.speed > 0.0 ? QString::number(rep.speed) : QString("max")) << "), timing error"
+             << rep.meanErrUs << "us mean /" << rep.maxErrUs << "us max"
+             << (rep.completed ? "" : "(stopped)");
+
+    running_.store(false, std::memory_order_release);
+}
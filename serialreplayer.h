@@ -0,0 +1,70 @@
+#ifndef SERIALREPLAYER_H
+#define SERIALREPLAYER_H
+
+#pragma once
+#include <QString>
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <thread>
+
+#include "seriallog.h"
+
+/**
+ * Timed replay of a binary serial log.
+ *
+ * Usage:
+ *   SerialReplayer replayer;
+ *   replayer.start(path, 1.0, [&](const uint8_t* p, int n) { return serial.injectReceived(p, n); });
+ *
+ * - speed > 0 : original pacing scaled by `speed` (1.0 = real time, 2.0 = twice as fast)
+ * - speed == 0: as fast as the sink accepts frames
+ * - Only RX records are replayed. The sink returns false when it cannot take a
+ *   frame yet; the replayer then retries, so nothing is dropped at max speed.
+ *
+ * Timing error is the difference between the scheduled and the actual hand-off
+ * time of each frame.
+ */
+class SerialReplayer
+{
+public:
+    using Sink = std::function<bool(const uint8_t* payload, int len)>;
+
+    struct Report {
+        uint64_t frames      = 0;
+        double   speed       = 0.0;
+        double   wallSec     = 0.0;
+        double   recordedSec = 0.0;
+        double   fps         = 0.0;
+        double   meanErrUs   = 0.0;   // |actual - scheduled|
+        double   maxErrUs    = 0.0;
+        bool     completed   = false; // false = stopped early
+    };
+
+    SerialReplayer() = default;
+    ~SerialReplayer();
+
+    SerialReplayer(const SerialReplayer&) = delete;
+    SerialReplayer& operator=(const SerialReplayer&) = delete;
+
+    bool start(const QString& path, double speed, Sink sink, QString* error = nullptr);
+    void stop();
+    bool isRunning() const { return running_.load(std::memory_order_acquire); }
+
+    // Blocks until the replay thread finishes (or returns at once if none)
+    Report wait();
+
+private:
+    void run_();
+
+    SerialLogReader   reader_;
+    Sink              sink_;
+    double            speed_ = 1.0;
+    std::thread       thread_;
+    std::atomic<bool> running_{false};
+    std::atomic<bool> stopRequested_{false};
+    Report            report_;
+};
+
+#endif // SERIALREPLAYER_H
@@ -0,0 +1,68 @@
+#ifndef SPSCQUEUE_H
+#define SPSCQUEUE_H
+
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <new>
+#include <utility>
+
+/**
+ * Bounded lock-free single-producer / single-consumer ring.
+ *
+ * - Capacity is a power of two; one producer thread calls push(), one consumer
+ *   thread calls pop(). No allocation after construction.
+ * - head_/tail_ sit on separate cache lines, and each side keeps a cached copy
+ *   of the other's index so the common case touches only its own line.
+ */
+template <class T, size_t Capacity>
+class SpscQueue
+{
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+public:
+    SpscQueue() = default;
+    SpscQueue(const SpscQueue&) = delete;
+    SpscQueue& operator=(const SpscQueue&) = delete;
+
+    // Producer. Returns false (and drops the value) when full.
+    bool push(const T& value)
+    {
+        const size_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail - headCache_ == Capacity) {
+            headCache_ = head_.load(std::memory_order_acquire);
+            if (tail - headCache_ == Capacity) return false;
+        }
+        slots_[tail & (Capacity - 1)] = value;
+        tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer. Returns false when empty.
+    bool pop(T& out)
+    {
+        const size_t head = head_.load(std::memory_order_relaxed);
+        if (head == tailCache_) {
+            tailCache_ = tail_.load(std::memory_order_acquire);
+            if (head == tailCache_) return false;
+        }
+        out = std::move(slots_[head & (Capacity - 1)]);
+        head_.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool   empty() const { return head_.load(std::memory_order_acquire) == tail_.load(std::memory_order_acquire); }
+    size_t size()  const { return tail_.load(std::memory_order_acquire) - head_.load(std::memory_order_acquire); }
+    static constexpr size_t capacity() { return Capacity; }
+
+private:
+    static constexpr size_t kLine = 64;
+
+    alignas(kLine) std::atomic<size_t> head_{0};   // consumer-owned
+    size_t tailCache_ = 0;                         // consumer's view of tail_
+    alignas(kLine) std::atomic<size_t> tail_{0};   // producer-owned
+    size_t headCache_ = 0;                         // producer's view of head_
+    alignas(kLine) T slots_[Capacity];
+};
+
+#endif // SPSCQUEUE_H
@@ -0,0 +1,266 @@
+#include "striplabeler.h"
+
+// OpenCV
+#include <opencv2/core.hpp>
+#include <opencv2/core/utility.hpp>
+#include <opencv2/imgproc.hpp>
+
+#include <algorithm>
+#include <limits>
+
+// ======================== Helpers ========================
+
+namespace {
+
+struct Run {
+    int row;
+    int start; // first column
+    int end;   // one past the last column
+};
+
+// Union-find with path halving; the smaller index becomes the root.
+int findRoot(std::vector<int>& parent, int i)
+{
+    while (parent[i] != i) {
+        parent[i] = parent[parent[i]];
+        i = parent[i];
+    }
+    return i;
+}
+
+void unite(std::vector<int>& parent, int a, int b)
+{
+    a = findRoot(parent, a);
+    b = findRoot(parent, b);
+    if (a == b) return;
+    if (a < b) parent[b] = a;
+    else       parent[a] = b;
+}
+
+// Calls fn(i, j) for every pair of 8-connected runs between two consecutive rows.
+// Both ranges are sorted by start column.
+template <class Fn>
+void forEachTouchingPair(const Run* upper, int nUpper, int upperBase,
+                         const Run* lower, int nLower, int lowerBase, Fn fn)
+{
+    int j = 0;
+    for (int i = 0; i < nLower; ++i) {
+        const Run& r = lower[i];
+        // [ps, pe) touches [s, e) diagonally when ps <= e && pe >= s
+        while (j < nUpper && upper[j].end < r.start) ++j;
+        for (int k = j; k < nUpper && upper[k].start <= r.end; ++k) {
+            fn(lowerBase + i, upperBase + k);
+        }
+    }
+}
+
+struct Strip {
+    int rowBegin = 0;
+    int rowEnd   = 0;
+    std::vector<Run> runs;
+    std::vector<int> parent;   // local union-find over runs
+    int firstRowRuns = 0;      // runs on rowBegin (at the front of runs)
+    int lastRowBegin = 0;      // index of the first run on rowEnd - 1
+};
+
+void labelStrip(const uint8_t* data, size_t step, int cols, Strip& s)
+{
+    s.runs.clear();
+    s.parent.clear();
+
+    int prevBegin = 0, prevCount = 0;
+    for (int r = s.rowBegin; r < s.rowEnd; ++r) {
+        const uint8_t* row = data + size_t(r) * step;
+        const int rowBegin = int(s.runs.size());
+
+        int c = 0;
+        while (c < cols) {
+            while (c < cols && row[c] == 0) ++c;
+            if (c >= cols) break;
+            const int start = c;
+            while (c < cols && row[c] != 0) ++c;
+
+            const int idx = int(s.runs.size());
+            s.runs.push_back({r, start, c});
+            s.parent.push_back(idx);
+        }
+
+        const int rowCount = int(s.runs.size()) - rowBegin;
+        if (r == s.rowBegin) s.firstRowRuns = rowCount;
+        s.lastRowBegin = rowBegin;
+
+        if (r > s.rowBegin && prevCount > 0 && rowCount > 0) {
+            forEachTouchingPair(s.runs.data() + prevBegin, prevCount, prevBegin,
+                                s.runs.data() + rowBegin,  rowCount,  rowBegin,
+                                [&s](int a, int b) { unite(s.parent, a, b); });
+        }
+        prevBegin = rowBegin;
+        prevCount = rowCount;
+    }
+
+    // Flatten so the merge step starts from local roots
+    for (int i = 0; i < int(s.parent.size()); ++i) {
+        s.parent[i] = findRoot(s.parent, i);
+    }
+}
+
+} // namespace
+
+// ======================== Public ========================
+
+StripLabeler::StripLabeler(int topK, int strips)
+{
+    setTopK(topK);
+    setStrips(strips);
+}
+
+void StripLabeler::setTopK(int k)
+{
+    topK_ = std::max(1, k);
+}
+
+void StripLabeler::setStrips(int n)
+{
+    strips_ = std::max(0, n);
+}
+
+int StripLabeler::label(const cv::Mat& mask, std::vector<Component>& out) const
+{
+    CV_Assert(mask.type() == CV_8UC1);
+    return label(mask.ptr<uint8_t>(), mask.step, mask.rows, mask.cols, out);
+}
+
+int StripLabeler::label(const uint8_t* data, size_t step, int rows, int cols,
+                        std::vector<Component>& out) const
+{
+    out.clear();
+    if (!data || rows <= 0 || cols <= 0) return 0;
+
+    // ---- Label strips in parallel ----
+    int nStrips = strips_ > 0 ? strips_ : std::max(1, cv::getNumThreads());
+    nStrips = std::min(nStrips, rows);
+
+    std::vector<Strip> strips(nStrips);
+    for (int i = 0; i < nStrips; ++i) {
+        strips[i].rowBegin = int(int64_t(rows) * i / nStrips);
+        strips[i].rowEnd   = int(int64_t(rows) * (i + 1) / nStrips);
+    }
+
+    cv::parallel_for_(cv::Range(0, nStrips), [&](const cv::Range& range) {
+        for (int i = range.start; i < range.end; ++i) {
+            labelStrip(data, step, cols, strips[i]);
+        }
+    }, nStrips);
+
+    // ---- Stitch strip boundaries ----
+    std::vector<int> offset(nStrips + 1, 0);
+    for (int i = 0; i < nStrips; ++i) offset[i + 1] = offset[i] + int(strips[i].runs.size());
+    const int totalRuns = offset[nStrips];
+    if (totalRuns == 0) return 0;
+
+    std::vector<int> parent(totalRuns);
+    for (int i = 0; i < nStrips; ++i) {
+        const Strip& s = strips[i];
+        for (int k = 0; k < int(s.parent.size()); ++k) parent[offset[i] + k] = offset[i] + s.parent[k];
+    }
+
+    for (int i = 0; i + 1 < nStrips; ++i) {
+        const Strip& upper = strips[i];
+        const Strip& lower = strips[i + 1];
+        if (upper.runs.empty() || lower.firstRowRuns == 0) continue;
+        if (upper.runs.back().row != upper.rowEnd - 1) continue; // last row empty
+
+        const int nUpper = int(upper.runs.size()) - upper.lastRowBegin;
+        forEachTouchingPair(upper.runs.data() + upper.lastRowBegin, nUpper, offset[i] + upper.lastRowBegin,
+                            lower.runs.data(), lower.firstRowRuns, offset[i + 1],
+                            [&parent](int a, int b) { unite(parent, a, b); });
+    }
+
+    // ---- Accumulate stats per component ----
+    struct Acc {
+        int64_t area = 0, sumX = 0, sumY = 0, first = 0;
+        int minX = 0, minY = 0, maxX = 0, maxY = 0;
+    };
+    std::vector<int> slot(totalRuns, -1);
+    std::vector<Acc> acc;
+
+    for (int i = 0; i < nStrips; ++i) {
+        const Strip& s = strips[i];
+        for (int k = 0; k < int(s.runs.size()); ++k) {
+            const Run& run = s.runs[k];
+            const int root = findRoot(parent, offset[i] + k);
+            const int64_t len = run.end - run.start;
+
+            int& idx = slot[root];
+            if (idx < 0) {
+                // Runs are visited in raster order, so the first run seen is the first pixel.
+                idx = int(acc.size());
+                Acc a;
+                a.first = int64_t(run.row) * cols + run.start;
+                a.minX = run.start; a.maxX = run.end - 1;
+                a.minY = a.maxY = run.row;
+                acc.push_back(a);
+            }
+            Acc& a = acc[idx];
+            a.area += len;
+            a.sumX += len * (run.start + run.end - 1) / 2; // exact: len * (first + last) is even
+            a.sumY += len * run.row;
+            a.minX = std::min(a.minX, run.start);
+            a.maxX = std::max(a.maxX, run.end - 1);
+            a.maxY = std::max(a.maxY, run.row);
+        }
+    }
+
+    // ---- Top-K ----
+    const int count = int(acc.size());
+    std::vector<int> order(count);
+    for (int i = 0; i < count; ++i) order[i] = i;
+
+    const int k = std::min(topK_, count);
+    std::partial_sort(order.begin(), order.begin() + k, order.end(), [&acc](int a, int b) {
+        if (acc[a].area != acc[b].area) return acc[a].area > acc[b].area;
+        return acc[a].first < acc[b].first;
+    });
+
+    out.reserve(k);
+    for (int i = 0; i < k; ++i) {
+        const Acc& a = acc[order[i]];
+        Component c;
+        c.area   = int(a.area);
+        c.left   = a.minX;
+        c.top    = a.minY;
+        c.width  = a.maxX - a.minX + 1;
+        c.height = a.maxY - a.minY + 1;
+        c.cx     = double(a.sumX) / double(a.area);
+        c.cy     = double(a.sumY) / double(a.area);
+        c.firstPixel = a.first;
+        out.push_back(c);
+    }
+    return count;
+}
+
+bool StripLabeler::matchesOpenCV(const cv::Mat& mask) const
+{
+    std::vector<Component> mine;
+    const int count = label(mask, mine);
+
+    cv::Mat labels, stats, centroids;
+    const int num = cv::connectedComponentsWithStats(mask, labels, stats, centroids, 8, CV_32S);
+    if (num - 1 != count) return false;
+    if (count == 0) return true;
+
+    // Same selection rule as DarknessDetector: first label with the strictly largest area
+    int maxLabel = 1;
+    for (int i = 2; i < num; ++i) {
+        if (stats.at<int>(i, cv::CC_STAT_AREA) > stats.at<int>(maxLabel, cv::CC_STAT_AREA)) maxLabel = i;
+    }
+
+    const Component& c = mine.front();
+    return c.area   == stats.at<int>(maxLabel, cv::CC_STAT_AREA)
+        && c.left   == stats.at<int>(maxLabel, cv::CC_STAT_LEFT)
+        && c.top    == stats.at<int>(maxLabel, cv::CC_STAT_TOP)
+        && c.width  == stats.at<int>(maxLabel, cv::CC_STAT_WIDTH)
+        && c.height == stats.at<int>(maxLabel, cv::CC_STAT_HEIGHT)
+        && c.cx     == centroids.at<double>(maxLabel, 0)
+        && c.cy     == centroids.at<double>(maxLabel, 1);
+}
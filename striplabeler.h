@@ -0,0 +1,59 @@
+#ifndef STRIPLABELER_H
+#define STRIPLABELER_H
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// ---- OpenCV forward decl to keep the header light ----
+namespace cv { class Mat; }
+
+/**
+ * Parallel connected-component labeler for binary masks (8-connectivity).
+ *
+ * - The mask is split into horizontal strips that are labeled concurrently
+ *   (cv::parallel_for_) as runs of foreground pixels with a per-strip union-find.
+ * - Strips are stitched along their boundary rows with a global union-find.
+ * - Only area / bounding box / centroid of the top-K components are kept;
+ *   no label image is produced.
+ *
+ * Ordering matches cv::connectedComponentsWithStats: components are ranked by
+ * area, ties go to the component whose first pixel comes first in raster order,
+ * and centroids are computed the same way (integer sums / area).
+ */
+class StripLabeler
+{
+public:
+    struct Component {
+        int     area   = 0;
+        int     left   = 0;
+        int     top    = 0;
+        int     width  = 0;
+        int     height = 0;
+        double  cx     = 0.0;   // centroid (x), pixel units
+        double  cy     = 0.0;   // centroid (y)
+        int64_t firstPixel = 0; // raster index of the first pixel (row * cols + col)
+    };
+
+    explicit StripLabeler(int topK = 1, int strips = 0);
+
+    void setTopK(int k);
+    void setStrips(int n);   // 0 = one strip per OpenCV worker thread
+    int  topK()   const { return topK_; }
+    int  strips() const { return strips_; }
+
+    // Returns the number of components found; out holds the largest min(topK, count).
+    int label(const cv::Mat& mask, std::vector<Component>& out) const;
+    int label(const uint8_t* data, size_t step, int rows, int cols,
+              std::vector<Component>& out) const;
+
+    // Compares the largest component with cv::connectedComponentsWithStats (bit-exact).
+    bool matchesOpenCV(const cv::Mat& mask) const;
+
+private:
+    int topK_   = 1;
+    int strips_ = 0;
+};
+
+#endif // STRIPLABELER_H
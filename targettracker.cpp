@@ -0,0 +1,135 @@
+#include "targettracker.h"
+
+#include <algorithm>
+
+bool TargetTracker::update(int64_t stampNs, double x, double y)
+{
+    if (initialized_ && stampNs < stampNs_) {
+        ++outOfOrder_;
+        return false;
+    }
+
+    bool restart = !initialized_;
+    if (!restart) {
+        const double dt = double(stampNs - stampNs_) / 1e9;
+        if (dt > options_.maxGapSec) {
+            restart = true;
+        } else {
+            propagate_(x_, dt);
+            propagate_(y_, dt);
+            const double gate2 = options_.gateSigma * options_.gateSigma;
+            if (options_.gateSigma > 0.0 && innovation2_(x_, x) + innovation2_(y_, y) > gate2) restart = true;
+        }
+    }
+
+    if (restart) {
+        if (initialized_) ++restarts_;
+        start_(x_, x);
+        start_(y_, y);
+        initialized_ = true;
+    } else {
+        correct_(x_, x);
+        correct_(y_, y);
+    }
+    stampNs_ = stampNs;
+    ++updates_;
+    return true;
+}
+
+bool TargetTracker::predict(int64_t atNs, Estimate& out) const
+{
+    if (!initialized_) return false;
+
+    const double dt = std::max(0.0, double(atNs - stampNs_) / 1e9);
+    if (dt > options_.maxCoastSec) return false;
+
+    Axis ax = x_, ay = y_;
+    propagate_(ax, dt);
+    propagate_(ay, dt);
+
+    out.x = ax.s[0];     out.y = ay.s[0];
+    out.vx = ax.s[1];    out.vy = ay.s[1];
+    out.varX = ax.P[0][0];
+    out.varY = ay.P[0][0];
+    out.ageSec = dt;
+    return true;
+}
+
+// ======================= Filter =======================
+
+void TargetTracker::start_(Axis& axis, double z) const
+{
+    axis = Axis();
+    axis.s[0] = z;
+    axis.P[0][0] = options_.measurementNoisePx * options_.measurementNoisePx;
+    axis.P[1][1] = options_.initialVelocityPx * options_.initialVelocityPx;
+    if (dim_() == 3) axis.P[2][2] = options_.initialAccelPx * options_.initialAccelPx;
+}
+
+void TargetTracker::propagate_(Axis& axis, double dt) const
+{
+    if (dt <= 0.0) return;
+
+    const int n = dim_();
+    const double dt2 = dt * dt, dt3 = dt2 * dt;
+
+    // Transition F
+    double F[3][3] = {{1.0, dt, 0.0}, {0.0, 1.0, dt}, {0.0, 0.0, 1.0}};
+    if (n == 3) F[0][2] = dt2 * 0.5;
+
+    // Discretized white-noise covariance Q
+    const double q = options_.processNoise;
+    double Q[3][3] = {};
+    if (n == 2) {
+        Q[0][0] = q * dt3 / 3.0; Q[0][1] = q * dt2 / 2.0;
+        Q[1][0] = Q[0][1];       Q[1][1] = q * dt;
+    } else {
+        const double dt4 = dt3 * dt, dt5 = dt4 * dt;
+        Q[0][0] = q * dt5 / 20.0; Q[0][1] = q * dt4 / 8.0; Q[0][2] = q * dt3 / 6.0;
+        Q[1][1] = q * dt3 / 3.0;  Q[1][2] = q * dt2 / 2.0;
+        Q[2][2] = q * dt;
+        Q[1][0] = Q[0][1]; Q[2][0] = Q[0][2]; Q[2][1] = Q[1][2];
+    }
+
+    double s[3] = {};
+    for (int i = 0; i < n; ++i)
+        for (int k = 0; k < n; ++k) s[i] += F[i][k] * axis.s[k];
+
+    // P = F P F^T + Q
+    double FP[3][3] = {};
+    for (int i = 0; i < n; ++i)
+        for (int j = 0; j < n; ++j)
+            for (int k = 0; k < n; ++k) FP[i][j] += F[i][k] * axis.P[k][j];
+    for (int i = 0; i < n; ++i)
+        for (int j = 0; j < n; ++j) {
+            double v = Q[i][j];
+            for (int k = 0; k < n; ++k) v += FP[i][k] * F[j][k];
+            axis.P[i][j] = v;
+        }
+    for (int i = 0; i < n; ++i) axis.s[i] = s[i];
+}
+
+double TargetTracker::innovation2_(const Axis& axis, double z) const
+{
+    const double r = options_.measurementNoisePx * options_.measurementNoisePx;
+    const double e = z - axis.s[0];
+    return e * e / (axis.P[0][0] + r);
+}
+
+void TargetTracker::correct_(Axis& axis, double z) const
+{
+    // H = [1 0 0]: the gain is the first column of P over the innovation variance
+    const int n = dim_();
+    const double S = axis.P[0][0] + options_.measurementNoisePx * options_.measurementNoisePx;
+    const double e = z - axis.s[0];
+
+    double K[3] = {};
+    for (int i = 0; i < n; ++i) K[i] = axis.P[i][0] / S;
+    for (int i = 0; i < n; ++i) axis.s[i] += K[i] * e;
+
+    // P = (I - K H) P
+    double row0[3];
+    for (int j = 0; j < n; ++j) row0[j] = axis.P[0][j];
+    for (int i = 0; i < n; ++i)
+        for (int j = 0; j < n; ++j) axis.P[i][j] -= K[i] * row0[j];
+}
@@ -0,0 +1,93 @@
+#ifndef TARGETTRACKER_H
+#define TARGETTRACKER_H
+
+#pragma once
+#include <cstdint>
+
+/**
+ * @brief Kalman tracker for the detected target in image space (constant velocity or constant acceleration).
+ *
+ * Usage:
+ *   TargetTracker tracker;                          // constant velocity, defaults below
+ *   tracker.update(captureNs, x, y);                // each detection, stamped at capture
+ *   TargetTracker::Estimate e;
+ *   if (tracker.predict(nowNs, e)) use(e.x, e.y);   // any time, e.g. every control tick
+ *
+ * Model:
+ *   x and y are filtered independently: state [p, v] (or [p, v, a]) per axis, driven by
+ *   continuous white acceleration (jerk) noise of spectral density processNoise.
+ *   Detections are position-only measurements with measurementNoisePx standard deviation.
+ *   predict() extrapolates without changing the filter, so it can be called at any rate.
+ *
+ * Robustness:
+ *   - A detection older than the last one is ignored (outOfOrder()).
+ *   - A gap longer than maxGapSec, or an innovation beyond gateSigma, restarts the track
+ *     at the new detection (the target was lost or another region won).
+ *   - predict() fails once the last detection is older than maxCoastSec.
+ *
+ * Plain C++ (no Qt): shared by ControlLoop and the BendemoBatch evaluation.
+ * Not thread-safe; one owner thread.
+ */
+class TargetTracker
+{
+public:
+    enum class Model { ConstantVelocity, ConstantAcceleration };
+
+    struct Options {
+        Model  model              = Model::ConstantVelocity;
+        double processNoise       = 4.0e4;   // px^2/s^3 (CV) or px^2/s^5 (CA)
+        double measurementNoisePx = 3.0;
+        double initialVelocityPx  = 500.0;   // px/s, 1 sigma of a new track's velocity
+        double initialAccelPx     = 2000.0;  // px/s^2, CA only
+        double maxCoastSec        = 0.5;
+        double maxGapSec          = 1.0;
+        double gateSigma          = 8.0;     // 0 = accept every detection
+    };
+
+    struct Estimate {
+        double x = 0.0, y = 0.0;       // px
+        double vx = 0.0, vy = 0.0;     // px/s
+        double varX = 0.0, varY = 0.0; // position variance, px^2
+        double ageSec = 0.0;           // since the last detection
+    };
+
+    TargetTracker() = default;
+    explicit TargetTracker(const Options& options) : options_(options) {}
+
+    void setOptions(const Options& options) { options_ = options; reset(); }
+    const Options& options() const { return options_; }
+
+    void reset() { initialized_ = false; }
+    bool isInitialized() const { return initialized_; }
+
+    // Returns false if the detection was dropped (out of order); a restart counts as accepted.
+    bool update(int64_t stampNs, double x, double y);
+    bool predict(int64_t atNs, Estimate& out) const;
+
+    uint64_t updates()    const { return updates_; }
+    uint64_t restarts()   const { return restarts_; }
+    uint64_t outOfOrder() const { return outOfOrder_; }
+
+private:
+    struct Axis {
+        double s[3] = {0.0, 0.0, 0.0};   // p, v, a
+        double P[3][3] = {};
+    };
+
+    int  dim_() const { return options_.model == Model::ConstantAcceleration ? 3 : 2; }
+    void start_(Axis& axis, double z) const;
+    void propagate_(Axis& axis, double dt) const;
+    double innovation2_(const Axis& axis, double z) const;   // squared Mahalanobis distance
+    void correct_(Axis& axis, double z) const;
+
+    Options options_;
+    Axis    x_, y_;
+    int64_t stampNs_     = 0;
+    bool    initialized_ = false;
+
+    uint64_t updates_    = 0;
+    uint64_t restarts_   = 0;
+    uint64_t outOfOrder_ = 0;
+};
+
+#endif // TARGETTRACKER_H
@@ -0,0 +1,127 @@
+#ifndef TELEMETRYVIEW_H
+#define TELEMETRYVIEW_H
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+#include "inoFiles/EquipmentController/TelemetrySchema.h"
+
+/**
+ * Field table generated from the firmware's telemetry schema
+ * (inoFiles/EquipmentController/TelemetrySchema.h, the single definition for both sides).
+ *
+ * The table describes the fixed RX image that dataReceived() delivers for V1 and V2 alike.
+ * Overlapping or out-of-range fields fail to compile, in the image and in the V2 payload.
+ */
+namespace TelemetrySchema
+{
+    enum class Type : uint8_t { U8, U16, I16 };   // 2-byte fields are big endian
+
+    struct Field {
+        const char* name;
+        size_t      offset;
+        Type        type;
+        double      scale;   // physical = raw * scale
+        const char* unit;
+    };
+
+    enum class Id : int {
+#define TELEMETRY_ID(name, offset, type, scale, unit) name,
+        TELEMETRY_IMAGE_FIELDS(TELEMETRY_ID)
+#undef TELEMETRY_ID
+        Count
+    };
+
+    inline constexpr Field kFields[] = {
+#define TELEMETRY_FIELD(name, offset, type, scale, unit) { #name, offset, Type::type, scale, unit },
+        TELEMETRY_IMAGE_FIELDS(TELEMETRY_FIELD)
+    };
+
+    // V2 TELEMETRY payload (hand-written offsets; only checked here, decoded into the image above)
+    inline constexpr Field kV2Fields[] = {
+        TELEMETRY_V2_FIELDS(TELEMETRY_FIELD)
+#undef TELEMETRY_FIELD
+    };
+
+    constexpr size_t kFieldCount  = sizeof(kFields) / sizeof(kFields[0]);
+    constexpr size_t kImageLength = TELEMETRY_IMAGE_LENGTH;
+
+    constexpr size_t width(Type t) { return t == Type::U8 ? 1 : 2; }
+
+    template <size_t N>
+    constexpr bool layoutOk(const Field (&fields)[N], size_t length)
+    {
+        for (size_t i = 0; i < N; ++i) {
+            const size_t end = fields[i].offset + width(fields[i].type);
+            if (end > length) return false;
+            for (size_t j = i + 1; j < N; ++j) {
+                if (fields[j].offset < end && fields[i].offset < fields[j].offset + width(fields[j].type)) return false;
+            }
+        }
+        return true;
+    }
+    static_assert(layoutOk(kFields, kImageLength), "TelemetrySchema.h: fields overlap or run past TELEMETRY_IMAGE_LENGTH");
+    static_assert(layoutOk(kV2Fields, TELEMETRY_V2_LENGTH), "TelemetrySchema.h: V2 fields overlap or run past TELEMETRY_V2_LENGTH");
+    static_assert(kFieldCount == size_t(Id::Count), "TelemetrySchema.h: field table out of sync");
+}
+
+/**
+ * Typed, non-owning view over one RX image.
+ *
+ *   const TelemetryView t(payload);            // QByteArray, or (pointer, length)
+ *   if (t.valid()) qDebug() << t.roll() << t.pitch() << t.yaw();   // degrees
+ *
+ * Nothing is copied: the view points into the caller's buffer (which must outlive it)
+ * and each accessor decodes its field in place. `name()` returns the scaled value,
+ * `nameRaw()` the integer as sent; both exist for every schema field.
+ * Accessors require valid() (a buffer of at least kImageLength bytes).
+ */
+class TelemetryView
+{
+public:
+    using Id   = TelemetrySchema::Id;
+    using Type = TelemetrySchema::Type;
+
+    TelemetryView() = default;
+    TelemetryView(const uint8_t* data, size_t len)
+        : data_(data && len >= TelemetrySchema::kImageLength ? data : nullptr) {}
+
+    template <class Bytes>   // QByteArray, std::string, ...
+    explicit TelemetryView(const Bytes& bytes)
+        : TelemetryView(reinterpret_cast<const uint8_t*>(bytes.data()), size_t(bytes.size())) {}
+
+    bool valid() const { return data_ != nullptr; }
+    const uint8_t* data() const { return data_; }
+
+    // By id, for generic consumers (CSV export, labels)
+    int32_t raw(Id id) const
+    {
+        const TelemetrySchema::Field& f = TelemetrySchema::kFields[size_t(id)];
+        return decode_(f.type, f.offset);
+    }
+    double value(Id id) const { return raw(id) * TelemetrySchema::kFields[size_t(id)].scale; }
+
+#define TELEMETRY_ACCESSOR(name, offset, type, scale, unit)                                     \
+    int32_t name##Raw() const { return decode_(Type::type, offset); }                           \
+    double  name() const      { return decode_(Type::type, offset) * (scale); }
+    TELEMETRY_IMAGE_FIELDS(TELEMETRY_ACCESSOR)
+#undef TELEMETRY_ACCESSOR
+
+private:
+    // `type` and `offset` are constants in the generated accessors, so this folds to one load
+    int32_t decode_(Type type, size_t offset) const
+    {
+        const uint8_t* p = data_ + offset;
+        switch (type) {
+        case Type::U8:  return p[0];
+        case Type::U16: return int32_t((p[0] << 8) | p[1]);
+        case Type::I16: return int16_t(uint16_t((p[0] << 8) | p[1]));
+        }
+        return 0;
+    }
+
+    const uint8_t* data_ = nullptr;
+};
+
+#endif // TELEMETRYVIEW_H
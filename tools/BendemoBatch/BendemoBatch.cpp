@@ -0,0 +1,625 @@
+// ====================== BendemoBatch ======================
+/*
+ * Headless batch detection over saved frames and videos (no Qt Widgets).
+ *
+ *   BendemoBatch [options] <image dir | image | video>...
+ *
+ * Every decoded image is run through DarknessDetector::detect once per parameter
+ * set (the cartesian product of the comma-separated sweep options), and optionally
+ * through YoloExecutor. Work is spread over a work-stealing thread pool.
+ *
+ * Example:
+ *   BendemoBatch ./SavedImages -t 30,40,50 -a 0.01,0.02 -p 1,4 -o sweep.csv
+ *
+ * --compare-pyramid also runs every pyramid set at full resolution on the same image and
+ * reports mean IoU, the largest centroid error, disagreements (one side found nothing)
+ * and the speed-up. Run it on recorded frames before turning the pyramid on in the app:
+ *
+ *   BendemoBatch ./SavedImages -p 1,4,8 --compare-pyramid
+ *
+ * With more than one parameter set the detect() latency is also reported per set.
+ * For StripLabeler thread scaling keep one worker, so the strips have the cores to
+ * themselves, and check the labels against OpenCV on the same masks:
+ *
+ *   BendemoBatch ./SavedImages -j 1 -s 0,2,4,8 --verify-labeler
+ *
+ * --track-eval replays the detections of the first parameter set as a time series
+ * (videos at their own frame rate, still images per directory at --fps) and measures
+ * how well the target is predicted at every frame when only every n-th detection is
+ * delivered, --track-latency ms after capture: last detection held vs. TargetTracker.
+ *
+ *   BendemoBatch ./SavedVideos --track-eval --track-rates 30,10,5 --track-latency 80
+ */
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDataStream>
+#include <QDebug>
+#include <QDirIterator>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QHash>
+#include <QImage>
+#include <QMap>
+#include <QTextStream>
+
+#include <opencv2/core.hpp>
+#include <opencv2/imgproc.hpp>
+#include <opencv2/videoio.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <condition_variable>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "darknessdetector.h"
+#include "striplabeler.h"
+#include "targettracker.h"
+#include "workstealingpool.h"
+#include "yoloexecutor.h"
+
+namespace {
+
+const QStringList kImageSuffixes = {"jpg", "jpeg", "png", "bmp"};
+const QStringList kVideoSuffixes = {"mp4", "avi", "mov", "mkv", "wmv"};
+
+constexpr quint16 kYoloParamSet = 0xFFFF;
+
+struct ParamSet {
+    DarknessDetector::Options options;
+};
+
+struct Job {
+    QString source;      // file path
+    int     frame = 0;   // frame index for videos, 0 for still images
+    QImage  image;       // pre-decoded (videos); empty = load `source` in the task
+};
+
+struct Row {
+    quint32 job = 0;
+    quint16 paramSet = 0;
+    qint16  rank = -1;   // -1 = nothing found
+    Detector::DetectedObject object;
+    quint32 latencyUs = 0;
+};
+
+// Per-worker results, merged after the run (no locking on the hot path)
+struct WorkerState {
+    std::vector<Row>    rows;
+    std::vector<double> detectMs;   // one entry per detect() call
+    std::vector<std::vector<double>> setMs;   // detect() calls, per parameter set
+    std::vector<double> imageMs;    // decode + every parameter set for one image
+    std::vector<DarknessDetector::PyramidReport> pyramid; // per parameter set
+    quint64 labelerChecks = 0;
+    quint64 labelerMismatches = 0;
+    quint64 decodeFailures = 0;
+};
+
+QVector<double> parseDoubles(const QString& text)
+{
+    QVector<double> out;
+    for (const QString& part : text.split(',', Qt::SkipEmptyParts)) {
+        bool ok = false;
+        const double v = part.trimmed().toDouble(&ok);
+        if (ok) out.push_back(v);
+    }
+    return out;
+}
+
+double percentile(std::vector<double>& values, double p)
+{
+    if (values.empty()) return 0.0;
+    const size_t idx = std::min(values.size() - 1, size_t(p / 100.0 * (values.size() - 1) + 0.5));
+    std::nth_element(values.begin(), values.begin() + idx, values.end());
+    return values[idx];
+}
+
+void printLatency(const char* label, std::vector<double> values)
+{
+    if (values.empty()) return;
+    const double p50 = percentile(values, 50.0);
+    const double p90 = percentile(values, 90.0);
+    const double p99 = percentile(values, 99.0);
+    const double pmax = *std::max_element(values.begin(), values.end());
+    std::printf("%-22s p50 %8.3f ms   p90 %8.3f ms   p99 %8.3f ms   max %8.3f ms   (n=%zu)\n",
+                label, p50, p90, p99, pmax, values.size());
+}
+
+// ---- Tracker evaluation ----
+
+// One detection time series (a video, or the still images of one directory)
+struct TrackPoint {
+    double t = 0.0;          // s
+    bool   found = false;
+    double x = 0.0, y = 0.0; // centroid, source image px
+};
+
+struct TrackErrors {
+    std::vector<double> hold, cv, ca;   // px, one entry per evaluated frame
+    quint64 frames = 0;                 // frames with a ground-truth detection
+    quint64 cvMissing = 0, caMissing = 0;   // no prediction (track not started or coasted out)
+};
+
+// Every step-th frame's detection is delivered latencySec after capture
+void evaluateSequence(const std::vector<TrackPoint>& seq, int step, double frameSec, double latencySec,
+                      TrackErrors& out)
+{
+    // Coasting must outlast the simulated detection interval
+    TargetTracker::Options cvOptions;
+    cvOptions.maxCoastSec = cvOptions.maxGapSec = std::max(1.0, 3.0 * step * frameSec + latencySec);
+    TargetTracker::Options caOptions = cvOptions;
+    caOptions.model = TargetTracker::Model::ConstantAcceleration;
+    caOptions.processNoise = 4.0e6;
+    TargetTracker cv(cvOptions), ca(caOptions);
+
+    auto ns = [](double s) { return int64_t(s * 1e9); };
+
+    size_t next = 0;   // next delivered detection not yet handed over
+    bool   held = false;
+    double holdX = 0.0, holdY = 0.0;
+
+    for (const TrackPoint& now : seq) {
+        // Hand over every delivered detection that has arrived by now
+        while (next < seq.size() && seq[next].t + latencySec <= now.t) {
+            const TrackPoint& d = seq[next];
+            if (d.found && next % size_t(step) == 0) {
+                cv.update(ns(d.t), d.x, d.y);
+                ca.update(ns(d.t), d.x, d.y);
+                holdX = d.x;
+                holdY = d.y;
+                held = true;
+            }
+            ++next;
+        }
+        if (!now.found || !held) continue;
+
+        ++out.frames;
+        out.hold.push_back(std::hypot(holdX - now.x, holdY - now.y));
+
+        TargetTracker::Estimate e;
+        if (cv.predict(ns(now.t), e)) out.cv.push_back(std::hypot(e.x - now.x, e.y - now.y));
+        else ++out.cvMissing;
+        if (ca.predict(ns(now.t), e)) out.ca.push_back(std::hypot(e.x - now.x, e.y - now.y));
+        else ++out.caMissing;
+    }
+}
+
+QString errorSummary(std::vector<double> errors)
+{
+    if (errors.empty()) return "      -                 ";
+    double sq = 0.0;
+    for (double e : errors) sq += e * e;
+    return QString("%1 / %2")
+        .arg(std::sqrt(sq / double(errors.size())), 7, 'f', 2)
+        .arg(percentile(errors, 95.0), 7, 'f', 2);
+}
+
+// Bounds the number of decoded video frames waiting in the pool
+class InFlightLimiter
+{
+public:
+    explicit InFlightLimiter(int limit) : limit_(limit) {}
+    void acquire()
+    {
+        std::unique_lock<std::mutex> lock(m_);
+        cv_.wait(lock, [this] { return count_ < limit_; });
+        ++count_;
+    }
+    void release()
+    {
+        { std::lock_guard<std::mutex> lock(m_); --count_; }
+        cv_.notify_one();
+    }
+private:
+    std::mutex m_;
+    std::condition_variable cv_;
+    int count_ = 0;
+    const int limit_;
+};
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("BendemoBatch");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Headless batch detection over saved frames and videos.");
+    parser.addHelpOption();
+    parser.addPositionalArgument("inputs", "Image directories, image files or video files.");
+
+    QCommandLineOption thresholdOpt ({"t", "threshold"},  "Black threshold(s), comma separated.", "list", "40");
+    QCommandLineOption minAreaOpt   ({"a", "min-area"},   "Min area ratio(s), comma separated.", "list", "0.02");
+    QCommandLineOption pyramidOpt   ({"p", "pyramid"},    "Pyramid scale(s), comma separated (1 = off).", "list", "1");
+    QCommandLineOption stripsOpt    ({"s", "strips"},     "Labeler strips, comma separated (0 = OpenCV).", "list", "0");
+    QCommandLineOption maxResultsOpt({"k", "max-results"},"Regions reported per image.", "k", "1");
+    QCommandLineOption whiteMaskOpt ("white-mask",        "White mask top,left-right percent.", "top,rl", "5,3");
+    QCommandLineOption jobsOpt      ({"j", "jobs"},       "Worker threads (0 = all cores).", "n", "0");
+    QCommandLineOption outOpt       ({"o", "out"},        "CSV output file.", "path");
+    QCommandLineOption binaryOpt    ("binary",            "Binary output file.", "path");
+    QCommandLineOption yoloOpt      ("yolo",              "Also run YoloExecutor (serialized on one lane).");
+    QCommandLineOption cudaOpt      ("cuda",              "Run YOLO on CUDA.");
+    QCommandLineOption comparePyrOpt("compare-pyramid",   "Report pyramid accuracy/speed against full resolution.");
+    QCommandLineOption verifyLabOpt ("verify-labeler",    "Check StripLabeler against OpenCV on every mask.");
+    QCommandLineOption trackEvalOpt ("track-eval",        "Evaluate target prediction between detections (first parameter set).");
+    QCommandLineOption trackRateOpt ("track-rates",       "Detection rates to simulate in Hz, comma separated.", "list", "30,15,10,5");
+    QCommandLineOption trackLatOpt  ("track-latency",     "Detection latency in ms.", "ms", "0");
+    QCommandLineOption fpsOpt       ("fps",               "Frame rate of still image sequences.", "fps", "30");
+
+    parser.addOptions({thresholdOpt, minAreaOpt, pyramidOpt, stripsOpt, maxResultsOpt, whiteMaskOpt,
+                       jobsOpt, outOpt, binaryOpt, yoloOpt, cudaOpt, comparePyrOpt, verifyLabOpt,
+                       trackEvalOpt, trackRateOpt, trackLatOpt, fpsOpt});
+    parser.process(app);
+
+    if (parser.positionalArguments().isEmpty()) parser.showHelp(1);
+
+    // ---------------- Parameter sets ----------------
+    const QVector<double> wm = parseDoubles(parser.value(whiteMaskOpt));
+    const int maxResults = std::max(1, parser.value(maxResultsOpt).toInt());
+
+    std::vector<ParamSet> params;
+    for (double t : parseDoubles(parser.value(thresholdOpt)))
+        for (double a : parseDoubles(parser.value(minAreaOpt)))
+            for (double p : parseDoubles(parser.value(pyramidOpt)))
+                for (double s : parseDoubles(parser.value(stripsOpt))) {
+                    ParamSet ps;
+                    ps.options.blackThreshold = int(t);
+                    ps.options.minAreaRatio = float(a);
+                    ps.options.pyramidScale = std::clamp(int(p), 1, 8);
+                    ps.options.labelerStrips = std::max(0, int(s));
+                    ps.options.maxResults = maxResults;
+                    ps.options.whiteMaskTopPct = wm.size() > 0 ? int(wm[0]) : 0;
+                    ps.options.whiteMaskRightLeftPct = wm.size() > 1 ? int(wm[1]) : 0;
+                    params.push_back(ps);
+                }
+    if (params.empty()) {
+        std::fprintf(stderr, "No parameter sets.\n");
+        return 1;
+    }
+
+    // ---------------- Inputs ----------------
+    QStringList images, videos;
+    for (const QString& in : parser.positionalArguments()) {
+        const QFileInfo fi(in);
+        if (fi.isDir()) {
+            QDirIterator it(in, QDir::Files, QDirIterator::Subdirectories);
+            while (it.hasNext()) {
+                const QFileInfo f(it.next());
+                const QString suffix = f.suffix().toLower();
+                if (kImageSuffixes.contains(suffix)) images << f.filePath();
+                else if (kVideoSuffixes.contains(suffix)) videos << f.filePath();
+            }
+        } else if (fi.isFile()) {
+            (kVideoSuffixes.contains(fi.suffix().toLower()) ? videos : images) << fi.filePath();
+        } else {
+            std::fprintf(stderr, "Skipping missing input: %s\n", qPrintable(in));
+        }
+    }
+    images.sort();
+    videos.sort();
+
+    // ---------------- Detectors ----------------
+    const DarknessDetector darkness;   // detect() is const and re-entrant
+
+    std::unique_ptr<YoloExecutor> yolo;
+    std::mutex yoloMutex;
+    if (parser.isSet(yoloOpt)) {
+        yolo = std::make_unique<YoloExecutor>();
+        if (!yolo->Load(parser.isSet(cudaOpt))) {
+            std::fprintf(stderr, "YOLO load failed.\n");
+            return 1;
+        }
+    }
+
+    WorkStealingPool pool(parser.value(jobsOpt).toInt());
+    std::vector<WorkerState> workers(pool.size());
+    for (WorkerState& w : workers) {
+        w.pyramid.resize(params.size());
+        w.setMs.resize(params.size());
+    }
+
+    const bool comparePyramid = parser.isSet(comparePyrOpt);
+    const bool verifyLabeler = parser.isSet(verifyLabOpt);
+
+    std::vector<Job> jobs;           // index = job id (appended by the main thread only)
+    std::mutex jobsMutex;            // guards reallocation while workers read source names
+
+    auto process = [&](quint32 jobId, QImage image, int workerIndex) {
+        WorkerState& w = workers[workerIndex];
+        QElapsedTimer imageTimer;
+        imageTimer.start();
+
+        if (image.isNull()) {
+            QString path;
+            { std::lock_guard<std::mutex> lock(jobsMutex); path = jobs[jobId].source; }
+            image.load(path);
+            if (image.isNull()) { ++w.decodeFailures; return; }
+        }
+
+        QElapsedTimer t;
+        for (size_t p = 0; p < params.size(); ++p) {
+            const DarknessDetector::Options& options = params[p].options;
+
+            t.start();
+            const QVector<Detector::DetectedObject> res = darkness.detect(image, options);
+            const double ms = t.nsecsElapsed() / 1e6;
+            w.detectMs.push_back(ms);
+            w.setMs[p].push_back(ms);
+
+            Row row;
+            row.job = jobId;
+            row.paramSet = quint16(p);
+            row.latencyUs = quint32(ms * 1000.0);
+            if (res.isEmpty()) {
+                w.rows.push_back(row);
+            } else {
+                for (int r = 0; r < res.size(); ++r) {
+                    row.rank = qint16(r);
+                    row.object = res[r];
+                    w.rows.push_back(row);
+                }
+            }
+
+            if (comparePyramid && options.pyramidScale > 1) {
+                darkness.comparePyramid(image, options, w.pyramid[p]);
+            }
+
+            if (verifyLabeler) {
+                const QImage gray = image.convertToFormat(QImage::Format_Grayscale8);
+                const cv::Mat view(gray.height(), gray.width(), CV_8UC1,
+                                   const_cast<uchar*>(gray.constBits()), gray.bytesPerLine());
+                cv::Mat mask;
+                cv::threshold(view, mask, options.blackThreshold, 255, cv::THRESH_BINARY_INV);
+                ++w.labelerChecks;
+                if (!StripLabeler(1, std::max(2, options.labelerStrips)).matchesOpenCV(mask)) ++w.labelerMismatches;
+            }
+        }
+
+        if (yolo) {
+            t.start();
+            QVector<Detector::DetectedObject> res;
+            {
+                std::lock_guard<std::mutex> lock(yoloMutex);
+                res = yolo->Detect(std::make_shared<QImage>(image));
+            }
+            Row row;
+            row.job = jobId;
+            row.paramSet = kYoloParamSet;
+            row.latencyUs = quint32(t.nsecsElapsed() / 1000);
+            if (res.isEmpty()) {
+                w.rows.push_back(row);
+            } else {
+                row.rank = 0;
+                row.object = res[0];
+                w.rows.push_back(row);
+            }
+        }
+
+        w.imageMs.push_back(imageTimer.nsecsElapsed() / 1e6);
+    };
+
+    QElapsedTimer wall;
+    wall.start();
+
+    // Still images: decoding happens inside the tasks
+    {
+        std::lock_guard<std::mutex> lock(jobsMutex);
+        jobs.reserve(images.size());
+        for (const QString& path : images) jobs.push_back({path, 0, QImage()});
+    }
+    for (quint32 id = 0; id < quint32(images.size()); ++id) {
+        pool.submit([&process, id](int worker) { process(id, QImage(), worker); });
+    }
+
+    // Videos: decoded sequentially here, detection in parallel
+    InFlightLimiter limiter(pool.size() * 4);
+    QHash<QString, double> videoFps;
+    for (const QString& path : videos) {
+        cv::VideoCapture cap(path.toStdString());
+        if (!cap.isOpened()) {
+            std::fprintf(stderr, "Cannot open video: %s\n", qPrintable(path));
+            continue;
+        }
+        videoFps[path] = cap.get(cv::CAP_PROP_FPS);
+        cv::Mat bgr, rgb;
+        for (int frame = 0; cap.read(bgr); ++frame) {
+            cv::cvtColor(bgr, rgb, cv::COLOR_BGR2RGB);
+            QImage img = QImage(rgb.data, rgb.cols, rgb.rows, int(rgb.step), QImage::Format_RGB888).copy();
+
+            quint32 id;
+            {
+                std::lock_guard<std::mutex> lock(jobsMutex);
+                id = quint32(jobs.size());
+                jobs.push_back({path, frame, QImage()});
+            }
+            limiter.acquire();
+            pool.submit([&process, &limiter, id, img](int worker) {
+                process(id, img, worker);
+                limiter.release();
+            });
+        }
+    }
+
+    pool.waitIdle();
+    const double wallSec = wall.nsecsElapsed() / 1e9;
+
+    // ---------------- Merge ----------------
+    std::vector<Row> rows;
+    std::vector<double> detectMs, imageMs;
+    quint64 labelerChecks = 0, labelerMismatches = 0, decodeFailures = 0;
+    for (WorkerState& w : workers) {
+        rows.insert(rows.end(), w.rows.begin(), w.rows.end());
+        detectMs.insert(detectMs.end(), w.detectMs.begin(), w.detectMs.end());
+        imageMs.insert(imageMs.end(), w.imageMs.begin(), w.imageMs.end());
+        labelerChecks += w.labelerChecks;
+        labelerMismatches += w.labelerMismatches;
+        decodeFailures += w.decodeFailures;
+    }
+    std::sort(rows.begin(), rows.end(), [](const Row& a, const Row& b) {
+        if (a.job != b.job) return a.job < b.job;
+        if (a.paramSet != b.paramSet) return a.paramSet < b.paramSet;
+        return a.rank < b.rank;
+    });
+
+    // ---------------- Output ----------------
+    if (parser.isSet(outOpt)) {
+        QFile f(parser.value(outOpt));
+        if (!f.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text)) {
+            std::fprintf(stderr, "Cannot write %s\n", qPrintable(f.fileName()));
+            return 1;
+        }
+        QTextStream s(&f);
+        s << "source,frame,param_set,threshold,min_area,pyramid,strips,rank,x1,y1,x2,y2,cx,cy,score,latency_us\n";
+        for (const Row& r : rows) {
+            const Job& job = jobs[r.job];
+            s << job.source << ',' << job.frame << ',';
+            if (r.paramSet == kYoloParamSet) {
+                s << "yolo,,,,,";
+            } else {
+                const DarknessDetector::Options& o = params[r.paramSet].options;
+                s << r.paramSet << ',' << o.blackThreshold << ',' << o.minAreaRatio << ','
+                  << o.pyramidScale << ',' << o.labelerStrips << ',';
+            }
+            if (r.rank < 0) {
+                s << "-1,,,,,,,," << r.latencyUs << '\n';
+            } else {
+                const Detector::DetectedObject& o = r.object;
+                s << r.rank << ',' << o.x1 << ',' << o.y1 << ',' << o.x2 << ',' << o.y2 << ','
+                  << o.cx << ',' << o.cy << ',' << o.score << ',' << r.latencyUs << '\n';
+            }
+        }
+    }
+
+    if (parser.isSet(binaryOpt)) {
+        // Layout (little endian):
+        //   "BDBR", u16 version, u32 jobCount, u16 paramCount, u32 rowCount
+        //   jobs   : { QString source, i32 frame }
+        //   params : { i32 threshold, f32 minArea, i32 pyramid, i32 strips }
+        //   rows   : { u32 job, u16 param, i16 rank, i32 x1, y1, x2, y2, f32 cx, cy, score, u32 latencyUs }
+        QFile f(parser.value(binaryOpt));
+        if (!f.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+            std::fprintf(stderr, "Cannot write %s\n", qPrintable(f.fileName()));
+            return 1;
+        }
+        QDataStream s(&f);
+        s.setByteOrder(QDataStream::LittleEndian);
+        s.setFloatingPointPrecision(QDataStream::SinglePrecision);
+        s.writeRawData("BDBR", 4);
+        s << quint16(1) << quint32(jobs.size()) << quint16(params.size()) << quint32(rows.size());
+        for (const Job& job : jobs) s << job.source << qint32(job.frame);
+        for (const ParamSet& p : params) {
+            s << qint32(p.options.blackThreshold) << p.options.minAreaRatio
+              << qint32(p.options.pyramidScale) << qint32(p.options.labelerStrips);
+        }
+        for (const Row& r : rows) {
+            s << r.job << r.paramSet << r.rank
+              << qint32(r.object.x1) << qint32(r.object.y1) << qint32(r.object.x2) << qint32(r.object.y2)
+              << r.object.cx << r.object.cy << r.object.score << r.latencyUs;
+        }
+    }
+
+    // ---------------- Report ----------------
+    const size_t imageCount = imageMs.size();
+    std::printf("Images     : %zu (%zu still, %zu video frames, %llu failed)\n",
+                imageCount, size_t(images.size()), jobs.size() - size_t(images.size()),
+                static_cast<unsigned long long>(decodeFailures));
+    std::printf("Param sets : %zu%s\n", params.size(), yolo ? " + YOLO" : "");
+    std::printf("Workers    : %d (steals %llu)\n", pool.size(), static_cast<unsigned long long>(pool.steals()));
+    std::printf("Wall time  : %.3f s   ->   %.1f images/s, %.1f detections/s\n",
+                wallSec, imageCount / std::max(1e-9, wallSec), detectMs.size() / std::max(1e-9, wallSec));
+    printLatency("detect() latency", detectMs);
+    printLatency("per-image latency", imageMs);
+
+    if (params.size() > 1) {
+        std::printf("\ndetect() latency per parameter set:\n");
+        for (size_t p = 0; p < params.size(); ++p) {
+            std::vector<double> ms;
+            for (const WorkerState& w : workers) ms.insert(ms.end(), w.setMs[p].begin(), w.setMs[p].end());
+            const DarknessDetector::Options& o = params[p].options;
+            const QByteArray label = QString("t %1 a %2 p %3 s %4").arg(o.blackThreshold).arg(o.minAreaRatio)
+                                         .arg(o.pyramidScale).arg(o.labelerStrips).toLatin1();
+            printLatency(label.constData(), ms);
+        }
+    }
+
+    if (comparePyramid) {
+        for (size_t p = 0; p < params.size(); ++p) {
+            if (params[p].options.pyramidScale <= 1) continue;
+
+            DarknessDetector::PyramidReport sum;
+            for (const WorkerState& w : workers) {
+                const DarknessDetector::PyramidReport& r = w.pyramid[p];
+                if (r.validatedFrames == 0) continue;
+                const int n = sum.validatedFrames + r.validatedFrames;
+                sum.meanIoU       = (sum.meanIoU * sum.validatedFrames + r.meanIoU * r.validatedFrames) / n;
+                sum.meanPyramidMs = (sum.meanPyramidMs * sum.validatedFrames + r.meanPyramidMs * r.validatedFrames) / n;
+                sum.meanFullMs    = (sum.meanFullMs * sum.validatedFrames + r.meanFullMs * r.validatedFrames) / n;
+                sum.maxCenterErrPx = std::max(sum.maxCenterErrPx, r.maxCenterErrPx);
+                sum.disagreements += r.disagreements;
+                sum.validatedFrames = n;
+            }
+            std::printf("Pyramid 1/%d (set %zu): IoU %.4f, max center err %.2f px, disagreements %d/%d, "
+                        "%.3f ms vs %.3f ms full (x%.2f)\n",
+                        params[p].options.pyramidScale, p, sum.meanIoU, sum.maxCenterErrPx,
+                        sum.disagreements, sum.validatedFrames, sum.meanPyramidMs, sum.meanFullMs,
+                        sum.meanFullMs / std::max(1e-9, sum.meanPyramidMs));
+        }
+    }
+
+    if (parser.isSet(trackEvalOpt)) {
+        // Time series of the best region of parameter set 0, in job order
+        const double stillFps = std::max(1e-3, parser.value(fpsOpt).toDouble());
+        QMap<QString, std::vector<TrackPoint>> sequences;
+        QHash<QString, double> sequenceFps;
+        for (const Row& r : rows) {
+            if (r.paramSet != 0 || r.rank > 0) continue;
+            const Job& job = jobs[r.job];
+            const bool isVideo = videoFps.contains(job.source);
+            const QString key = isVideo ? job.source : QFileInfo(job.source).path();
+            const double fps = isVideo && videoFps[job.source] > 0.0 ? videoFps[job.source] : stillFps;
+            sequenceFps[key] = fps;
+
+            std::vector<TrackPoint>& seq = sequences[key];
+            TrackPoint p;
+            p.t = (isVideo ? job.frame : int(seq.size())) / fps;
+            p.found = r.rank == 0;
+            p.x = r.object.cx;
+            p.y = r.object.cy;
+            seq.push_back(p);
+        }
+
+        const double latencySec = std::max(0.0, parser.value(trackLatOpt).toDouble()) / 1000.0;
+        std::printf("\nTarget prediction, %lld sequence(s), latency %.0f ms  (error px: RMS / p95)\n",
+                    static_cast<long long>(sequences.size()), latencySec * 1000.0);
+        std::printf("%9s %8s  %-24s %-24s %-24s %s\n", "rate Hz", "frames", "hold last", "Kalman CV", "Kalman CA", "no prediction CV/CA");
+        for (double rate : parseDoubles(parser.value(trackRateOpt))) {
+            if (rate <= 0.0) continue;
+            TrackErrors total;
+            double effectiveHz = 0.0;
+            for (auto it = sequences.cbegin(); it != sequences.cend(); ++it) {
+                const double fps = sequenceFps[it.key()];
+                const int step = std::max(1, int(std::lround(fps / rate)));
+                effectiveHz = fps / step;
+                evaluateSequence(it.value(), step, 1.0 / fps, latencySec, total);
+            }
+            std::printf("%9.1f %8llu  %-24s %-24s %-24s %llu / %llu\n",
+                        effectiveHz, static_cast<unsigned long long>(total.frames),
+                        qPrintable(errorSummary(total.hold)), qPrintable(errorSummary(total.cv)),
+                        qPrintable(errorSummary(total.ca)),
+                        static_cast<unsigned long long>(total.cvMissing), static_cast<unsigned long long>(total.caMissing));
+        }
+    }
+
+    if (verifyLabeler) {
+        std::printf("StripLabeler vs OpenCV : %llu / %llu masks identical\n",
+                    static_cast<unsigned long long>(labelerChecks - labelerMismatches),
+                    static_cast<unsigned long long>(labelerChecks));
+    }
+
+    return (verifyLabeler && labelerMismatches > 0) ? 2 : 0;
+}
@@ -0,0 +1,150 @@
+#ifndef WORKSTEALINGPOOL_H
+#define WORKSTEALINGPOOL_H
+
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * Minimal work-stealing thread pool.
+ *
+ * - Each worker owns a deque; submit() distributes tasks round-robin.
+ * - A worker pops from the back of its own deque (LIFO, cache-warm) and,
+ *   when empty, steals from the front of the others (FIFO, oldest work).
+ * - waitIdle() blocks until every submitted task has finished.
+ *
+ * Tasks receive the index of the worker that runs them, so callers can keep
+ * per-worker scratch state without locking.
+ */
+class WorkStealingPool
+{
+public:
+    using Task = std::function<void(int workerIndex)>;
+
+    explicit WorkStealingPool(int threads)
+    {
+        const int n = threads > 0 ? threads : int(std::max(1u, std::thread::hardware_concurrency()));
+        queues_.reserve(n);
+        for (int i = 0; i < n; ++i) queues_.push_back(std::make_unique<Queue>());
+        for (int i = 0; i < n; ++i) workers_.emplace_back([this, i] { run_(i); });
+    }
+
+    ~WorkStealingPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(wakeMutex_);
+            stopping_ = true;
+        }
+        wake_.notify_all();
+        for (std::thread& t : workers_) t.join();
+    }
+
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    int size() const { return int(workers_.size()); }
+
+    void submit(Task task)
+    {
+        const size_t i = next_.fetch_add(1, std::memory_order_relaxed) % queues_.size();
+        pending_.fetch_add(1, std::memory_order_acq_rel);
+        {
+            std::lock_guard<std::mutex> lock(queues_[i]->mutex);
+            queues_[i]->tasks.push_back(std::move(task));
+        }
+        {
+            std::lock_guard<std::mutex> lock(wakeMutex_);
+            ++epoch_;
+        }
+        wake_.notify_one();
+    }
+
+    void waitIdle()
+    {
+        std::unique_lock<std::mutex> lock(wakeMutex_);
+        idle_.wait(lock, [this] { return pending_.load(std::memory_order_acquire) == 0; });
+    }
+
+    // Tasks executed by a worker that did not own them.
+    uint64_t steals() const { return steals_.load(std::memory_order_relaxed); }
+
+private:
+    struct Queue {
+        std::mutex       mutex;
+        std::deque<Task> tasks;
+    };
+
+    bool popOwn_(int i, Task& out)
+    {
+        Queue& q = *queues_[i];
+        std::lock_guard<std::mutex> lock(q.mutex);
+        if (q.tasks.empty()) return false;
+        out = std::move(q.tasks.back());
+        q.tasks.pop_back();
+        return true;
+    }
+
+    bool steal_(int thief, Task& out)
+    {
+        const int n = int(queues_.size());
+        for (int k = 1; k < n; ++k) {
+            Queue& q = *queues_[(thief + k) % n];
+            std::lock_guard<std::mutex> lock(q.mutex);
+            if (q.tasks.empty()) continue;
+            out = std::move(q.tasks.front());
+            q.tasks.pop_front();
+            steals_.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+        return false;
+    }
+
+    void run_(int i)
+    {
+        for (;;) {
+            uint64_t seen;
+            {
+                std::lock_guard<std::mutex> lock(wakeMutex_);
+                seen = epoch_;
+            }
+
+            Task task;
+            if (popOwn_(i, task) || steal_(i, task)) {
+                task(i);
+                if (pending_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                    std::lock_guard<std::mutex> lock(wakeMutex_);
+                    idle_.notify_all();
+                }
+                continue;
+            }
+
+            // Sleep until something new is submitted (epoch_ changes) or the pool stops
+            std::unique_lock<std::mutex> lock(wakeMutex_);
+            wake_.wait(lock, [this, seen] { return stopping_ || epoch_ != seen; });
+            if (stopping_) return;
+        }
+    }
+
+    std::vector<std::unique_ptr<Queue>> queues_;
+    std::vector<std::thread>            workers_;
+
+    std::mutex              wakeMutex_;
+    std::condition_variable wake_;
+    std::condition_variable idle_;
+    uint64_t                epoch_ = 0;
+    bool                    stopping_ = false;
+
+    std::atomic<size_t>   next_{0};
+    std::atomic<int64_t>  pending_{0};
+    std::atomic<uint64_t> steals_{0};
+};
+
+#endif // WORKSTEALINGPOOL_H
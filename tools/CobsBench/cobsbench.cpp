@@ -0,0 +1,160 @@
+// ====================== CobsBench ======================
+/*
+ * Decodes a synthetic COBS byte stream with CobsFramer and with the previous
+ * accumulate / indexOf / remove / decode-into-new-buffer scheme, and prints
+ * frames per second for both.
+ *
+ *   CobsBench [frames=1000000] [payload=22] [maxChunk=64]
+ *
+ * Chunk sizes are random in [1, maxChunk] to mimic readyRead() bursts.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include "cobsframer.h"
+
+namespace {
+
+std::vector<uint8_t> cobsEncode(const uint8_t* in, size_t n)
+{
+    std::vector<uint8_t> out;
+    out.reserve(n + n / 254 + 2);
+    size_t codeIndex = 0;
+    uint8_t code = 1;
+    out.push_back(0);
+    for (size_t k = 0; k < n; ++k) {
+        if (in[k] == 0) {
+            out[codeIndex] = code;
+            codeIndex = out.size();
+            out.push_back(0);
+            code = 1;
+        } else {
+            out.push_back(in[k]);
+            if (++code == 0xFF) {
+                out[codeIndex] = code;
+                codeIndex = out.size();
+                out.push_back(0);
+                code = 1;
+            }
+        }
+    }
+    out[codeIndex] = code;
+    return out;
+}
+
+// The previous SerialInterface scheme on std::vector: append chunk, find 0x00,
+// copy the frame out, erase it from the front, decode into a fresh buffer.
+std::vector<uint8_t> legacyDecode(const std::vector<uint8_t>& enc)
+{
+    std::vector<uint8_t> out;
+    out.reserve(enc.size());
+    size_t i = 0;
+    while (i < enc.size()) {
+        const uint8_t code = enc[i++];
+        if (code == 0) return {};
+        const size_t n = code - 1u;
+        if (i + n > enc.size()) return {};
+        out.insert(out.end(), enc.begin() + i, enc.begin() + i + n);
+        i += n;
+        if (code < 0xFF && i < enc.size()) out.push_back(0);
+    }
+    return out;
+}
+
+double secondsSince(std::chrono::steady_clock::time_point t0)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    const size_t frames   = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1000000;
+    const size_t payload  = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 22;
+    const size_t maxChunk = argc > 3 ? std::strtoull(argv[3], nullptr, 10) : 64;
+
+    // ---- Synthetic stream (payloads contain zeros, like the real telemetry) ----
+    std::mt19937 rng(12345);
+    std::uniform_int_distribution<int> byteDist(0, 255);
+    std::uniform_int_distribution<int> zeroDist(0, 3);
+
+    std::vector<uint8_t> stream;
+    std::vector<uint8_t> raw(payload);
+    uint64_t expectSum = 0;
+    for (size_t f = 0; f < frames; ++f) {
+        for (uint8_t& b : raw) b = zeroDist(rng) == 0 ? 0 : uint8_t(byteDist(rng));
+        for (uint8_t b : raw) expectSum += b;
+        const std::vector<uint8_t> enc = cobsEncode(raw.data(), raw.size());
+        stream.insert(stream.end(), enc.begin(), enc.end());
+        stream.push_back(0);
+    }
+
+    std::vector<size_t> chunks;
+    std::uniform_int_distribution<size_t> chunkDist(1, std::max<size_t>(1, maxChunk));
+    for (size_t done = 0; done < stream.size();) {
+        const size_t c = std::min(chunkDist(rng), stream.size() - done);
+        chunks.push_back(c);
+        done += c;
+    }
+
+    std::printf("stream: %zu frames, %zu-byte payload, %zu bytes, %zu chunks\n",
+                frames, payload, stream.size(), chunks.size());
+
+    // ---- CobsFramer ----
+    {
+        CobsFramer framer(payload);
+        uint64_t got = 0, sum = 0;
+        const auto t0 = std::chrono::steady_clock::now();
+        size_t off = 0;
+        for (size_t c : chunks) {
+            size_t pushed = 0;
+            while (pushed < c) {
+                pushed += framer.write(stream.data() + off + pushed, c - pushed);
+                for (CobsFramer::Result r; (r = framer.next()) != CobsFramer::Result::None;) {
+                    if (r != CobsFramer::Result::Frame) continue;
+                    ++got;
+                    for (size_t k = 0; k < payload; ++k) sum += framer.payload()[k];
+                }
+            }
+            off += c;
+        }
+        const double s = secondsSince(t0);
+        std::printf("CobsFramer : %10.0f frames/s  (%llu frames, %s)\n", got / s,
+                    static_cast<unsigned long long>(got), sum == expectSum ? "payloads OK" : "PAYLOAD MISMATCH");
+    }
+
+    // ---- Legacy scheme ----
+    {
+        std::vector<uint8_t> acc;
+        uint64_t got = 0, sum = 0;
+        const auto t0 = std::chrono::steady_clock::now();
+        size_t off = 0;
+        for (size_t c : chunks) {
+            acc.insert(acc.end(), stream.begin() + off, stream.begin() + off + c);
+            off += c;
+            for (;;) {
+                const auto it = std::find(acc.begin(), acc.end(), uint8_t(0));
+                if (it == acc.end()) break;
+                const std::vector<uint8_t> frame(acc.begin(), it);
+                acc.erase(acc.begin(), it + 1);
+                const std::vector<uint8_t> dec = legacyDecode(frame);
+                if (dec.size() != payload) continue;
+                ++got;
+                for (uint8_t b : dec) sum += b;
+            }
+        }
+        const double s = secondsSince(t0);
+        std::printf("Legacy     : %10.0f frames/s  (%llu frames, %s)\n", got / s,
+                    static_cast<unsigned long long>(got), sum == expectSum ? "payloads OK" : "PAYLOAD MISMATCH");
+    }
+
+    return 0;
+}
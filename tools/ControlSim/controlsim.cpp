@@ -0,0 +1,274 @@
+// ====================== ControlSim ======================
+/*
+ * Offline gain tuning: runs the real AutoBending against PlantSimulator (servo chain of
+ * the EquipmentController firmware + camera + serial link), faster than real time and
+ * without a device. Every combination of the swept values is simulated for --seeds noise
+ * realisations; the runs are spread over all cores with the BendemoBatch work-stealing pool.
+ *
+ *   ControlSim [--kp list] [--ki list] [--kd list] [--deadband list] [--mode list]
+ *              [--seeds n] [--threads n] [--top n] [--csv out.csv]
+ *              [--step deg] [--step-y deg] [--duration s]
+ *              [--latency ms] [--jitter ms] [--detect-hz hz] [--fps hz] [--noise px]
+ *              [--px-per-deg px] [--model-px-per-deg px] [--servo-tau s] [--model-tau s]
+ *              [--loop-hz hz] [--frame-hz hz] [--serial-ms ms] [--control-hz hz]
+ *
+ * A list is comma separated values and/or ranges "from:to:step", e.g. --kp 0.5:4:0.5,6
+ * Modes: hold (one step per detection), comp (latency compensation), track (Kalman
+ * tracker), track-comp (both). --px-per-deg and --servo-tau change the simulated plant
+ * only, to check how much mismatch the controller's geometry and servo model tolerate.
+ *
+ * Output per combination: settled runs / seeds, mean settling, 10-90 % rise, worst
+ * overshoot, mean steady-state error and IAE of the x axis (the stepped one by default).
+ * With more than --top combinations only the best by IAE are printed; --csv gets all.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "plantsimulator.h"
+#include "tools/BendemoBatch/workstealingpool.h"
+
+namespace {
+
+struct Mode {
+    const char* name;
+    bool compensate;
+    bool track;
+};
+
+const Mode kModes[] = {
+    {"hold", false, false},
+    {"comp", true, false},
+    {"track", false, true},
+    {"track-comp", true, true},
+};
+
+struct Point {
+    const Mode* mode;
+    double kp, ki, kd, deadbandPx;
+};
+
+struct Summary {
+    int    settled      = 0;
+    double settlingSec  = 0.0;   // mean over settled runs
+    double riseSec      = 0.0;   // mean over runs that rose
+    double overshootPct = 0.0;   // worst
+    double steadyDeg    = 0.0;   // mean
+    double iaeDegSec    = 0.0;   // mean
+};
+
+// "0.5,1,2:4:0.5" -> 0.5 1 2 2.5 3 3.5 4
+bool parseList(const char* text, std::vector<double>& out)
+{
+    out.clear();
+    std::string s(text);
+    size_t pos = 0;
+    while (pos <= s.size()) {
+        const size_t comma = s.find(',', pos);
+        const std::string part = s.substr(pos, comma == std::string::npos ? std::string::npos : comma - pos);
+        if (!part.empty()) {
+            double from = 0.0, to = 0.0, step = 0.0;
+            if (std::sscanf(part.c_str(), "%lf:%lf:%lf", &from, &to, &step) == 3) {
+                if (step <= 0.0 || to < from) return false;
+                for (int i = 0; from + i * step <= to + step * 1e-9; ++i) out.push_back(from + i * step);
+            } else {
+                out.push_back(std::atof(part.c_str()));
+            }
+        }
+        if (comma == std::string::npos) break;
+        pos = comma + 1;
+    }
+    return !out.empty();
+}
+
+bool parseModes(const char* text, std::vector<const Mode*>& out)
+{
+    out.clear();
+    std::string s(text);
+    size_t pos = 0;
+    while (pos <= s.size()) {
+        const size_t comma = s.find(',', pos);
+        const std::string part = s.substr(pos, comma == std::string::npos ? std::string::npos : comma - pos);
+        const Mode* found = nullptr;
+        for (const Mode& m : kModes)
+            if (part == m.name) found = &m;
+        if (!found) return false;
+        out.push_back(found);
+        if (comma == std::string::npos) break;
+        pos = comma + 1;
+    }
+    return !out.empty();
+}
+
+Summary summarize(const PlantSimulator::Result* runs, int n)
+{
+    Summary s;
+    int rose = 0;
+    for (int i = 0; i < n; ++i) {
+        const PlantSimulator::Metrics& m = runs[i].x;
+        if (m.settled()) { ++s.settled; s.settlingSec += m.settlingSec; }
+        if (m.riseSec >= 0.0) { ++rose; s.riseSec += m.riseSec; }
+        s.overshootPct = std::max(s.overshootPct, m.overshootPct);
+        s.steadyDeg += m.steadyStateDeg;
+        s.iaeDegSec += m.iaeDegSec;
+    }
+    if (s.settled) s.settlingSec /= s.settled;
+    s.riseSec = rose ? s.riseSec / rose : -1.0;
+    s.steadyDeg /= n;
+    s.iaeDegSec /= n;
+    return s;
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    PlantSimulator::Config base;
+    std::vector<double> kps = {0.5, 1.0, 2.0, 3.0, 4.0};
+    std::vector<double> kis = {0.0};
+    std::vector<double> kds = {0.01};
+    std::vector<double> deadbands = {50.0, 10.0};
+    std::vector<const Mode*> modes = {&kModes[0], &kModes[1]};
+    int seeds = 4, threads = 0, top = 40;
+    const char* csvPath = nullptr;
+
+    bool ok = true;
+    for (int i = 1; i + 1 < argc && ok; i += 2) {
+        const char* k = argv[i];
+        const char* v = argv[i + 1];
+        if      (!std::strcmp(k, "--kp"))               ok = parseList(v, kps);
+        else if (!std::strcmp(k, "--ki"))               ok = parseList(v, kis);
+        else if (!std::strcmp(k, "--kd"))               ok = parseList(v, kds);
+        else if (!std::strcmp(k, "--deadband"))         ok = parseList(v, deadbands);
+        else if (!std::strcmp(k, "--mode"))             ok = parseModes(v, modes);
+        else if (!std::strcmp(k, "--seeds"))            seeds = std::max(1, std::atoi(v));
+        else if (!std::strcmp(k, "--threads"))          threads = std::atoi(v);
+        else if (!std::strcmp(k, "--top"))              top = std::max(1, std::atoi(v));
+        else if (!std::strcmp(k, "--csv"))              csvPath = v;
+        else if (!std::strcmp(k, "--step"))             base.scenario.stepDegX = std::atof(v);
+        else if (!std::strcmp(k, "--step-y"))           base.scenario.stepDegY = std::atof(v);
+        else if (!std::strcmp(k, "--duration"))         base.scenario.durationSec = std::atof(v);
+        else if (!std::strcmp(k, "--latency"))          base.camera.latencyMs = std::atof(v);
+        else if (!std::strcmp(k, "--jitter"))           base.camera.jitterMs = std::atof(v);
+        else if (!std::strcmp(k, "--detect-hz"))        base.camera.detectHz = std::atof(v);
+        else if (!std::strcmp(k, "--fps"))              base.camera.fps = std::atof(v);
+        else if (!std::strcmp(k, "--noise"))            base.camera.noisePx = std::atof(v);
+        else if (!std::strcmp(k, "--px-per-deg"))       base.camera.pxPerDeg = std::atof(v);
+        else if (!std::strcmp(k, "--model-px-per-deg")) base.controller.pxPerDeg = std::atof(v);
+        else if (!std::strcmp(k, "--servo-tau"))        base.servo.timeConstantSec = std::atof(v);
+        else if (!std::strcmp(k, "--model-tau"))        base.controller.model.timeConstantSec = std::atof(v);
+        else if (!std::strcmp(k, "--loop-hz"))          base.servo.loopHz = std::atof(v);
+        else if (!std::strcmp(k, "--frame-hz"))         base.link.frameHz = std::atof(v);
+        else if (!std::strcmp(k, "--serial-ms"))        base.link.serialMs = std::atof(v);
+        else if (!std::strcmp(k, "--control-hz"))       base.controller.controlHz = std::atof(v);
+        else { std::fprintf(stderr, "Unknown option %s\n", k); return 1; }
+    }
+    if (!ok) { std::fprintf(stderr, "Bad list\n"); return 1; }
+
+    // The servo model follows the simulated link unless asked otherwise (main.cpp does the same)
+    base.controller.model.slewDegPerSec = base.servo.slewDegPerSec;
+    base.controller.model.commandDelaySec = (base.link.frameHz > 0.0 ? 0.5 / base.link.frameHz : 0.0) + base.link.serialMs / 1000.0;
+
+    std::vector<Point> points;
+    for (const Mode* m : modes)
+        for (double db : deadbands)
+            for (double kp : kps)
+                for (double ki : kis)
+                    for (double kd : kds) points.push_back({m, kp, ki, kd, db});
+
+    // ===== Sweep =====
+    std::vector<PlantSimulator::Result> runs(points.size() * seeds);
+    const auto t0 = std::chrono::steady_clock::now();
+    int workers = 0;
+    uint64_t steals = 0;
+    {
+        WorkStealingPool pool(threads);
+        workers = pool.size();
+        for (size_t p = 0; p < points.size(); ++p) {
+            for (int s = 0; s < seeds; ++s) {
+                pool.submit([&, p, s](int) {
+                    PlantSimulator::Config c = base;
+                    c.controller.kp = points[p].kp;
+                    c.controller.ki = points[p].ki;
+                    c.controller.kd = points[p].kd;
+                    c.controller.deadbandPx = points[p].deadbandPx;
+                    c.controller.compensate = points[p].mode->compensate;
+                    c.controller.track = points[p].mode->track;
+                    c.scenario.seed = uint32_t(s + 1);
+                    runs[p * seeds + s] = PlantSimulator::run(c);
+                });
+            }
+        }
+        pool.waitIdle();
+        steals = pool.steals();
+    }
+    const double wallSec = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+    std::vector<Summary> summaries(points.size());
+    for (size_t p = 0; p < points.size(); ++p) summaries[p] = summarize(&runs[p * seeds], seeds);
+
+    // ===== Report =====
+    std::printf("step %.1f deg, detections %.0f Hz, latency %.0f +- %.0f ms, noise %.1f px, "
+                "%.0f px/deg (model %.0f), servo tau %.0f ms (model %.0f), %d seeds\n\n",
+                base.scenario.stepDegX, base.camera.detectHz, base.camera.latencyMs, base.camera.jitterMs,
+                base.camera.noisePx, base.camera.pxPerDeg, base.controller.pxPerDeg,
+                base.servo.timeConstantSec * 1000.0, base.controller.model.timeConstantSec * 1000.0, seeds);
+
+    // Large sweeps: best first (all runs settled, then lowest IAE)
+    std::vector<size_t> order(points.size());
+    for (size_t p = 0; p < order.size(); ++p) order[p] = p;
+    if (int(points.size()) > top) {
+        std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+            const bool sa = summaries[a].settled == seeds, sb = summaries[b].settled == seeds;
+            if (sa != sb) return sa;
+            return summaries[a].iaeDegSec < summaries[b].iaeDegSec;
+        });
+        order.resize(top);
+        std::printf("best %d of %zu combinations\n", top, points.size());
+    }
+
+    std::printf("%-10s %6s %6s %6s %8s | %7s %8s %8s %9s %8s %8s\n", "mode", "Kp", "Ki", "Kd", "deadband",
+                "settled", "settle s", "rise s", "overshoot", "ss deg", "IAE");
+    for (size_t p : order) {
+        const Point& pt = points[p];
+        const Summary& s = summaries[p];
+        char settle[16], rise[16];
+        if (s.settled) std::snprintf(settle, sizeof(settle), "%8.2f", s.settlingSec);
+        else std::snprintf(settle, sizeof(settle), "%8s", "-");
+        if (s.riseSec >= 0.0) std::snprintf(rise, sizeof(rise), "%8.2f", s.riseSec);
+        else std::snprintf(rise, sizeof(rise), "%8s", "-");
+        std::printf("%-10s %6.2f %6.3f %6.3f %5.0f px | %3d/%-3d %s %s %7.1f %% %8.2f %8.2f\n",
+                    pt.mode->name, pt.kp, pt.ki, pt.kd, pt.deadbandPx, s.settled, seeds, settle, rise,
+                    s.overshootPct, s.steadyDeg, s.iaeDegSec);
+    }
+
+    const double simulatedSec = double(runs.size()) * base.scenario.durationSec;
+    std::printf("\n%zu runs, %.0f s simulated in %.2f s on %d threads (%.0fx real time, %llu steals)\n",
+                runs.size(), simulatedSec, wallSec, workers, wallSec > 0.0 ? simulatedSec / wallSec : 0.0,
+                (unsigned long long)steals);
+
+    if (csvPath) {
+        FILE* f = std::fopen(csvPath, "w");
+        if (!f) { std::fprintf(stderr, "Cannot write %s\n", csvPath); return 1; }
+        std::fprintf(f, "mode,kp,ki,kd,deadband_px,seed,settling_s,rise_s,overshoot_pct,steady_deg,iae_deg_s,"
+                        "y_settling_s,y_steady_deg,detections,frames\n");
+        for (size_t p = 0; p < points.size(); ++p) {
+            for (int s = 0; s < seeds; ++s) {
+                const Point& pt = points[p];
+                const PlantSimulator::Result& r = runs[p * seeds + s];
+                std::fprintf(f, "%s,%g,%g,%g,%g,%d,%.4f,%.4f,%.2f,%.4f,%.4f,%.4f,%.4f,%llu,%llu\n",
+                             pt.mode->name, pt.kp, pt.ki, pt.kd, pt.deadbandPx, s + 1,
+                             r.x.settlingSec, r.x.riseSec, r.x.overshootPct, r.x.steadyStateDeg, r.x.iaeDegSec,
+                             r.y.settlingSec, r.y.steadyStateDeg,
+                             (unsigned long long)r.detections, (unsigned long long)r.frames);
+            }
+        }
+        std::fclose(f);
+    }
+    return 0;
+}
@@ -0,0 +1,260 @@
+#include "plantsimulator.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <deque>
+#include <limits>
+#include <random>
+
+#include "controllaw.h"
+#include "ServoArrayController.h"   // the firmware itself, built against shim/
+
+namespace {
+
+constexpr int    kAxes      = 2;     // 0 = x (horizontal), 1 = y (vertical); also the firmware motor and pin
+constexpr double kWarmupSec = 2.0;   // the firmware slews from 0 deg to the start angle before t = 0
+
+// Step response bookkeeping for one axis, sampled on every firmware loop
+class StepMetrics
+{
+public:
+    StepMetrics(double start, double step, double stepAt, double duration)
+        : start_(start), step_(step), stepAt_(stepAt), duration_(duration),
+          band_(std::max(0.5, 0.02 * std::abs(step))) {}
+
+    void sample(double t, double angle, double dt)
+    {
+        if (t < stepAt_) return;
+
+        const double err = start_ + step_ - angle;
+        out_.iaeDegSec += std::abs(err) * dt;
+
+        if (step_ != 0.0) {
+            const double progress = (angle - start_) / step_;
+            if (t10_ < 0.0 && progress >= 0.1) t10_ = t;
+            if (t90_ < 0.0 && progress >= 0.9) t90_ = t;
+            peak_ = std::max(peak_, progress);
+        }
+
+        if (std::abs(err) <= band_) {
+            if (settledSince_ < 0.0) settledSince_ = t;
+        } else {
+            settledSince_ = -1.0;
+        }
+
+        if (t >= duration_ - 1.0) {
+            steadySum_ += std::abs(err);
+            ++steadyN_;
+        }
+    }
+
+    PlantSimulator::Metrics finish() const
+    {
+        PlantSimulator::Metrics m = out_;
+        if (t10_ >= 0.0 && t90_ >= 0.0) m.riseSec = t90_ - t10_;
+        m.settlingSec = settledSince_ >= 0.0 ? settledSince_ - stepAt_ : -1.0;
+        m.overshootPct = std::max(0.0, (peak_ - 1.0) * 100.0);
+        m.steadyStateDeg = steadyN_ ? steadySum_ / steadyN_ : 0.0;
+        return m;
+    }
+
+private:
+    double start_, step_, stepAt_, duration_, band_;
+    double t10_ = -1.0, t90_ = -1.0, peak_ = 0.0, settledSince_ = -1.0;
+    double steadySum_ = 0.0;
+    int    steadyN_ = 0;
+    PlantSimulator::Metrics out_;
+};
+
+} // namespace
+
+PlantSimulator::Result PlantSimulator::run(const Config& c)
+{
+    const Controller& cc = c.controller;
+    const Scenario&   sc = c.scenario;
+
+    // ===== Controller (configured like main.cpp) =====
+    AutoBending controller;
+    controller.setGains(cc.kp, cc.ki, cc.kd);
+    controller.setDeadband(cc.deadbandPx);
+    controller.setOutputSaturation(cc.saturation);
+    controller.setDerivativeCutoffHz(cc.derivativeCutoffHz);
+    controller.setGeometry(cc.pxPerDeg, cc.pxPerDeg);
+    controller.setLatencyCompensation(cc.compensate, cc.model);
+
+    // ===== Control tick (the ControlLaw that ControlLoop runs) =====
+    ControlLaw law(controller);
+    law.setLimits(ControlLaw::Vertical,   cc.minDeg, cc.maxDeg);
+    law.setLimits(ControlLaw::Horizontal, cc.minDeg, cc.maxDeg);
+    law.setHoldNs(int64_t(cc.holdSec * 1e9));
+    if (cc.track) law.setTracking(true, cc.tracker);
+
+    std::mt19937 rng(sc.seed);
+    std::normal_distribution<double> unit(0.0, 1.0);
+    auto gauss = [&](double sigma) { return sigma > 0.0 ? sigma * unit(rng) : 0.0; };
+
+    // Simulated time t [s] starts at the end of the warm-up; the controller and firmware clocks include it
+    auto nowNs  = [](double t) { return int64_t(std::llround((kWarmupSec + t) * 1e9)); };
+    auto nowUs  = [](double t) { return (unsigned long)std::llround((kWarmupSec + t) * 1e6); };
+
+    // ===== Firmware (EquipmentController setupMotors) =====
+    const ServoChain& sv = c.servo;
+    simMicros() = 0;
+    ServoArrayController firmware(kAxes);
+    firmware.SetDeadbandDeg(sv.deadbandDeg);
+    firmware.SetSlewRateDegPerSec(sv.slewDegPerSec);
+    for (int i = 0; i < kAxes; ++i) {
+        firmware.AttachPin(i, i);
+        firmware.SetMaxMin(i, sv.minDeg, sv.maxDeg);
+        firmware.SetPulseRangeUs(i, sv.minUs, sv.maxUs);
+    }
+
+    // Inverse of ServoArrayController::writeIfChanged_()
+    auto pulseToDeg = [&](int us) { return double(us - sv.minUs) / (sv.maxUs - sv.minUs) * (sv.maxDeg - sv.minDeg); };
+
+    const std::array<double, kAxes> start = {sc.startDegX, sc.startDegY};
+    const std::array<double, kAxes> step  = {sc.stepDegX, sc.stepDegY};
+    std::array<int16_t, kAxes> rx{};   // firmware readDataBuffer_
+    for (int i = 0; i < kAxes; ++i) rx[i] = int16_t(start[i] * 10);
+
+    const double loopPeriod = 1.0 / sv.loopHz;
+    for (int64_t n = 0; n * loopPeriod < kWarmupSec; ++n) {
+        simMicros() = (unsigned long)std::llround(n * loopPeriod * 1e6);
+        for (int i = 0; i < kAxes; ++i) firmware.RotateWithAngleValue(i, float(rx[i]) / 10.0f);
+    }
+    std::array<double, kAxes> angle{};   // mechanical
+    for (int i = 0; i < kAxes; ++i) angle[i] = pulseToDeg(::Servo::pulseUs(i));
+
+    std::array<StepMetrics, kAxes> metrics = {
+        StepMetrics(start[0], step[0], sc.stepAtSec, sc.durationSec),
+        StepMetrics(start[1], step[1], sc.stepAtSec, sc.durationSec)};
+
+    // ===== Camera / detector =====
+    struct Detection { double readySec; ControlLaw::Sample sample; };
+    std::deque<Detection> pipeline;
+    const double capturePeriod = 1.0 / c.camera.fps;
+    const int detectEvery = std::max(1, int(std::lround(c.camera.fps / c.camera.detectHz)));
+    double lastReady = 0.0;
+
+    // ===== Control thread (ControlLoop::tick_ and write_) =====
+    const double tickPeriod = 1.0 / cc.controlHz;
+    const int64_t tickPeriodNs = int64_t(std::llround(tickPeriod * 1e9));
+    int64_t previousTickNs = 0;
+    std::array<int16_t, kAxes> written{};
+    bool hasWritten = false;
+    bool havePending = false;
+    ControlLaw::Sample pending;
+
+    // ===== Serial (SerialInterface TX scheduler) =====
+    struct Frame { double arriveSec; std::array<int16_t, kAxes> image; };
+    std::deque<Frame> wire;
+    std::array<int16_t, kAxes> tx = rx;
+    const double framePeriod = c.link.frameHz > 0.0 ? 1.0 / c.link.frameHz : 0.0;
+    double lastFrame = -std::numeric_limits<double>::infinity();
+    double txDue = -1.0, lastArrive = 0.0;
+
+    Result result;
+
+    // Sim axis 0 / 1 = ControlLaw Horizontal / Vertical
+    auto write = [&](double t) {
+        const ControlLaw::Targets& targets = law.targets();
+        const std::array<double, kAxes> deg = {targets[ControlLaw::Horizontal], targets[ControlLaw::Vertical]};
+        bool any = false;
+        for (int i = 0; i < kAxes; ++i) {
+            const int16_t v = int16_t(deg[i] * 10);
+            if (hasWritten && v == written[i]) continue;
+            tx[i] = written[i] = v;
+            any = true;
+        }
+        if (!any) return;
+        hasWritten = true;
+        if (txDue < 0.0) txDue = std::max(t, lastFrame + framePeriod);
+    };
+
+    auto tick = [&](double t) {
+        const int64_t now = nowNs(t);
+        const double dtSec = double(std::min(now - previousTickNs, 5 * tickPeriodNs)) / 1e9;
+        previousTickNs = now;
+
+        const bool have = havePending;
+        havePending = false;
+        const ControlLaw::Step stepped = law.step(now, dtSec, have ? &pending : nullptr, true);
+        if (stepped.moved) write(t);
+    };
+
+    // The loop (re)starts at t = 0, like ControlLoop::setApplying(true, ...)
+    law.restart(nowNs(0.0), {start[1], start[0]});
+    previousTickNs = nowNs(0.0) - tickPeriodNs;
+
+    // ===== Event loop =====
+    int64_t loopIndex = 0, captureIndex = 0, tickIndex = 0;
+    double t = 0.0;
+    for (;;) {
+        const double nextLoop = loopIndex * loopPeriod;
+        const double nextCapture = captureIndex * capturePeriod;
+        const double nextTick = tickIndex * tickPeriod;
+        double next = std::min({nextLoop, nextCapture, nextTick});
+        if (!pipeline.empty()) next = std::min(next, pipeline.front().readySec);
+        if (txDue >= 0.0) next = std::min(next, txDue);
+        if (!wire.empty()) next = std::min(next, wire.front().arriveSec);
+        if (next >= sc.durationSec) break;
+
+        // Servo mechanics follow the pulse with a first-order lag, exact between events
+        const double a = 1.0 - std::exp(-(next - t) / sv.timeConstantSec);
+        for (int i = 0; i < kAxes; ++i) angle[i] += a * (pulseToDeg(::Servo::pulseUs(i)) - angle[i]);
+        t = next;
+
+        while (!wire.empty() && wire.front().arriveSec <= t) {
+            rx = wire.front().image;
+            wire.pop_front();
+        }
+
+        if (t >= nextLoop) {
+            ++loopIndex;
+            simMicros() = nowUs(t);
+            for (int i = 0; i < kAxes; ++i) firmware.RotateWithAngleValue(i, float(rx[i]) / 10.0f);
+            for (int i = 0; i < kAxes; ++i) metrics[i].sample(t, angle[i], loopPeriod);
+        }
+
+        if (t >= nextCapture) {
+            if (captureIndex % detectEvery == 0) {
+                double err[kAxes];
+                for (int i = 0; i < kAxes; ++i) {
+                    const double goal = t >= sc.stepAtSec ? start[i] + step[i] : start[i];
+                    err[i] = c.camera.pxPerDeg * (goal - angle[i]) + gauss(c.camera.noisePx);
+                }
+                // One detector thread: results come out in capture order
+                const double ready = std::max(lastReady, t + std::max(0.0, (c.camera.latencyMs + gauss(c.camera.jitterMs)) / 1000.0));
+                lastReady = ready;
+                pipeline.push_back({ready, {err[0], err[1], nowNs(t)}});
+            }
+            ++captureIndex;
+        }
+
+        while (!pipeline.empty() && pipeline.front().readySec <= t) {
+            pending = pipeline.front().sample;   // LatestSlot: a newer result replaces an untaken one
+            havePending = true;
+            pipeline.pop_front();
+            ++result.detections;
+        }
+
+        if (t >= nextTick) {
+            ++tickIndex;
+            tick(t);
+        }
+
+        if (txDue >= 0.0 && t >= txDue) {
+            const double arrive = std::max(lastArrive, t + std::max(0.0, (c.link.serialMs + gauss(c.link.serialJitterMs)) / 1000.0));
+            lastArrive = arrive;
+            wire.push_back({arrive, tx});
+            lastFrame = t;
+            txDue = -1.0;
+            ++result.frames;
+        }
+    }
+
+    result.x = metrics[0].finish();
+    result.y = metrics[1].finish();
+    return result;
+}
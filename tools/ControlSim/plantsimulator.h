@@ -0,0 +1,119 @@
+#ifndef PLANTSIMULATOR_H
+#define PLANTSIMULATOR_H
+
+#pragma once
+#include <cstdint>
+
+#include "autobending.h"
+#include "targettracker.h"
+
+/**
+ * @brief Closed-loop simulation of AutoBending against the EquipmentController servo chain and the camera.
+ *
+ * Usage:
+ *   PlantSimulator::Config c;
+ *   c.controller.kp = 2.0;
+ *   c.controller.deadbandPx = 10.0;
+ *   c.controller.compensate = true;
+ *   const PlantSimulator::Result r = PlantSimulator::run(c);
+ *   if (r.x.settled()) printf("%.2f s, %.1f %%\n", r.x.settlingSec, r.x.overshootPct);
+ *
+ * Chain (x = horizontal, y = vertical; both axes run, each with its own step):
+ *   camera (fps, every Nth frame detected, noise) -> detection latency + jitter, in order
+ *   -> latest-only hand-off -> control tick (ControlLaw::step, the same code ControlLoop::tick_
+ *   runs, with the real AutoBending and TargetTracker) -> qint16(deg * 10) TX image -> frame clock (SerialInterface::setFrameRate)
+ *   + serial delay -> firmware loop (the real ServoArrayController: clamp, deadband, slew,
+ *   500-2500 us pulse) -> servo first-order lag -> camera error = pxPerDeg * (goal - angle).
+ *
+ * Timing:
+ *   Event driven on a simulated clock (no sleeping, no wall clock): the servo lag is solved
+ *   exactly between events, so a 6 s run takes a few milliseconds. Before t = 0 the firmware
+ *   is run until it rests at the start angle. The step is applied at stepAtSec.
+ *
+ * Metrics (on the mechanical angle, per axis):
+ *   riseSec 10-90 %, settlingSec (last entry into the band max(0.5 deg, 2 % of the step),
+ *   -1 if it never settles), overshootPct, steadyStateDeg (mean |error| over the last
+ *   second) and iaeDegSec (integral of |error| after the step, for ranking sweeps).
+ *
+ * Each run owns its controller, firmware and RNG, and the Arduino shim's micros() is
+ * thread-local, so runs may execute on several threads at once.
+ */
+class PlantSimulator
+{
+public:
+    // Controller side, as configured in main.cpp and ControlLoop / ControlLaw
+    struct Controller {
+        double kp = 1.0, ki = 0.0, kd = 0.01;
+        double deadbandPx         = 50.0;
+        double saturation         = 2.0;
+        double derivativeCutoffHz = 5.0;
+        double pxPerDeg           = 25.0;     // AutoBending::setGeometry (the controller's belief)
+        bool   compensate         = false;    // AutoBending::setLatencyCompensation
+        AutoBending::ServoModel model;
+        bool   track              = false;    // ControlLoop::setTracking
+        TargetTracker::Options tracker;
+        double controlHz          = 200.0;    // ControlLoop::Options::rateHz
+        double holdSec            = 0.25;     // ControlLoop::setHoldMs
+        double minDeg = 0.0, maxDeg = 270.0;  // ControlLoop::Axis limits (ControlLaw::setLimits)
+    };
+
+    struct Camera {
+        double pxPerDeg  = 25.0;    // actual geometry
+        double fps       = 30.0;
+        double detectHz  = 15.0;    // every round(fps / detectHz)-th frame is detected
+        double latencyMs = 120.0;   // capture -> error available to the control thread
+        double jitterMs  = 15.0;    // 1 sigma
+        double noisePx   = 2.0;     // 1 sigma
+    };
+
+    struct Link {
+        double frameHz        = 50.0;   // SerialInterface::setFrameRate
+        double serialMs       = 5.0;    // frame on the wire + firmware receive
+        double serialJitterMs = 0.5;    // 1 sigma
+    };
+
+    // EquipmentController setupMotors() and the servo mechanics
+    struct ServoChain {
+        double loopHz          = 500.0;   // loop() rate; OperateMotors() runs every iteration
+        float  deadbandDeg     = 0.5f;
+        float  slewDegPerSec   = 300.0f;
+        int    minDeg = 0,   maxDeg = 270;
+        int    minUs  = 500, maxUs  = 2500;
+        double timeConstantSec = 0.04;    // mechanical lag behind the pulse
+    };
+
+    struct Scenario {
+        double startDegX = 135.0, startDegY = 135.0;
+        double stepDegX  = 10.0,  stepDegY  = 0.0;
+        double stepAtSec   = 0.5;
+        double durationSec = 6.0;
+        uint32_t seed      = 1;
+    };
+
+    struct Config {
+        Controller controller;
+        Camera     camera;
+        Link       link;
+        ServoChain servo;
+        Scenario   scenario;
+    };
+
+    struct Metrics {
+        double riseSec        = -1.0;   // -1 = never reached 90 %
+        double settlingSec    = -1.0;   // -1 = never settled
+        double overshootPct   = 0.0;
+        double steadyStateDeg = 0.0;
+        double iaeDegSec      = 0.0;
+        bool settled() const { return settlingSec >= 0.0; }
+    };
+
+    struct Result {
+        Metrics  x, y;
+        uint64_t detections = 0;   // errors handed to the control thread
+        uint64_t frames     = 0;   // serial frames sent
+    };
+
+    static Result run(const Config& config);
+};
+
+#endif // PLANTSIMULATOR_H
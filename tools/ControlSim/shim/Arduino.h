@@ -0,0 +1,24 @@
+// ====================== Arduino shim (ControlSim) ======================
+/*
+ * Just enough of the Arduino core to run inoFiles/EquipmentController/ServoArrayController
+ * inside the plant simulator. micros() is the simulated clock of the calling thread, so
+ * simulations on different threads do not interfere.
+ */
+#ifndef CS_ARDUINO_H
+#define CS_ARDUINO_H
+
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Simulated time of this thread [us]; set by PlantSimulator before every firmware call
+inline unsigned long& simMicros()
+{
+    static thread_local unsigned long us = 0;
+    return us;
+}
+
+inline unsigned long micros() { return simMicros(); }
+inline unsigned long millis() { return simMicros() / 1000; }
+
+#endif // CS_ARDUINO_H
@@ -0,0 +1,31 @@
+// ====================== Servo shim (ControlSim) ======================
+#ifndef CS_SERVO_H
+#define CS_SERVO_H
+
+#include "Arduino.h"
+
+// Records the last pulse per pin of this thread so the simulator can drive the servo mechanics.
+class Servo
+{
+public:
+    static constexpr int kMaxPins = 16;
+
+    uint8_t attach(int pin) { pin_ = (pin >= 0 && pin < kMaxPins) ? pin : -1; return pin_ >= 0; }
+    void    detach() { pin_ = -1; }
+    void    writeMicroseconds(int us) { if (pin_ >= 0) pulses_()[pin_] = us; }
+    bool    attached() const { return pin_ >= 0; }
+
+    // Last pulse written to `pin` on this thread (0 if none)
+    static int pulseUs(int pin) { return (pin >= 0 && pin < kMaxPins) ? pulses_()[pin] : 0; }
+
+private:
+    static int* pulses_()
+    {
+        static thread_local int pulses[kMaxPins] = {};
+        return pulses;
+    }
+
+    int pin_ = -1;
+};
+
+#endif // CS_SERVO_H
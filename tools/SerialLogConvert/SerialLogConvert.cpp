@@ -0,0 +1,55 @@
+// ====================== SerialLogConvert ======================
+/*
+ * Converts a binary serial log (SerialLogs/*.bdsl) to the CSV layout of the
+ * old recorder.
+ *
+ *   SerialLogConvert <log.bdsl> [out.csv] [--tx] [--decode]
+ *
+ * Without an output path the CSV is written next to the log. --tx exports the
+ * sent frames instead of the received ones. --decode adds the telemetry schema
+ * fields (roll/pitch/yaw in degrees, counters, ...) after the raw bytes.
+ */
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QFileInfo>
+
+#include <cstdio>
+
+#include "seriallog.h"
+
+int main(int argc, char* argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("SerialLogConvert");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Convert a binary serial log to CSV.");
+    parser.addHelpOption();
+    parser.addPositionalArgument("log", "Binary log (.bdsl).");
+    parser.addPositionalArgument("csv", "Output CSV (default: <log>.csv).", "[csv]");
+    QCommandLineOption txOpt("tx", "Export TX records instead of RX.");
+    parser.addOption(txOpt);
+    QCommandLineOption decodeOpt("decode", "Append decoded telemetry fields (RX).");
+    parser.addOption(decodeOpt);
+    parser.process(app);
+
+    const QStringList args = parser.positionalArguments();
+    if (args.isEmpty()) parser.showHelp(1);
+
+    const QString in = args[0];
+    const QFileInfo fi(in);
+    const QString out = args.size() > 1
+        ? args[1]
+        : fi.dir().filePath(fi.completeBaseName() + (parser.isSet(txOpt) ? "_tx.csv" : ".csv"));
+
+    QString error;
+    const auto dir = parser.isSet(txOpt) ? SerialLog::Direction::Tx : SerialLog::Direction::Rx;
+    if (!SerialLog::convertToCsv(in, out, dir, &error, parser.isSet(decodeOpt))) {
+        std::fprintf(stderr, "%s\n", qPrintable(error));
+        return 1;
+    }
+
+    std::printf("%s -> %s\n", qPrintable(in), qPrintable(out));
+    return 0;
+}
@@ -0,0 +1,92 @@
+// ====================== TelemetryBench ======================
+/*
+ * Decodes synthetic RX images three ways and prints the cost per frame:
+ *
+ *   View      : TelemetryView accessors for every schema field (in place)
+ *   By id     : TelemetryView::value() over the generated field table
+ *   Copy+text : the previous label path (copy the payload, print the first 13 bytes)
+ *
+ *   TelemetryBench [frames=1000000]
+ */
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "telemetryview.h"
+
+namespace {
+
+double secondsSince(std::chrono::steady_clock::time_point t0)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+}
+
+void report(const char* name, size_t frames, double s, double check)
+{
+    std::printf("%-10s: %7.1f ns/frame  %10.0f frames/s  (check %.3f)\n",
+                name, s * 1e9 / double(frames), double(frames) / s, check);
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    const size_t frames = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1000000;
+    constexpr size_t kLen = TelemetrySchema::kImageLength;
+
+    // A ring of images so the decoder cannot keep one frame in registers
+    constexpr size_t kRing = 4096;
+    std::mt19937 rng(12345);
+    std::uniform_int_distribution<int> byteDist(0, 255);
+    std::vector<uint8_t> images(kRing * kLen);
+    for (uint8_t& b : images) b = uint8_t(byteDist(rng));
+
+    std::printf("%zu frames, %zu-byte image, %zu schema fields\n", frames, kLen, TelemetrySchema::kFieldCount);
+
+    // ---- Typed accessors ----
+    {
+        double sum = 0.0;
+        const auto t0 = std::chrono::steady_clock::now();
+        for (size_t f = 0; f < frames; ++f) {
+            const TelemetryView t(images.data() + (f % kRing) * kLen, kLen);
+            sum += t.counter() + t.motor0Echo() + t.motor1Echo() + t.roll() + t.pitch() + t.yaw()
+                 + t.echoSeq() + t.fwRxFrames() + t.fwRxErrors();
+        }
+        report("View", frames, secondsSince(t0), sum / double(frames));
+    }
+
+    // ---- Generic, through the field table ----
+    {
+        double sum = 0.0;
+        const auto t0 = std::chrono::steady_clock::now();
+        for (size_t f = 0; f < frames; ++f) {
+            const TelemetryView t(images.data() + (f % kRing) * kLen, kLen);
+            for (size_t i = 0; i < TelemetrySchema::kFieldCount; ++i) sum += t.value(TelemetrySchema::Id(i));
+        }
+        report("By id", frames, secondsSince(t0), sum / double(frames));
+    }
+
+    // ---- Previous label path ----
+    {
+        double sum = 0.0;
+        const auto t0 = std::chrono::steady_clock::now();
+        for (size_t f = 0; f < frames; ++f) {
+            const std::vector<uint8_t> copy(images.begin() + std::ptrdiff_t((f % kRing) * kLen),
+                                            images.begin() + std::ptrdiff_t((f % kRing + 1) * kLen));
+            std::string text;
+            for (size_t i = 0; i < 13; ++i) {
+                text += std::to_string(copy[i]);
+                if (i + 1 < 13) text += " , ";
+            }
+            sum += double(text.size());
+        }
+        report("Copy+text", frames, secondsSince(t0), sum / double(frames));
+    }
+
+    return 0;
+}
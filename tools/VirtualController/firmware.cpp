@@ -0,0 +1,12 @@
+// Builds the EquipmentController sketch as ordinary C++ against the shims in shim/.
+// The Arduino IDE generates these prototypes; a plain compiler needs them up front.
+
+#include <Arduino.h>
+
+void setupMotors();
+void OperateMotors();
+void SerialWrite();
+void SerialWriteV2();
+void HandleFrame(const uint8_t *frame, size_t length);
+
+#include "../../inoFiles/EquipmentController/EquipmentController.ino"
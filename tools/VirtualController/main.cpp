@@ -0,0 +1,130 @@
+// ====================== VirtualController ======================
+/*
+ * Runs inoFiles/EquipmentController on Linux behind a pseudo-terminal, so
+ * SerialInterface (and the whole app) can be exercised without an Arduino.
+ *
+ *   VirtualController [--link /tmp/ttyBENDEMO] [--delay-ms 0] [--jitter-ms 0]
+ *                     [--drop 0] [--corrupt 0] [--seed 1] [--max-baud 0] [--stats-sec 5] [--duration-sec 0]
+ *
+ * The host opens the --link path (a symlink to /dev/pts/N) like any serial port,
+ * e.g. Bendemo --port /tmp/ttyBENDEMO. Line rate comes from the sketch's
+ * Serial.begin(); --drop / --corrupt are per-byte probabilities applied in
+ * both directions. --max-baud makes every faster rate noisy (baud negotiation tests).
+ */
+
+#include <Arduino.h>
+#include <Servo.h>
+
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+
+#include "ptylink.h"
+
+// The sketch (firmware.cpp)
+void setup();
+void loop();
+
+namespace
+{
+    std::atomic<bool> g_stop{false};
+
+    // Pins from EquipmentController.ino
+    constexpr int kPowerGuardPin = 4;
+    constexpr int kServoPins[]   = {5, 6, 7, 8, 9, 10};
+
+    void printUsage(const char* argv0)
+    {
+        std::fprintf(stderr,
+                     "usage: %s [--link PATH] [--delay-ms MS] [--jitter-ms MS] [--drop P] [--corrupt P]\n"
+                     "          [--seed N] [--max-baud BAUD] [--stats-sec S] [--duration-sec S]\n", argv0);
+    }
+
+    void printStats(const PtyLink& link, double elapsedSec, uint64_t loops)
+    {
+        const PtyLink::Stats& s = link.stats();
+        std::printf("[VirtualController] %.1f s | %lu baud | host->fw %llu B, fw->host %llu B | dropped %llu, corrupted %llu,"
+                    " overrun %llu | TX stall %.1f ms | %.0f loops/s | power %s | servo us:",
+                    elapsedSec, link.baud(),
+                    (unsigned long long)s.hostToFw, (unsigned long long)s.fwToHost,
+                    (unsigned long long)s.dropped, (unsigned long long)s.corrupted,
+                    (unsigned long long)s.overruns, double(s.txStallUs) / 1000.0,
+                    elapsedSec > 0.0 ? double(loops) / elapsedSec : 0.0,
+                    digitalRead(kPowerGuardPin) == HIGH ? "ON" : "OFF");
+        for (int pin : kServoPins) std::printf(" %d", servoPulseUs(pin));
+        std::printf("\n");
+        std::fflush(stdout);
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    std::string linkPath = "/tmp/ttyBENDEMO";
+    PtyLink::Faults faults;
+    double statsSec = 5.0, durationSec = 0.0;
+
+    for (int i = 1; i < argc; ++i) {
+        const std::string a = argv[i];
+        const bool hasValue = i + 1 < argc;
+        if      (a == "--link"         && hasValue) linkPath          = argv[++i];
+        else if (a == "--delay-ms"     && hasValue) faults.delayMs     = std::atof(argv[++i]);
+        else if (a == "--jitter-ms"    && hasValue) faults.jitterMs    = std::atof(argv[++i]);
+        else if (a == "--drop"         && hasValue) faults.dropRate    = std::atof(argv[++i]);
+        else if (a == "--corrupt"      && hasValue) faults.corruptRate = std::atof(argv[++i]);
+        else if (a == "--seed"         && hasValue) faults.seed        = uint32_t(std::strtoul(argv[++i], nullptr, 10));
+        else if (a == "--max-baud"     && hasValue) faults.maxReliableBaud = std::strtoul(argv[++i], nullptr, 10);
+        else if (a == "--stats-sec"    && hasValue) statsSec          = std::atof(argv[++i]);
+        else if (a == "--duration-sec" && hasValue) durationSec       = std::atof(argv[++i]);
+        else { printUsage(argv[0]); return 2; }
+    }
+
+    PtyLink link;
+    std::string error;
+    if (!link.open(linkPath, &error)) {
+        std::fprintf(stderr, "[VirtualController] %s\n", error.c_str());
+        return 1;
+    }
+    link.setFaults(faults);
+    Serial.attach(&link);
+
+    std::signal(SIGINT,  [](int){ g_stop = true; });
+    std::signal(SIGTERM, [](int){ g_stop = true; });
+
+    std::printf("[VirtualController] %s -> %s | delay %.2f ms, jitter %.2f ms, drop %g, corrupt %g, seed %u\n",
+                linkPath.c_str(), link.slavePath().c_str(), faults.delayMs, faults.jitterMs,
+                faults.dropRate, faults.corruptRate, faults.seed);
+    std::fflush(stdout);
+
+    setup();
+
+    using clock = std::chrono::steady_clock;
+    const auto t0 = clock::now();
+    auto nextStats = t0 + std::chrono::duration_cast<clock::duration>(std::chrono::duration<double>(statsSec));
+    uint64_t loops = 0;
+
+    while (!g_stop) {
+        loop();
+        link.pump();
+        ++loops;
+
+        // The board spins freely; here, yield briefly whenever the line is quiet
+        if (link.idle()) std::this_thread::sleep_for(std::chrono::microseconds(50));
+
+        const auto now = clock::now();
+        const double elapsed = std::chrono::duration<double>(now - t0).count();
+        if (statsSec > 0.0 && now >= nextStats) {
+            printStats(link, elapsed, loops);
+            nextStats += std::chrono::duration_cast<clock::duration>(std::chrono::duration<double>(statsSec));
+        }
+        if (durationSec > 0.0 && elapsed >= durationSec) break;
+    }
+
+    printStats(link, std::chrono::duration<double>(clock::now() - t0).count(), loops);
+    link.close();
+    return 0;
+}
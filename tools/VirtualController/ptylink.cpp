@@ -0,0 +1,214 @@
+#include "ptylink.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <thread>
+
+#include <fcntl.h>
+#include <termios.h>
+#include <unistd.h>
+
+// ======================== Public ========================
+
+bool PtyLink::open(const std::string& linkPath, std::string* error)
+{
+    auto fail = [&](const char* what) {
+        if (error) *error = std::string(what) + ": " + std::strerror(errno);
+        close();
+        return false;
+    };
+
+    master_ = posix_openpt(O_RDWR | O_NOCTTY);
+    if (master_ < 0) return fail("posix_openpt");
+    if (grantpt(master_) != 0 || unlockpt(master_) != 0) return fail("grantpt/unlockpt");
+
+    const char* name = ptsname(master_);
+    if (!name) return fail("ptsname");
+    slavePath_ = name;
+
+    slave_ = ::open(name, O_RDWR | O_NOCTTY);
+    if (slave_ < 0) return fail("open slave");
+
+    // Raw bytes both ways: no echo, no line editing, no CR/LF translation
+    termios tio{};
+    if (tcgetattr(slave_, &tio) != 0) return fail("tcgetattr");
+    cfmakeraw(&tio);
+    if (tcsetattr(slave_, TCSANOW, &tio) != 0) return fail("tcsetattr");
+
+    const int flags = fcntl(master_, F_GETFL);
+    if (flags < 0 || fcntl(master_, F_SETFL, flags | O_NONBLOCK) != 0) return fail("fcntl");
+
+    if (!linkPath.empty()) {
+        ::unlink(linkPath.c_str());
+        if (::symlink(name, linkPath.c_str()) != 0) return fail("symlink");
+        linkPath_ = linkPath;
+    }
+    return true;
+}
+
+void PtyLink::close()
+{
+    if (!linkPath_.empty()) ::unlink(linkPath_.c_str());
+    linkPath_.clear();
+    if (slave_ >= 0)  ::close(slave_);
+    if (master_ >= 0) ::close(master_);
+    slave_ = master_ = -1;
+}
+
+void PtyLink::setBaud(unsigned long baud)
+{
+    if (baud == 0) return;
+    baud_   = baud;
+    byteNs_ = int64_t(10'000'000'000ull / baud);
+}
+
+void PtyLink::setFaults(const Faults& faults)
+{
+    faults_ = faults;
+    rng_.seed(faults.seed);
+}
+
+void PtyLink::pump()
+{
+    readHost_();
+    writeHost_();
+}
+
+int PtyLink::available()
+{
+    pump();
+    const int64_t now = nowNs_();
+    size_t n = 0;
+    for (const Timed& t : rx_) {
+        if (t.dueNs > now) break;
+        ++n;
+    }
+
+    // The UART buffer holds 64 bytes; anything that arrived on top of a full one is gone
+    if (n > kRxBuffer) {
+        const size_t lost = n - kRxBuffer;
+        rx_.erase(rx_.begin() + std::ptrdiff_t(kRxBuffer), rx_.begin() + std::ptrdiff_t(n));
+        stats_.overruns += lost;
+        n = kRxBuffer;
+    }
+    return int(n);
+}
+
+int PtyLink::read()
+{
+    if (available() == 0) return -1;
+    const uint8_t b = rx_.front().byte;
+    rx_.pop_front();
+    return b;
+}
+
+size_t PtyLink::write(const uint8_t* data, size_t n)
+{
+    for (size_t i = 0; i < n; ++i) {
+        // Block while the 64-byte TX buffer is full, like HardwareSerial::write()
+        int64_t now = nowNs_();
+        const int64_t backlog = txLineFreeNs_ - now;
+        if (backlog > int64_t(kTxBuffer) * byteNs_) {
+            const int64_t waitNs = backlog - int64_t(kTxBuffer) * byteNs_;
+            stats_.txStallUs += uint64_t(waitNs / 1000);
+            const auto until = std::chrono::steady_clock::now() + std::chrono::nanoseconds(waitNs);
+            while (std::chrono::steady_clock::now() < until) {
+                pump();
+                std::this_thread::sleep_for(std::chrono::microseconds(50));
+            }
+            now = nowNs_();
+        }
+
+        txLineFreeNs_ = std::max(txLineFreeNs_, now) + byteNs_;
+        ++stats_.fwToHost;
+
+        uint8_t b = data[i];
+        if (!applyFaults_(b)) continue;
+        const int64_t due = std::max(txLineFreeNs_ + (i == 0 ? burstDelayNs_() : 0), txLastDueNs_);
+        txLastDueNs_ = due;
+        tx_.push_back({due, b});
+    }
+    writeHost_();
+    return n;
+}
+
+void PtyLink::flush()
+{
+    while (nowNs_() < txLineFreeNs_) {
+        pump();
+        std::this_thread::sleep_for(std::chrono::microseconds(20));
+    }
+}
+
+// ======================== Private ========================
+
+int64_t PtyLink::nowNs_()
+{
+    using namespace std::chrono;
+    return duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+int64_t PtyLink::burstDelayNs_()
+{
+    double ms = faults_.delayMs;
+    if (faults_.jitterMs > 0.0) {
+        ms += std::uniform_real_distribution<double>(0.0, faults_.jitterMs)(rng_);
+    }
+    return int64_t(ms * 1e6);
+}
+
+bool PtyLink::applyFaults_(uint8_t& b)
+{
+    std::uniform_real_distribution<double> u(0.0, 1.0);
+    if (faults_.dropRate > 0.0 && u(rng_) < faults_.dropRate) {
+        ++stats_.dropped;
+        return false;
+    }
+    const bool unreliable = faults_.maxReliableBaud > 0 && baud_ > faults_.maxReliableBaud;
+    if ((faults_.corruptRate > 0.0 && u(rng_) < faults_.corruptRate) || (unreliable && u(rng_) < 0.1)) {
+        b ^= uint8_t(1u << std::uniform_int_distribution<int>(0, 7)(rng_));
+        ++stats_.corrupted;
+    }
+    return true;
+}
+
+void PtyLink::readHost_()
+{
+    uint8_t buf[512];
+    for (;;) {
+        const ssize_t got = ::read(master_, buf, sizeof(buf));
+        if (got <= 0) break;
+
+        const int64_t now   = nowNs_();
+        const int64_t delay = burstDelayNs_();
+        for (ssize_t i = 0; i < got; ++i) {
+            rxLineFreeNs_ = std::max(rxLineFreeNs_, now) + byteNs_;
+            ++stats_.hostToFw;
+
+            uint8_t b = buf[i];
+            if (!applyFaults_(b)) continue;
+            const int64_t due = std::max(rxLineFreeNs_ + delay, rxLastDueNs_);
+            rxLastDueNs_ = due;
+            rx_.push_back({due, b});
+        }
+    }
+}
+
+void PtyLink::writeHost_()
+{
+    const int64_t now = nowNs_();
+    uint8_t buf[512];
+    size_t n = 0;
+    while (!tx_.empty() && tx_.front().dueNs <= now && n < sizeof(buf)) {
+        buf[n++] = tx_.front().byte;
+        tx_.pop_front();
+    }
+    if (n == 0) return;
+
+    // Nobody listening (or the PTY buffer is full): the bytes are simply gone, as on a real line
+    const ssize_t put = ::write(master_, buf, n);
+    (void)put;
+}
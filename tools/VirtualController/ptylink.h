@@ -0,0 +1,110 @@
+#ifndef PTYLINK_H
+#define PTYLINK_H
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <random>
+#include <string>
+
+/**
+ * Pseudo-terminal end of the virtual EquipmentController with an emulated serial line.
+ *
+ * Usage:
+ *   PtyLink link;
+ *   link.open("/tmp/ttyBENDEMO", &err);   // symlink to the slave side for the host
+ *   link.setFaults({2.0, 0.5, 0.001, 0.0005, 42});
+ *   Serial.attach(&link);                   // firmware talks through the Arduino shim
+ *   for (;;) { loop(); link.pump(); }
+ *
+ * Line model (both directions):
+ *   - 8N1 at the rate given to Serial.begin(): one byte occupies the line for 10 bit times.
+ *   - Fixed delay plus uniform jitter per burst; bytes are never reordered.
+ *   - Each byte is independently dropped or has one bit flipped with the given rates.
+ *   - Above maxReliableBaud every byte has a 10 % chance of a flipped bit, so baud
+ *     negotiation has something to fall back from.
+ *   - Arduino buffers: 64 bytes of RX (bytes arriving into a full buffer are lost) and
+ *     64 bytes of TX (write() blocks until the UART has room, as on the board).
+ */
+class PtyLink
+{
+public:
+    struct Faults {
+        double   delayMs     = 0.0;
+        double   jitterMs    = 0.0;
+        double   dropRate    = 0.0;   // per byte
+        double   corruptRate = 0.0;   // per byte
+        uint32_t seed        = 1;
+        unsigned long maxReliableBaud = 0;   // 0 = every rate is clean
+    };
+
+    struct Stats {
+        uint64_t hostToFw  = 0;   // bytes read from the host
+        uint64_t fwToHost  = 0;   // bytes written by the firmware
+        uint64_t dropped   = 0;
+        uint64_t corrupted = 0;
+        uint64_t overruns  = 0;   // lost to a full RX buffer
+        uint64_t txStallUs = 0;   // time write() spent waiting for the UART
+    };
+
+    static constexpr size_t kRxBuffer = 64;
+    static constexpr size_t kTxBuffer = 64;
+
+    PtyLink() = default;
+    ~PtyLink() { close(); }
+
+    PtyLink(const PtyLink&) = delete;
+    PtyLink& operator=(const PtyLink&) = delete;
+
+    bool open(const std::string& linkPath, std::string* error = nullptr);
+    void close();
+    const std::string& slavePath() const { return slavePath_; }
+
+    void setBaud(unsigned long baud);
+    unsigned long baud() const { return baud_; }
+    void setFaults(const Faults& faults);
+
+    // Moves bytes between the PTY and the emulated line. Call often.
+    void pump();
+    bool idle() const { return rx_.empty() && tx_.empty(); }
+
+    // ---- Firmware side (via HardwareSerial) ----
+    int    available();
+    int    read();
+    size_t write(const uint8_t* data, size_t n);
+    void   flush();
+
+    const Stats& stats() const { return stats_; }
+
+private:
+    struct Timed {
+        int64_t dueNs;
+        uint8_t byte;
+    };
+
+    static int64_t nowNs_();
+    int64_t burstDelayNs_();
+    bool    applyFaults_(uint8_t& b);   // false = dropped
+    void    readHost_();
+    void    writeHost_();
+
+    int         master_ = -1;
+    int         slave_  = -1;           // kept open so the master never sees a hang-up
+    std::string slavePath_;
+    std::string linkPath_;
+
+    unsigned long baud_ = 115200;
+    int64_t byteNs_ = 86806;            // 115200 baud
+    Faults  faults_;
+    std::mt19937 rng_{1};
+
+    std::deque<Timed> rx_;              // host -> firmware
+    std::deque<Timed> tx_;              // firmware -> host
+    int64_t rxLineFreeNs_ = 0, rxLastDueNs_ = 0;
+    int64_t txLineFreeNs_ = 0, txLastDueNs_ = 0;
+
+    Stats stats_;
+};
+
+#endif // PTYLINK_H
@@ -0,0 +1,56 @@
+// ====================== Arduino shim (VirtualController) ======================
+/*
+ * Just enough of the Arduino core to build inoFiles/EquipmentController on Linux.
+ * Time comes from the host's steady clock, pins are recorded, and Serial is a
+ * pseudo-terminal with an emulated line (see ptylink.h).
+ */
+#ifndef VC_ARDUINO_H
+#define VC_ARDUINO_H
+
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define HIGH   0x1
+#define LOW    0x0
+#define INPUT  0x0
+#define OUTPUT 0x1
+
+#define PI         3.1415926535897932384626433832795
+#define DEG_TO_RAD 0.017453292519943295769236907684886
+#define RAD_TO_DEG 57.295779513082320876798154814105
+
+#define constrain(x, lo, hi) ((x) < (lo) ? (lo) : ((x) > (hi) ? (hi) : (x)))
+
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+
+void pinMode(int pin, int mode);
+void digitalWrite(int pin, int value);
+int  digitalRead(int pin);
+
+class PtyLink;
+
+class HardwareSerial
+{
+public:
+    void   begin(unsigned long baud);
+    int    available();
+    int    read();
+    size_t write(uint8_t b) { return write(&b, 1); }
+    size_t write(const uint8_t* data, size_t length);
+    void   flush();   // waits until the TX buffer has gone out on the line
+
+    void attach(PtyLink* link) { link_ = link; }
+
+private:
+    PtyLink* link_ = nullptr;
+};
+
+extern HardwareSerial Serial;
+
+#endif // VC_ARDUINO_H
@@ -0,0 +1,33 @@
+// ====================== MPU6050 shim (VirtualController) ======================
+#ifndef VC_MPU6050_H
+#define VC_MPU6050_H
+
+#include "Arduino.h"
+
+// A level, motionless sensor: 1 g on Z, no rotation.
+class MPU6050
+{
+public:
+    explicit MPU6050(uint8_t = 0x68) {}
+
+    void initialize() {}
+    void setSleepEnabled(bool) {}
+    void setDLPFMode(uint8_t) {}
+    void setRate(uint8_t) {}
+    void setFullScaleAccelRange(uint8_t fs) { accelRange_ = fs; }
+    void setFullScaleGyroRange(uint8_t fs)  { gyroRange_ = fs; }
+    uint8_t getFullScaleAccelRange() const { return accelRange_; }
+    uint8_t getFullScaleGyroRange()  const { return gyroRange_; }
+
+    void getMotion6(int16_t* ax, int16_t* ay, int16_t* az, int16_t* gx, int16_t* gy, int16_t* gz)
+    {
+        *ax = 0; *ay = 0; *az = int16_t(16384 >> accelRange_);
+        *gx = 0; *gy = 0; *gz = 0;
+    }
+
+private:
+    uint8_t accelRange_ = 0;
+    uint8_t gyroRange_  = 0;
+};
+
+#endif // VC_MPU6050_H
@@ -0,0 +1,25 @@
+// ====================== Servo shim (VirtualController) ======================
+#ifndef VC_SERVO_H
+#define VC_SERVO_H
+
+#include "Arduino.h"
+
+// Records the last pulse per attached pin so the stand-in can report servo positions.
+class Servo
+{
+public:
+    uint8_t attach(int pin);
+    void    detach();
+    void    writeMicroseconds(int us);
+    int     readMicroseconds() const { return pulseUs_; }
+    bool    attached() const { return pin_ >= 0; }
+
+private:
+    int pin_     = -1;
+    int pulseUs_ = 0;
+};
+
+// Last pulse written to `pin` (0 if none)
+int servoPulseUs(int pin);
+
+#endif // VC_SERVO_H
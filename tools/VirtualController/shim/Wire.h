@@ -0,0 +1,16 @@
+// ====================== Wire shim (VirtualController) ======================
+#ifndef VC_WIRE_H
+#define VC_WIRE_H
+
+#include "Arduino.h"
+
+class TwoWire
+{
+public:
+    void begin() {}
+    void setClock(uint32_t) {}
+};
+
+extern TwoWire Wire;
+
+#endif // VC_WIRE_H
@@ -0,0 +1,111 @@
+#include "Arduino.h"
+#include "Servo.h"
+#include "Wire.h"
+
+#include "../ptylink.h"
+
+#include <chrono>
+#include <map>
+#include <thread>
+
+namespace
+{
+    const auto kStart = std::chrono::steady_clock::now();
+
+    std::map<int, int>& pins()        { static std::map<int, int> p; return p; }
+    std::map<int, int>& servoPulses() { static std::map<int, int> p; return p; }
+}
+
+HardwareSerial Serial;
+TwoWire        Wire;
+
+// ======================== Time ========================
+
+unsigned long millis()
+{
+    using namespace std::chrono;
+    return (unsigned long)duration_cast<milliseconds>(steady_clock::now() - kStart).count();
+}
+
+unsigned long micros()
+{
+    using namespace std::chrono;
+    return (unsigned long)duration_cast<microseconds>(steady_clock::now() - kStart).count();
+}
+
+void delay(unsigned long ms)
+{
+    std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+void delayMicroseconds(unsigned int us)
+{
+    std::this_thread::sleep_for(std::chrono::microseconds(us));
+}
+
+// ======================== Pins ========================
+
+void pinMode(int, int) {}
+
+void digitalWrite(int pin, int value)
+{
+    pins()[pin] = value;
+}
+
+int digitalRead(int pin)
+{
+    const auto it = pins().find(pin);
+    return it == pins().end() ? LOW : it->second;
+}
+
+// ======================== Serial ========================
+
+void HardwareSerial::begin(unsigned long baud)
+{
+    if (link_) link_->setBaud(baud);
+}
+
+int HardwareSerial::available()
+{
+    return link_ ? link_->available() : 0;
+}
+
+int HardwareSerial::read()
+{
+    return link_ ? link_->read() : -1;
+}
+
+size_t HardwareSerial::write(const uint8_t* data, size_t length)
+{
+    return link_ ? link_->write(data, length) : length;
+}
+
+void HardwareSerial::flush()
+{
+    if (link_) link_->flush();
+}
+
+// ======================== Servo ========================
+
+uint8_t Servo::attach(int pin)
+{
+    pin_ = pin;
+    return uint8_t(pin);
+}
+
+void Servo::detach()
+{
+    pin_ = -1;
+}
+
+void Servo::writeMicroseconds(int us)
+{
+    pulseUs_ = us;
+    if (pin_ >= 0) servoPulses()[pin_] = us;
+}
+
+int servoPulseUs(int pin)
+{
+    const auto it = servoPulses().find(pin);
+    return it == servoPulses().end() ? 0 : it->second;
+}
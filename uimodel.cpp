@@ -0,0 +1,20 @@
+#include "uimodel.h"
+
+namespace {
+
+template <class T>
+QString channelStats(const char* name, const LatestSlot<T>& slot)
+{
+    return QString("%1 %2/%3").arg(name).arg(slot.dropped()).arg(slot.published());
+}
+
+} // namespace
+
+QString UiModel::statsText() const
+{
+    return "[UiModel] dropped/published: "
+           + channelStats("detections", detections_) + ", "
+           + channelStats("difference", difference_) + ", "
+           + channelStats("control", control_) + ", "
+           + channelStats("telemetry", telemetry_);
+}
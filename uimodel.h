@@ -0,0 +1,57 @@
+#ifndef UIMODEL_H
+#define UIMODEL_H
+
+#pragma once
+#include <QByteArray>
+#include <QString>
+#include <QVector>
+
+#include "darknessdetector.h" // DetectedObject
+#include "latestslot.h"
+
+/**
+ * Latest-value store between producers (detectors, serial RX) and the widgets.
+ *
+ * - publish*() is cheap and thread-safe: it only replaces the slot's value.
+ * - The GUI flushes the model at most once per display refresh and renders
+ *   whatever is newest; intermediate values are counted as dropped.
+ */
+class UiModel
+{
+public:
+    struct Vec2 {
+        double x = 0.0;
+        double y = 0.0;
+    };
+
+    struct Telemetry {
+        QByteArray log;
+        QString    portName;
+        int        baudrate = 0;
+    };
+
+    void publishDetections(const QVector<Detector::DetectedObject>& objects) { detections_.publish(objects); }
+    void publishDifference(double x, double y) { difference_.publish({x, y}); }
+    void publishControl(double x, double y)    { control_.publish({x, y}); }
+    void publishTelemetry(const QByteArray& log, const QString& portName, int baudrate)
+    {
+        telemetry_.publish({log, portName, baudrate});
+    }
+
+    // ---- Consumer side (GUI thread) ----
+    std::unique_ptr<QVector<Detector::DetectedObject>> takeDetections() { return detections_.take(); }
+    std::unique_ptr<Vec2>      takeDifference() { return difference_.take(); }
+    std::unique_ptr<Vec2>      takeControl()    { return control_.take(); }
+    std::unique_ptr<Telemetry> takeTelemetry()  { return telemetry_.take(); }
+
+    // "[UiModel] ..." line with published / dropped counts per channel
+    QString statsText() const;
+
+private:
+    LatestSlot<QVector<Detector::DetectedObject>> detections_;
+    LatestSlot<Vec2>      difference_;
+    LatestSlot<Vec2>      control_;
+    LatestSlot<Telemetry> telemetry_;
+};
+
+#endif // UIMODEL_H
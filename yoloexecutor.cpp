@@ -316,6 +316,8 @@ void YoloExecutor::StoreDetectedObjects()
                 detectedObject.y1 = (y1 - paddingSize_.height()) / reductionRatio_.y();
                 detectedObject.x2 = (x2 - paddingSize_.width())  / reductionRatio_.x();
                 detectedObject.y2 = (y2 - paddingSize_.height()) / reductionRatio_.y();
+                detectedObject.cx = ((x1 + x2) * 0.5f - paddingSize_.width())  / reductionRatio_.x();
+                detectedObject.cy = ((y1 + y2) * 0.5f - paddingSize_.height()) / reductionRatio_.y();
                 detectedObject.score = score;
                 detectedObject.index = index;
                 detectedObject.classifySize = classifyNames_.size();